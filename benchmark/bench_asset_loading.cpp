@@ -0,0 +1,209 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fixtures.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <assets/ega_image_decoder.hpp>
+#include <assets/ega_pixel_decoder.hpp>
+#include <assets/level_loader.hpp>
+#include <assets/resource_loader.hpp>
+#include <data/game_session_data.hpp>
+#include <data/game_traits.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+
+
+using namespace rigel;
+
+
+namespace
+{
+
+assets::ByteBuffer createRandomBytes(const std::size_t size)
+{
+  std::mt19937 randomGenerator{bench::FIXTURE_SEED};
+  std::uniform_int_distribution<int> byteDistribution{0, 255};
+
+  assets::ByteBuffer result(size);
+  for (auto& byte : result)
+  {
+    byte = static_cast<std::uint8_t>(byteDistribution(randomGenerator));
+  }
+
+  return result;
+}
+
+
+/** Path to a Duke Nukem II installation, or empty if not configured
+ *
+ * Level loading requires the game's data files, which can't be generated.
+ * These benchmarks are skipped unless the RIGEL_BENCHMARK_GAME_PATH
+ * environment variable points to a copy of the game (the shareware version
+ * is sufficient).
+ */
+std::string gamePathForBenchmarks()
+{
+  const auto pPath = std::getenv("RIGEL_BENCHMARK_GAME_PATH");
+  return pPath ? std::string{pPath} : std::string{};
+}
+
+} // namespace
+
+
+static void BMDecodeTiledEgaImage(benchmark::State& state)
+{
+  using data::GameTraits;
+
+  const auto type = state.range(0) == 0 ? data::TileImageType::Unmasked
+                                        : data::TileImageType::Masked;
+
+  // Same size as the solid tiles part of a CZone file
+  const auto widthInTiles = std::size_t(GameTraits::CZone::tileSetImageWidth);
+  const auto data = createRandomBytes(
+    GameTraits::CZone::numSolidTiles * GameTraits::bytesPerTile(type));
+
+  for (auto _ : state)
+  {
+    auto image = assets::loadTiledImage(
+      data, widthInTiles, GameTraits::INGAME_PALETTE, type);
+    benchmark::DoNotOptimize(image);
+  }
+
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(BMDecodeTiledEgaImage)->ArgName("masked")->Arg(0)->Arg(1);
+
+
+static void BMDecodeSimplePlanarEgaBuffer(benchmark::State& state)
+{
+  using data::GameTraits;
+
+  // A full-screen image
+  const auto data = createRandomBytes(
+    GameTraits::viewportWidthPx * GameTraits::viewportHeightPx /
+    GameTraits::pixelsPerEgaByte * GameTraits::egaPlanes);
+
+  for (auto _ : state)
+  {
+    auto pixels = assets::decodeSimplePlanarEgaBuffer(
+      data.data(), data.data() + data.size(), GameTraits::INGAME_PALETTE);
+    benchmark::DoNotOptimize(pixels);
+  }
+
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(BMDecodeSimplePlanarEgaBuffer);
+
+
+static void BMEgaPixelDecoder(benchmark::State& state)
+{
+  using data::GameTraits;
+
+  const auto backend = state.range(0) == 0 ? assets::EgaDecoderBackend::Scalar
+                                           : assets::EgaDecoderBackend::Simd;
+  if (
+    backend == assets::EgaDecoderBackend::Simd &&
+    !assets::isSimdEgaDecodingAvailable())
+  {
+    state.SkipWithError("No SIMD support on this platform");
+    return;
+  }
+
+  // Masked tile rows, as found in actor sprites
+  const auto layout =
+    assets::EgaPlaneLayout{GameTraits::maskedEgaPlanes, 1, true};
+  const auto numGroups = std::size_t{4096};
+  const auto data = createRandomBytes(numGroups * layout.mGroupStride);
+
+  const auto decoder =
+    assets::EgaPixelDecoder{GameTraits::INGAME_PALETTE, backend};
+  data::PixelBuffer pixels(numGroups * GameTraits::pixelsPerEgaByte);
+
+  for (auto _ : state)
+  {
+    decoder.decode(
+      data.data(),
+      numGroups,
+      layout,
+      pixels.data(),
+      GameTraits::pixelsPerEgaByte);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * pixels.size());
+}
+
+BENCHMARK(BMEgaPixelDecoder)->ArgName("simd")->Arg(0)->Arg(1);
+
+
+static void BMLoadLevel(benchmark::State& state)
+{
+  const auto gamePath = gamePathForBenchmarks();
+  if (gamePath.empty())
+  {
+    state.SkipWithError("RIGEL_BENCHMARK_GAME_PATH not set");
+    return;
+  }
+
+  const auto resources = assets::ResourceLoader{gamePath, false, {}};
+
+  for (auto _ : state)
+  {
+    auto level =
+      assets::loadLevel("L1.MNI", resources, data::Difficulty::Medium);
+    benchmark::DoNotOptimize(level);
+  }
+}
+
+BENCHMARK(BMLoadLevel)->Unit(benchmark::kMillisecond);
+
+
+static void BMLoadCachedLevel(benchmark::State& state)
+{
+  const auto gamePath = gamePathForBenchmarks();
+  if (gamePath.empty())
+  {
+    state.SkipWithError("RIGEL_BENCHMARK_GAME_PATH not set");
+    return;
+  }
+
+  const auto cacheDirectory =
+    std::filesystem::temp_directory_path() / "rigel_bench_asset_cache";
+  const auto resources =
+    assets::ResourceLoader{gamePath, false, {}, cacheDirectory};
+
+  // Populate the cache
+  assets::loadLevel("L1.MNI", resources, data::Difficulty::Medium);
+
+  for (auto _ : state)
+  {
+    auto level =
+      assets::loadLevel("L1.MNI", resources, data::Difficulty::Medium);
+    benchmark::DoNotOptimize(level);
+  }
+
+  std::error_code ec;
+  std::filesystem::remove_all(cacheDirectory, ec);
+}
+
+BENCHMARK(BMLoadCachedLevel)->Unit(benchmark::kMillisecond);
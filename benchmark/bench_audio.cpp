@@ -0,0 +1,98 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fixtures.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <audio/software_imf_player.hpp>
+
+#include <random>
+#include <vector>
+
+
+using namespace rigel;
+
+
+namespace
+{
+
+constexpr auto SAMPLE_RATE = 44100;
+constexpr auto BUFFER_SIZE = 2048;
+
+
+/** Creates a song which keys notes on and off on all 9 channels */
+data::Song createFixtureSong()
+{
+  std::mt19937 randomGenerator{bench::FIXTURE_SEED};
+  std::uniform_int_distribution<int> valueDistribution{0, 255};
+  std::uniform_int_distribution<int> delayDistribution{0, 8};
+
+  data::Song song;
+
+  // Enable waveform selection, and give all operators an audible envelope
+  song.push_back({0x01, 0x20, 0});
+  for (std::uint8_t op = 0; op < 0x16; ++op)
+  {
+    song.push_back({std::uint8_t(0x20 + op), 0x01, 0});
+    song.push_back({std::uint8_t(0x40 + op), 0x10, 0});
+    song.push_back({std::uint8_t(0x60 + op), 0xF0, 0});
+    song.push_back({std::uint8_t(0x80 + op), 0x77, 0});
+  }
+
+  for (auto i = 0; i < 4000; ++i)
+  {
+    const auto channel = std::uint8_t(i % 9);
+    const auto frequency = std::uint8_t(valueDistribution(randomGenerator));
+    const auto keyOn = std::uint8_t((i / 9) % 2 == 0 ? 0x31 : 0x11);
+
+    song.push_back({std::uint8_t(0xA0 + channel), frequency, 0});
+    song.push_back(
+      {std::uint8_t(0xB0 + channel),
+       keyOn,
+       std::uint16_t(delayDistribution(randomGenerator))});
+  }
+
+  return song;
+}
+
+} // namespace
+
+
+static void BMSoftwareImfPlayerRender(benchmark::State& state)
+{
+  const auto type = state.range(0) == 0 ? audio::AdlibEmulator::Type::DBOPL
+                                        : audio::AdlibEmulator::Type::NukedOpl3;
+
+  // Synchronous mode makes render() run the emulator directly, which is what
+  // we want to measure here
+  audio::SoftwareImfPlayer player{
+    SAMPLE_RATE, audio::SoftwareImfPlayer::RenderMode::Synchronous};
+  player.setType(type);
+  player.playSong(createFixtureSong());
+
+  std::vector<std::int16_t> buffer(BUFFER_SIZE);
+
+  for (auto _ : state)
+  {
+    player.render(buffer.data(), buffer.size());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations() * BUFFER_SIZE);
+}
+
+BENCHMARK(BMSoftwareImfPlayerRender)->ArgName("nukedOpl3")->Arg(0)->Arg(1);
@@ -0,0 +1,96 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fixtures.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <data/player_model.hpp>
+#include <engine/physical_components.hpp>
+#include <frontend/game_service_provider.hpp>
+#include <game_logic/damage_infliction_system.hpp>
+
+#include <limits>
+#include <random>
+
+
+using namespace rigel;
+
+
+namespace
+{
+
+constexpr auto NUM_SHOOTABLES = 500;
+
+} // namespace
+
+
+static void BMDamageInfliction(benchmark::State& state)
+{
+  using engine::components::BoundingBox;
+  using engine::components::WorldPosition;
+  using game_logic::components::DamageInflicting;
+  using game_logic::components::Shootable;
+
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+  data::PlayerModel playerModel;
+  NullServiceProvider serviceProvider;
+  game_logic::DamageInflictionSystem system{
+    &playerModel, &serviceProvider, &events};
+
+  std::mt19937 randomGenerator{bench::FIXTURE_SEED};
+  std::uniform_int_distribution<int> xDistribution{
+    0, bench::FIXTURE_MAP_WIDTH - 1};
+  std::uniform_int_distribution<int> yDistribution{
+    0, bench::FIXTURE_MAP_HEIGHT - 1};
+
+  for (auto i = 0; i < NUM_SHOOTABLES; ++i)
+  {
+    auto entity = entities.create();
+    auto shootable = Shootable{std::numeric_limits<int>::max()};
+    shootable.mEnableHitFeedback = false;
+    shootable.mCanBeHitWhenOffscreen = true;
+    entity.assign<Shootable>(shootable);
+    entity.assign<WorldPosition>(
+      xDistribution(randomGenerator), yDistribution(randomGenerator));
+    entity.assign<BoundingBox>(BoundingBox{{}, {3, 3}});
+  }
+
+  for (auto i = 0; i < state.range(0); ++i)
+  {
+    // Inflictors survive contact and do no damage, so that every iteration
+    // works on the same scene
+    auto entity = entities.create();
+    entity.assign<DamageInflicting>(0, false);
+    entity.assign<WorldPosition>(
+      xDistribution(randomGenerator), yDistribution(randomGenerator));
+    entity.assign<BoundingBox>(BoundingBox{{}, {2, 1}});
+  }
+
+  for (auto _ : state)
+  {
+    system.update(entities);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BMDamageInfliction)
+  ->RangeMultiplier(10)
+  ->Range(10, 10000)
+  ->Complexity();
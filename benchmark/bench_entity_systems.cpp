@@ -0,0 +1,364 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fixtures.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <data/game_traits.hpp>
+#include <engine/base_components.hpp>
+#include <engine/entity_activation_system.hpp>
+#include <engine/entity_tools.hpp>
+#include <engine/particle_system.hpp>
+#include <engine/random_number_generator.hpp>
+#include <engine/sprite_rendering_system.hpp>
+#include <game_logic/behavior_controller.hpp>
+#include <game_logic/behavior_controller_system.hpp>
+
+#include <array>
+#include <utility>
+
+
+using namespace rigel;
+
+
+namespace
+{
+
+// Stand-in for actual behaviors, which would need a lot of setup. Mimics a
+// typical behavior's footprint: A bit of state, and a component lookup.
+template <int Type>
+struct FakeBehavior
+{
+  void update(
+    game_logic::GlobalDependencies&,
+    game_logic::GlobalState&,
+    const bool isOnScreen,
+    entityx::Entity entity)
+  {
+    auto& position = *entity.component<engine::components::WorldPosition>();
+    if (isOnScreen)
+    {
+      position.x += (mFramesElapsed % 2) * Type;
+    }
+
+    ++mFramesElapsed;
+  }
+
+  int mFramesElapsed = 0;
+  base::Vec2 mTarget;
+};
+
+
+template <int... Types>
+auto makeFakeBehaviorAssigners(std::integer_sequence<int, Types...>)
+{
+  using game_logic::components::BehaviorController;
+
+  return std::array<void (*)(entityx::Entity), sizeof...(Types)>{
+    [](entityx::Entity entity) {
+      entity.assign<BehaviorController>(FakeBehavior<Types>{});
+    }...};
+}
+
+
+void spawnFakeBehaviors(entityx::EntityManager& entities, const int count)
+{
+  static const auto assigners =
+    makeFakeBehaviorAssigners(std::make_integer_sequence<int, 12>{});
+
+  for (auto i = 0; i < count; ++i)
+  {
+    auto entity = entities.create();
+    entity.assign<engine::components::WorldPosition>(i, 0);
+    entity.assign<engine::components::Active>();
+
+    // Interleave types, like in a level where actors are placed in no
+    // particular order
+    assigners[i % assigners.size()](entity);
+  }
+}
+
+} // namespace
+
+
+static void BMMarkActiveEntities(benchmark::State& state)
+{
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+
+  bench::spawnPhysicalObjects(entities, int(state.range(0)));
+
+  // Alternate between two camera positions, so that the Active tag is
+  // actually added and removed
+  const auto cameraPositions =
+    std::array<base::Vec2, 2>{base::Vec2{0, 0}, base::Vec2{100, 60}};
+  auto frame = 0;
+
+  for (auto _ : state)
+  {
+    engine::markActiveEntities(
+      entities,
+      cameraPositions[frame % 2],
+      data::GameTraits::mapViewportSize);
+    ++frame;
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BMMarkActiveEntities)
+  ->RangeMultiplier(4)
+  ->Range(16, 4096)
+  ->Complexity();
+
+
+static void BMEntityActivationSystemUpdate(benchmark::State& state)
+{
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+
+  bench::spawnPhysicalObjects(entities, int(state.range(0)));
+
+  engine::EntityActivationSystem activationSystem{entities, events};
+
+  // Same camera movement as in BMMarkActiveEntities
+  const auto cameraPositions =
+    std::array<base::Vec2, 2>{base::Vec2{0, 0}, base::Vec2{100, 60}};
+  auto frame = 0;
+
+  for (auto _ : state)
+  {
+    activationSystem.update(
+      cameraPositions[frame % 2], data::GameTraits::mapViewportSize);
+    ++frame;
+  }
+
+  state.counters["visited"] = double(activationSystem.numVisitedEntities());
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BMEntityActivationSystemUpdate)
+  ->RangeMultiplier(4)
+  ->Range(16, 4096)
+  ->Complexity();
+
+
+static void BMSpriteRenderingSystemUpdate(benchmark::State& state)
+{
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+
+  const auto drawData = bench::createFixtureSpriteDrawData();
+  bench::spawnPhysicalObjects(entities, int(state.range(0)), &drawData);
+
+  // Only the CPU side (collecting and sorting visible sprites) is measured,
+  // which doesn't need a renderer or texture atlas.
+  engine::SpriteRenderingSystem spriteRenderingSystem{
+    nullptr, nullptr, entities, events};
+
+  // Make the whole map visible, so that all sprites are collected
+  const auto viewportSize =
+    base::Size{bench::FIXTURE_MAP_WIDTH, bench::FIXTURE_MAP_HEIGHT};
+
+  for (auto _ : state)
+  {
+    spriteRenderingSystem.invalidateSpatialIndex();
+    spriteRenderingSystem.update(viewportSize, {}, 0.5f);
+    benchmark::DoNotOptimize(spriteRenderingSystem.cloakEffectSpritesVisible());
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BMSpriteRenderingSystemUpdate)
+  ->RangeMultiplier(4)
+  ->Range(16, 4096)
+  ->Complexity();
+
+
+static void BMSpriteRenderingSystemUpdateViewport(benchmark::State& state)
+{
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+
+  const auto drawData = bench::createFixtureSpriteDrawData();
+  bench::spawnPhysicalObjects(entities, int(state.range(0)), &drawData);
+
+  engine::SpriteRenderingSystem spriteRenderingSystem{
+    nullptr, nullptr, entities, events};
+
+  // Only a screen's worth of the map is visible, like in the actual game.
+  // The spatial index is only brought up to date on the first update,
+  // since nothing moves afterwards.
+  for (auto _ : state)
+  {
+    spriteRenderingSystem.update(data::GameTraits::mapViewportSize, {}, 0.5f);
+    benchmark::DoNotOptimize(spriteRenderingSystem.numVisibleSprites());
+  }
+
+  state.counters["visited"] =
+    double(spriteRenderingSystem.numVisitedEntities());
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BMSpriteRenderingSystemUpdateViewport)
+  ->RangeMultiplier(4)
+  ->Range(16, 4096)
+  ->Complexity();
+
+
+static void BMParticleSystemUpdate(benchmark::State& state)
+{
+  engine::RandomNumberGenerator randomGenerator;
+  engine::ParticleSystem particleSystem{&randomGenerator, nullptr};
+
+  const auto numGroups = int(state.range(0));
+
+  // Particle groups expire after a fixed number of frames. Each iteration
+  // spawns the given number of groups and then simulates them until they
+  // have all expired.
+  for (auto _ : state)
+  {
+    for (auto i = 0; i < numGroups; ++i)
+    {
+      const auto origin = base::Vec2{i % bench::FIXTURE_MAP_WIDTH, 50};
+      const auto& color = data::GameTraits::INGAME_PALETTE[i % 16];
+      particleSystem.spawnParticles(origin, color);
+    }
+
+    for (auto frame = 0; frame < 30; ++frame)
+    {
+      particleSystem.update();
+    }
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BMParticleSystemUpdate)
+  ->RangeMultiplier(4)
+  ->Range(1, 256)
+  ->Complexity();
+
+
+static void BMParticleSystemStress(benchmark::State& state)
+{
+  engine::RandomNumberGenerator randomGenerator;
+  engine::ParticleSystem particleSystem{&randomGenerator, nullptr};
+
+  const auto numGroups = int(state.range(0));
+
+  // Like BMParticleSystemUpdate, but also generates the vertices for each
+  // frame, at two render frames per logic frame like with motion smoothing
+  // at 60 FPS. The upper end of the range is far beyond anything that
+  // happens in the original levels.
+  for (auto _ : state)
+  {
+    for (auto i = 0; i < numGroups; ++i)
+    {
+      const auto origin = base::Vec2{i % bench::FIXTURE_MAP_WIDTH, 50};
+      const auto& color = data::GameTraits::INGAME_PALETTE[i % 16];
+      particleSystem.spawnParticles(origin, color);
+    }
+
+    for (auto frame = 0; frame < 30; ++frame)
+    {
+      particleSystem.update();
+      benchmark::DoNotOptimize(particleSystem.computeVertices({}, 0.0f));
+      benchmark::DoNotOptimize(particleSystem.computeVertices({}, 0.5f));
+    }
+  }
+
+  state.counters["particles"] = benchmark::Counter(
+    double(numGroups * engine::ParticleSystem::PARTICLES_PER_GROUP));
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BMParticleSystemStress)
+  ->RangeMultiplier(4)
+  ->Range(1, 4096)
+  ->Complexity();
+
+
+static void BMBehaviorControllerUpdate(benchmark::State& state)
+{
+  using game_logic::BehaviorControllerSystem;
+
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+
+  spawnFakeBehaviors(entities, int(state.range(0)));
+
+  base::Vec2 cameraPosition;
+  BehaviorControllerSystem behaviorControllerSystem{
+    game_logic::GlobalDependencies{
+      nullptr, nullptr, nullptr, nullptr, nullptr, &entities, &events},
+    nullptr,
+    &cameraPosition,
+    nullptr};
+  using DispatchMode = BehaviorControllerSystem::DispatchMode;
+  behaviorControllerSystem.setDispatchMode(
+    state.range(1) == 0 ? DispatchMode::EntityOrder
+                        : DispatchMode::GroupedByType);
+
+  game_logic::PerFrameState perFrameState;
+
+  for (auto _ : state)
+  {
+    behaviorControllerSystem.update(entities, perFrameState);
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BMBehaviorControllerUpdate)
+  ->ArgNames({"entities", "grouped"})
+  ->RangeMultiplier(4)
+  ->Ranges({{16, 4096}, {0, 1}});
+
+
+static void BMSpawnTransientEntityBurst(benchmark::State& state)
+{
+  const auto reserve = state.range(0) != 0;
+
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    {
+      entityx::EventManager events;
+      entityx::EntityManager entities{events};
+      bench::spawnPhysicalObjects(entities, 256);
+
+      if (reserve)
+      {
+        engine::reserveEntities(entities, 1024);
+      }
+
+      state.ResumeTiming();
+
+      // Roughly the number of debris pieces spawned when a large map
+      // section explodes
+      bench::spawnPhysicalObjects(entities, 1024);
+      benchmark::ClobberMemory();
+
+      state.PauseTiming();
+    }
+    state.ResumeTiming();
+  }
+}
+
+BENCHMARK(BMSpawnTransientEntityBurst)->ArgName("reserved")->Arg(0)->Arg(1);
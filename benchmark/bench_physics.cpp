@@ -0,0 +1,263 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fixtures.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <engine/collision_checker.hpp>
+#include <engine/component_group.hpp>
+#include <engine/physics_system.hpp>
+
+#include <random>
+
+
+using namespace rigel;
+
+
+static void BMPhysicsSystemUpdate(benchmark::State& state)
+{
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+
+  const auto map = bench::createFixtureMap();
+  engine::CollisionChecker collisionChecker{&map, entities, events};
+  engine::PhysicsSystem physicsSystem{&collisionChecker, &map, &events};
+
+  bench::spawnPhysicalObjects(entities, int(state.range(0)));
+
+  for (auto _ : state)
+  {
+    physicsSystem.update(entities);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BMPhysicsSystemUpdate)
+  ->RangeMultiplier(4)
+  ->Range(16, 4096)
+  ->Complexity();
+
+
+namespace
+{
+
+struct CollisionEventCounter : entityx::Receiver<CollisionEventCounter>
+{
+  void receive(const engine::events::CollidedWithWorld&) { ++mCount; }
+
+  int mCount = 0;
+};
+
+} // namespace
+
+
+static void BMPhysicsSystemCollisionEvents(benchmark::State& state)
+{
+  using CollisionEventMode = engine::PhysicsSystem::CollisionEventMode;
+
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+
+  const auto map = bench::createFixtureMap();
+  engine::CollisionChecker collisionChecker{&map, entities, events};
+  engine::PhysicsSystem physicsSystem{&collisionChecker, &map, &events};
+  physicsSystem.setCollisionEventMode(
+    state.range(0) != 0 ? CollisionEventMode::Deferred
+                        : CollisionEventMode::Immediate);
+
+  CollisionEventCounter counter;
+  events.subscribe<engine::events::CollidedWithWorld>(counter);
+
+  bench::spawnPhysicalObjects(entities, 1024);
+
+  for (auto _ : state)
+  {
+    physicsSystem.update(entities);
+    physicsSystem.flushCollisionEvents();
+  }
+
+  benchmark::DoNotOptimize(counter.mCount);
+}
+
+BENCHMARK(BMPhysicsSystemCollisionEvents)->ArgName("deferred")->Arg(0)->Arg(1);
+
+
+namespace
+{
+
+// Mixes the given number of physical objects with three times as many
+// entities which only have a position and bounding box, like most of the
+// static decoration and triggers found in real levels.
+void spawnMixedPopulation(entityx::EntityManager& entities, const int count)
+{
+  using namespace engine::components;
+
+  for (auto i = 0; i < count; ++i)
+  {
+    bench::spawnPhysicalObjects(entities, 1, nullptr, bench::FIXTURE_SEED + i);
+
+    for (auto j = 0; j < 3; ++j)
+    {
+      auto entity = entities.create();
+      entity.assign<WorldPosition>(i % bench::FIXTURE_MAP_WIDTH, j);
+      entity.assign<BoundingBox>(BoundingBox{{}, {1, 1}});
+    }
+  }
+}
+
+} // namespace
+
+
+static void BMComponentIterationEntityManager(benchmark::State& state)
+{
+  using namespace engine::components;
+
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+  spawnMixedPopulation(entities, int(state.range(0)));
+
+  for (auto _ : state)
+  {
+    auto sum = 0;
+    entities.each<MovingBody, WorldPosition, BoundingBox, Active>(
+      [&](
+        entityx::Entity,
+        MovingBody& body,
+        WorldPosition& position,
+        BoundingBox& bbox,
+        const Active&) {
+        sum += position.x + bbox.size.width + int(body.mVelocity.x);
+      });
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BMComponentIterationEntityManager)->Arg(64)->Arg(512)->Arg(4096);
+
+
+static void BMComponentIterationGroup(benchmark::State& state)
+{
+  using namespace engine::components;
+
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+  engine::ComponentGroup<MovingBody, WorldPosition, BoundingBox> group{
+    entities, events};
+  spawnMixedPopulation(entities, int(state.range(0)));
+
+  for (auto _ : state)
+  {
+    auto sum = 0;
+    group.each([&](
+                 entityx::Entity entity,
+                 MovingBody& body,
+                 WorldPosition& position,
+                 BoundingBox& bbox) {
+      if (entity.has_component<Active>())
+      {
+        sum += position.x + bbox.size.width + int(body.mVelocity.x);
+      }
+    });
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BMComponentIterationGroup)->Arg(64)->Arg(512)->Arg(4096);
+
+
+static void BMCollisionCheckerHorizontalSpans(benchmark::State& state)
+{
+  using data::map::SolidEdge;
+
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+
+  const auto map = bench::createFixtureMap();
+  engine::CollisionChecker collisionChecker{&map, entities, events};
+
+  const auto spanLength = int(state.range(0));
+  std::mt19937 randomGenerator{bench::FIXTURE_SEED};
+  std::uniform_int_distribution<int> xDistribution{
+    0, bench::FIXTURE_MAP_WIDTH - spanLength};
+  std::uniform_int_distribution<int> yDistribution{
+    0, bench::FIXTURE_MAP_HEIGHT - 1};
+
+  std::vector<base::Vec2> startPositions;
+  for (auto i = 0; i < 1024; ++i)
+  {
+    startPositions.emplace_back(
+      xDistribution(randomGenerator), yDistribution(randomGenerator));
+  }
+
+  for (auto _ : state)
+  {
+    for (const auto& pos : startPositions)
+    {
+      benchmark::DoNotOptimize(collisionChecker.testHorizontalSpan(
+        pos.x, pos.x + spanLength - 1, pos.y, SolidEdge::top()));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * startPositions.size());
+}
+
+BENCHMARK(BMCollisionCheckerHorizontalSpans)->Arg(1)->Arg(3)->Arg(8)->Arg(32);
+
+
+static void BMCollisionCheckerVerticalSpans(benchmark::State& state)
+{
+  using data::map::SolidEdge;
+
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+
+  const auto map = bench::createFixtureMap();
+  engine::CollisionChecker collisionChecker{&map, entities, events};
+
+  const auto spanLength = int(state.range(0));
+  std::mt19937 randomGenerator{bench::FIXTURE_SEED};
+  std::uniform_int_distribution<int> xDistribution{
+    0, bench::FIXTURE_MAP_WIDTH - 1};
+  std::uniform_int_distribution<int> yDistribution{
+    0, bench::FIXTURE_MAP_HEIGHT - spanLength};
+
+  std::vector<base::Vec2> startPositions;
+  for (auto i = 0; i < 1024; ++i)
+  {
+    startPositions.emplace_back(
+      xDistribution(randomGenerator), yDistribution(randomGenerator));
+  }
+
+  for (auto _ : state)
+  {
+    for (const auto& pos : startPositions)
+    {
+      benchmark::DoNotOptimize(collisionChecker.testVerticalSpan(
+        pos.y, pos.y + spanLength - 1, pos.x, SolidEdge::left()));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * startPositions.size());
+}
+
+BENCHMARK(BMCollisionCheckerVerticalSpans)->Arg(1)->Arg(3)->Arg(8)->Arg(32);
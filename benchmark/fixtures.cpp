@@ -0,0 +1,128 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fixtures.hpp"
+
+#include <engine/base_components.hpp>
+#include <engine/physical_components.hpp>
+
+
+namespace rigel::bench
+{
+
+using namespace engine::components;
+
+
+data::map::Map createFixtureMap()
+{
+  using data::map::TileAttributeDict;
+
+  auto map = data::map::Map{
+    FIXTURE_MAP_WIDTH,
+    FIXTURE_MAP_HEIGHT,
+    TileAttributeDict{TileAttributeDict::AttributeArray{0x0, 0xF, 0x1}}};
+
+  for (auto x = 0; x < FIXTURE_MAP_WIDTH; ++x)
+  {
+    map.setTileAt(0, x, FIXTURE_MAP_HEIGHT - 1, FixtureTile::Solid);
+  }
+
+  for (auto y = 0; y < FIXTURE_MAP_HEIGHT; ++y)
+  {
+    map.setTileAt(0, 0, y, FixtureTile::Solid);
+    map.setTileAt(0, FIXTURE_MAP_WIDTH - 1, y, FixtureTile::Solid);
+  }
+
+  std::mt19937 randomGenerator{FIXTURE_SEED};
+  std::uniform_int_distribution<int> xDistribution{1, FIXTURE_MAP_WIDTH - 14};
+  std::uniform_int_distribution<int> lengthDistribution{3, 12};
+  std::uniform_int_distribution<int> heightDistribution{2, 6};
+
+  // One platform every few rows, plus some pillars standing on the floor
+  for (auto y = 8; y < FIXTURE_MAP_HEIGHT - 2; y += 4)
+  {
+    for (auto i = 0; i < 6; ++i)
+    {
+      const auto left = xDistribution(randomGenerator);
+      const auto length = lengthDistribution(randomGenerator);
+      const auto tile =
+        i % 2 == 0 ? FixtureTile::Platform : FixtureTile::Solid;
+
+      for (auto x = left; x < left + length; ++x)
+      {
+        map.setTileAt(0, x, y, tile);
+      }
+    }
+  }
+
+  for (auto i = 0; i < 40; ++i)
+  {
+    const auto x = xDistribution(randomGenerator);
+    const auto height = heightDistribution(randomGenerator);
+
+    for (auto y = FIXTURE_MAP_HEIGHT - 1 - height; y < FIXTURE_MAP_HEIGHT - 1;
+         ++y)
+    {
+      map.setTileAt(1, x, y, FixtureTile::Solid);
+    }
+  }
+
+  return map;
+}
+
+
+engine::SpriteDrawData createFixtureSpriteDrawData()
+{
+  engine::SpriteDrawData drawData;
+  for (auto i = 0; i < 4; ++i)
+  {
+    drawData.mFrames.emplace_back(i, base::Vec2{}, base::Size{2, 2});
+  }
+  drawData.mDrawOrder = 0;
+
+  return drawData;
+}
+
+
+void spawnPhysicalObjects(
+  entityx::EntityManager& entities,
+  const int count,
+  const engine::SpriteDrawData* pDrawData,
+  const std::uint32_t seed)
+{
+  std::mt19937 randomGenerator{seed};
+  std::uniform_int_distribution<int> xDistribution{1, FIXTURE_MAP_WIDTH - 3};
+  std::uniform_int_distribution<int> yDistribution{1, FIXTURE_MAP_HEIGHT - 2};
+  std::uniform_int_distribution<int> velocityDistribution{-1, 1};
+
+  for (auto i = 0; i < count; ++i)
+  {
+    auto entity = entities.create();
+    entity.assign<WorldPosition>(
+      xDistribution(randomGenerator), yDistribution(randomGenerator));
+    entity.assign<BoundingBox>(BoundingBox{{}, {2, 2}});
+    entity.assign<MovingBody>(
+      base::Vec2f{float(velocityDistribution(randomGenerator)), 0.0f}, true);
+    entity.assign<Active>();
+
+    if (pDrawData)
+    {
+      entity.assign<Sprite>(pDrawData, std::vector<int>{i % 4});
+    }
+  }
+}
+
+} // namespace rigel::bench
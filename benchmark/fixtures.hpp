@@ -0,0 +1,83 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <base/warnings.hpp>
+#include <data/map.hpp>
+#include <engine/visual_components.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdint>
+#include <random>
+
+
+/** Synthetic fixtures shared by the benchmarks
+ *
+ * Everything here is generated from a fixed seed, so that results are
+ * comparable between runs and releases. No game data files are needed.
+ */
+namespace rigel::bench
+{
+
+constexpr auto FIXTURE_SEED = std::uint32_t{42};
+
+// Same dimensions as a typical wide level in the original game
+constexpr auto FIXTURE_MAP_WIDTH = 256;
+constexpr auto FIXTURE_MAP_HEIGHT = 127;
+
+
+/** Tile indices used by the fixture map */
+enum FixtureTile : data::map::TileIndex
+{
+  Empty = 0,
+  Solid = 1,
+  Platform = 2, // solid on top only
+};
+
+
+/** Creates a level-like map
+ *
+ * The map is enclosed by solid walls and a floor, and contains randomly
+ * placed platforms and pillars.
+ */
+data::map::Map createFixtureMap();
+
+
+/** Creates a sprite definition with a few 2x2 frames
+ *
+ * Sprites refer to their draw data via pointer, so the returned object must
+ * outlive all entities using it.
+ */
+engine::SpriteDrawData createFixtureSpriteDrawData();
+
+
+/** Spawns gravity affected, active entities at random positions in the map
+ *
+ * Entities get a Sprite using the given draw data (if not null), a
+ * BoundingBox, a WorldPosition, a MovingBody with a random horizontal
+ * velocity and an Active tag.
+ */
+void spawnPhysicalObjects(
+  entityx::EntityManager& entities,
+  int count,
+  const engine::SpriteDrawData* pDrawData = nullptr,
+  std::uint32_t seed = FIXTURE_SEED);
+
+} // namespace rigel::bench
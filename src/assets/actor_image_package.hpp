@@ -53,7 +53,7 @@ public:
   static constexpr auto IMAGE_DATA_FILE = "ACTORS.MNI";
   static constexpr auto ACTOR_INFO_FILE = "ACTRINFO.MNI";
 
-  ActorImagePackage(ByteBuffer imageData, const ByteBuffer& actorInfoData);
+  ActorImagePackage(FileData imageData, ByteBufferView actorInfoData);
 
   const ActorHeader& loadActorInfo(data::ActorID id) const;
   data::Image loadImage(
@@ -68,7 +68,7 @@ public:
   }
 
 private:
-  const ByteBuffer mImageData;
+  const FileData mImageData;
   std::map<data::ActorID, ActorHeader> mHeadersById;
   std::vector<int> mDrawIndexById;
 };
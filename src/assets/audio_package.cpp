@@ -38,7 +38,7 @@ struct AudioDictEntry
 };
 
 
-std::vector<AudioDictEntry> readAudioDict(const ByteBuffer& data)
+std::vector<AudioDictEntry> readAudioDict(const ByteBufferView data)
 {
   const auto numOffsets = data.size() / sizeof(uint32_t);
 
@@ -94,18 +94,22 @@ AdlibSound parseAdlibSound(LeStreamReader& reader)
 
 
 AudioPackage loadAdlibSoundData(
-  const ByteBuffer& audioDictData,
-  const ByteBuffer& bundledAudioData)
+  const ByteBufferView audioDictData,
+  const ByteBufferView bundledAudioData)
 {
   AudioPackage sounds;
 
   const auto audioDict = readAudioDict(audioDictData);
-  if (audioDict.size() < 68u)
+  // The AdLib sounds are preceded by the PC speaker versions of the same
+  // sounds
+  const auto firstAdlibSound = NUM_ADLIB_SOUNDS;
+  const auto endOfAdlibSounds = firstAdlibSound + NUM_ADLIB_SOUNDS;
+  if (audioDict.size() < endOfAdlibSounds)
   {
     throw std::invalid_argument("Corrupt Duke Nukem II AUDIOT/AUDIOHED");
   }
 
-  for (auto i = 34u; i < 68u; ++i)
+  for (auto i = firstAdlibSound; i < endOfAdlibSounds; ++i)
   {
     const auto& dictEntry = audioDict[i];
 
@@ -28,6 +28,10 @@ namespace rigel::assets
 constexpr auto AUDIO_DICT_FILE = "AUDIOHED.MNI";
 constexpr auto AUDIO_DATA_FILE = "AUDIOT.MNI";
 
+// Number of AdLib sound effects in the audio package. The intro sounds are
+// only available as digitized sounds.
+constexpr auto NUM_ADLIB_SOUNDS = 34u;
+
 
 struct AdlibSound
 {
@@ -39,7 +43,7 @@ struct AdlibSound
 using AudioPackage = std::vector<AdlibSound>;
 
 AudioPackage loadAdlibSoundData(
-  const ByteBuffer& audioDictData,
-  const ByteBuffer& bundledAudioData);
+  ByteBufferView audioDictData,
+  ByteBufferView bundledAudioData);
 
 } // namespace rigel::assets
@@ -16,7 +16,10 @@
 
 #pragma once
 
+#include "base/array_view.hpp"
+
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 
@@ -25,7 +28,56 @@ namespace rigel::assets
 
 using ByteBuffer = std::vector<std::uint8_t>;
 using ByteBuferIter = ByteBuffer::iterator;
-using ByteBufferCIter = ByteBuffer::const_iterator;
+
+/** Non-owning view of a ByteBuffer or other contiguous bytes
+ *
+ * All decoders take their input as a view, so that they can work directly on
+ * data from the memory-mapped CMP file. A ByteBuffer implicitly converts to
+ * a view.
+ */
+using ByteBufferView = base::ArrayView<std::uint8_t>;
+using ByteBufferCIter = ByteBufferView::const_iterator;
+
+
+/** Contents of a game data file
+ *
+ * Files from the CMP package are a view into the memory-mapped package, while
+ * files loaded from disk (e.g. mod replacements) are owned by this object.
+ * Either way, the data can be used like a ByteBufferView.
+ *
+ * Move-only: moving a std::vector keeps its storage, so the view stays valid,
+ * but copying wouldn't.
+ */
+class FileData
+{
+public:
+  explicit FileData(const ByteBufferView view)
+    : mView(view)
+  {
+  }
+
+  explicit FileData(ByteBuffer data)
+    : mOwnedData(std::move(data))
+    , mView(mOwnedData)
+  {
+  }
+
+  FileData(FileData&&) = default;
+  FileData& operator=(FileData&&) = default;
+  FileData(const FileData&) = delete;
+  FileData& operator=(const FileData&) = delete;
+
+  ByteBufferView view() const { return mView; }
+
+  const std::uint8_t* data() const { return mView.data(); }
+  ByteBufferView::size_type size() const { return mView.size(); }
+  ByteBufferCIter begin() const { return mView.begin(); }
+  ByteBufferCIter end() const { return mView.end(); }
+
+private:
+  ByteBuffer mOwnedData;
+  ByteBufferView mView;
+};
 
 
 } // namespace rigel::assets
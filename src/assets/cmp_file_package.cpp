@@ -19,7 +19,10 @@
 #include "assets/file_utils.hpp"
 #include "base/string_utils.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cctype>
 #include <stdexcept>
 
 
@@ -32,6 +35,10 @@ using namespace std;
 namespace
 {
 
+// File names in the package's dictionary are at most 12 characters long
+constexpr auto MAX_FILE_NAME_LENGTH = std::size_t{12};
+
+
 std::string normalizedFileName(std::string_view fileName)
 {
   return strings::toUppercase(fileName);
@@ -41,13 +48,15 @@ std::string normalizedFileName(std::string_view fileName)
 
 
 CMPFilePackage::CMPFilePackage(const std::filesystem::path& filePath)
-  : mFileData(loadFile(filePath))
+  : mFile(filePath)
 {
-  LeStreamReader dictReader(mFileData.begin(), mFileData.end());
+  const auto fileData = mFile.data();
+  LeStreamReader dictReader(fileData);
 
   while (dictReader.hasData())
   {
-    const auto fileName = readFixedSizeString(dictReader, 12);
+    const auto fileName =
+      readFixedSizeString(dictReader, MAX_FILE_NAME_LENGTH);
     const auto fileOffset = dictReader.readU32();
     const auto fileSize = dictReader.readU32();
 
@@ -55,7 +64,7 @@ CMPFilePackage::CMPFilePackage(const std::filesystem::path& filePath)
     {
       break;
     }
-    if (fileOffset + fileSize > mFileData.size())
+    if (std::uint64_t{fileOffset} + fileSize > fileData.size())
     {
       throw invalid_argument("Malformed dictionary in CMP file");
     }
@@ -67,6 +76,13 @@ CMPFilePackage::CMPFilePackage(const std::filesystem::path& filePath)
 
 
 ByteBuffer CMPFilePackage::file(std::string_view name) const
+{
+  const auto view = fileView(name);
+  return ByteBuffer(view.begin(), view.end());
+}
+
+
+ByteBufferView CMPFilePackage::fileView(std::string_view name) const
 {
   const auto it = findFileEntry(name);
   if (it == mFileDict.end())
@@ -76,8 +92,8 @@ ByteBuffer CMPFilePackage::file(std::string_view name) const
   }
 
   const auto& fileHeader = it->second;
-  const auto fileStart = mFileData.begin() + fileHeader.fileOffset;
-  return ByteBuffer(fileStart, fileStart + fileHeader.fileSize);
+  return ByteBufferView{
+    mFile.data().data() + fileHeader.fileOffset, fileHeader.fileSize};
 }
 
 
@@ -90,7 +106,20 @@ bool CMPFilePackage::hasFile(std::string_view name) const
 CMPFilePackage::FileDict::const_iterator
   CMPFilePackage::findFileEntry(std::string_view name) const
 {
-  return mFileDict.find(normalizedFileName(name));
+  if (name.size() > MAX_FILE_NAME_LENGTH)
+  {
+    return mFileDict.end();
+  }
+
+  // Normalize into a stack buffer, to avoid allocating a std::string for
+  // each lookup
+  std::array<char, MAX_FILE_NAME_LENGTH> normalizedName;
+  std::transform(
+    name.begin(), name.end(), normalizedName.begin(), [](const char c) {
+      return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    });
+
+  return mFileDict.find(std::string_view{normalizedName.data(), name.size()});
 }
 
 
@@ -17,25 +17,39 @@
 #pragma once
 
 #include "assets/byte_buffer.hpp"
+#include "assets/mapped_file.hpp"
 
 #include <cstddef>
 #include <filesystem>
+#include <functional>
+#include <map>
 #include <string>
-#include <unordered_map>
-#include <vector>
+#include <string_view>
 
 
 namespace rigel::assets
 {
 
 
+/** Provides access to the files contained in a CMP package (NUKEM2.CMP)
+ *
+ * The package is memory-mapped, so only the parts of it which are actually
+ * used end up being read from disk.
+ */
 class CMPFilePackage
 {
 public:
   explicit CMPFilePackage(const std::filesystem::path& filePath);
 
+  /** Returns a copy of the given file's data */
   ByteBuffer file(std::string_view name) const;
 
+  /** Returns a view of the given file's data, without copying
+   *
+   * The view remains valid for the lifetime of the package.
+   */
+  ByteBufferView fileView(std::string_view name) const;
+
   bool hasFile(std::string_view name) const;
 
 private:
@@ -49,12 +63,14 @@ private:
     const std::uint32_t fileSize = 0;
   };
 
-  using FileDict = std::unordered_map<std::string, DictEntry>;
+  // std::less<> enables lookup via std::string_view, without having to
+  // create a temporary std::string
+  using FileDict = std::map<std::string, DictEntry, std::less<>>;
 
   FileDict::const_iterator findFileEntry(std::string_view name) const;
 
 private:
-  std::vector<std::uint8_t> mFileData;
+  MappedFile mFile;
   FileDict mFileDict;
 };
 
@@ -17,8 +17,8 @@
 #include "ega_image_decoder.hpp"
 
 #include "assets/bitwise_iter.hpp"
+#include "assets/ega_pixel_decoder.hpp"
 #include "assets/file_utils.hpp"
-#include "base/container_utils.hpp"
 #include "base/math_utils.hpp"
 #include "data/unit_conversions.hpp"
 
@@ -38,9 +38,6 @@ using data::tilesToPixels;
 namespace
 {
 
-using PalettizedPixelBuffer = std::vector<std::uint8_t>;
-
-
 size_t inferHeight(
   const ByteBufferCIter begin,
   const ByteBufferCIter end,
@@ -72,34 +69,6 @@ SourceIter readEgaMaskPlane(
   return source;
 }
 
-/** Decode EGA color data (4 planes)
- *
- * Pre-conditions:
- *   target points to zero-initialized buffer of bytes.
- *   target can be advanced pixelCount times.
- *   source can be advanced pixelCount*4 times.
- */
-template <typename SourceIter, typename TargetIter>
-SourceIter readEgaColorData(
-  SourceIter source,
-  TargetIter target,
-  const size_t pixelCount)
-{
-  for (auto plane = 0u; plane < GameTraits::egaPlanes; ++plane)
-  {
-    auto targetIterForPlane = target;
-
-    for (auto pixel = 0u; pixel < pixelCount; ++pixel)
-    {
-      const auto planeBit = *source++;
-      *targetIterForPlane++ |= planeBit << plane;
-    }
-  }
-
-  return source;
-}
-
-
 /** Decode EGA monochromatic data (1 plane)
  *
  * Pre-conditions:
@@ -189,16 +158,21 @@ data::PixelBuffer decodeSimplePlanarEgaBuffer(
 {
   const auto numBytes = distance(begin, end);
   assert(numBytes > 0);
-  const auto numPixels = static_cast<size_t>(numBytes / GameTraits::egaPlanes) *
-    GameTraits::pixelsPerEgaByte;
 
-  BitWiseIterator<ByteBufferCIter> bitsIter(begin);
-  PalettizedPixelBuffer indexedPixels(numPixels, 0);
-  readEgaColorData(bitsIter, indexedPixels.begin(), numPixels);
+  // The image is stored as 4 consecutive planes, each holding one bit for
+  // every pixel
+  const auto bytesPerPlane =
+    static_cast<size_t>(numBytes) / GameTraits::egaPlanes;
 
-  return utils::transformed(indexedPixels, [&palette](const auto colorIndex) {
-    return palette[colorIndex];
-  });
+  PixelBuffer pixels(bytesPerPlane * GameTraits::pixelsPerEgaByte);
+  EgaPixelDecoder{palette}.decode(
+    begin,
+    bytesPerPlane,
+    EgaPlaneLayout{1, bytesPerPlane, false},
+    pixels.data(),
+    GameTraits::pixelsPerEgaByte);
+
+  return pixels;
 }
 
 
@@ -209,39 +183,39 @@ data::Image loadTiledImage(
   const data::Palette16& palette,
   const data::TileImageType type)
 {
+  const auto bytesPerTile = GameTraits::bytesPerTile(type);
   const auto heightInTiles =
-    inferHeight(begin, end, widthInTiles, GameTraits::bytesPerTile(type));
+    inferHeight(begin, end, widthInTiles, bytesPerTile);
 
-  auto pixels = decodeTiledEgaData(
-    begin,
-    widthInTiles,
-    heightInTiles,
-    [&palette, type](auto sourceBitsIter, const auto targetPixelIter) {
-      const auto isMasked = type == data::TileImageType::Masked;
-      array<bool, GameTraits::tileSize> pixelMask;
-      if (isMasked)
-      {
-        sourceBitsIter = readEgaMaskPlane(
-          sourceBitsIter, pixelMask.begin(), GameTraits::tileSize);
-      }
-
-      array<uint8_t, GameTraits::tileSize> indexedPixels;
-      indexedPixels.fill(0);
-      sourceBitsIter = readEgaColorData(
-        sourceBitsIter, indexedPixels.begin(), GameTraits::tileSize);
+  // Each row of a tile is one group of 8 pixels, with the planes stored
+  // right after each other
+  const auto numPlanes = GameTraits::numPlanes(type);
+  const auto layout =
+    EgaPlaneLayout{numPlanes, 1, type == data::TileImageType::Masked};
 
-      for (auto i = 0; i < GameTraits::tileSize; ++i)
-      {
-        *(targetPixelIter + i) = palette[indexedPixels[i]];
-      }
+  const auto decoder = EgaPixelDecoder{palette};
 
-      if (isMasked)
-      {
-        applyEgaMask(pixelMask.begin(), targetPixelIter, GameTraits::tileSize);
-      }
+  const auto targetBufferStride = tilesToPixels(widthInTiles);
+  PixelBuffer pixels(
+    widthInTiles * heightInTiles * GameTraits::tileSizeSquared);
 
-      return sourceBitsIter;
-    });
+  auto pSource = begin;
+  for (auto row = 0u; row < heightInTiles; ++row)
+  {
+    for (auto col = 0u; col < widthInTiles; ++col)
+    {
+      const auto insertStart =
+        tilesToPixels(col) + tilesToPixels(row) * targetBufferStride;
+
+      decoder.decode(
+        pSource,
+        GameTraits::tileSize,
+        layout,
+        pixels.data() + insertStart,
+        targetBufferStride);
+      pSource += bytesPerTile;
+    }
+  }
 
   return data::Image(
     std::move(pixels),
@@ -0,0 +1,293 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ega_pixel_decoder.hpp"
+
+#include "data/game_traits.hpp"
+
+#include <array>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                   \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define RIGEL_EGA_DECODER_USE_SSE2
+  #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #define RIGEL_EGA_DECODER_USE_NEON
+  #include <arm_neon.h>
+#endif
+
+
+namespace rigel::assets
+{
+
+using data::GameTraits;
+
+
+namespace
+{
+
+constexpr auto PIXELS_PER_GROUP = GameTraits::pixelsPerEgaByte;
+
+// Bit which is set in a decoded palette index if the pixel is masked out
+constexpr auto MASK_INDEX_BIT = 1u << GameTraits::egaPlanes;
+
+
+/** For each possible byte value, holds a 64-bit value where the N-th
+ * least significant byte is 1 if the bit corresponding to the N-th pixel is
+ * set, and 0 otherwise.
+ *
+ * This allows decoding a group of 8 pixels with one table lookup per plane.
+ */
+constexpr std::array<std::uint64_t, 256> makeBitSpreadTable()
+{
+  std::array<std::uint64_t, 256> table{};
+
+  for (auto value = 0u; value < table.size(); ++value)
+  {
+    for (auto pixel = 0u; pixel < PIXELS_PER_GROUP; ++pixel)
+    {
+      if (value & (0x80u >> pixel))
+      {
+        table[value] |= std::uint64_t{1} << (pixel * 8);
+      }
+    }
+  }
+
+  return table;
+}
+
+
+constexpr auto BIT_SPREAD_TABLE = makeBitSpreadTable();
+
+using ColorTable = std::array<data::Pixel, 32>;
+
+
+void decodeGroupScalar(
+  const std::uint8_t* pGroup,
+  const EgaPlaneLayout& layout,
+  const ColorTable& colors,
+  data::Pixel* pTarget)
+{
+  auto indices = std::uint64_t{0};
+
+  if (layout.mHasMask)
+  {
+    indices = BIT_SPREAD_TABLE[*pGroup] * MASK_INDEX_BIT;
+    pGroup += layout.mPlaneStride;
+  }
+
+  for (auto plane = 0u; plane < GameTraits::egaPlanes; ++plane)
+  {
+    indices |= BIT_SPREAD_TABLE[*pGroup] << plane;
+    pGroup += layout.mPlaneStride;
+  }
+
+  for (auto pixel = 0u; pixel < PIXELS_PER_GROUP; ++pixel)
+  {
+    pTarget[pixel] = colors[std::uint8_t(indices >> (pixel * 8))];
+  }
+}
+
+
+#if defined(RIGEL_EGA_DECODER_USE_SSE2)
+
+/** Turn the bits of two bytes into 16 bytes of 0xFF (bit set) or 0 */
+__m128i expandBits(const std::uint8_t first, const std::uint8_t second)
+{
+  // _mm_set_epi8 expects the elements in reverse order
+  const auto bitMasks = _mm_set_epi8(
+    1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+
+  // Broadcast the first byte into the lower 8 lanes, and the second one into
+  // the upper 8 lanes
+  auto bytes = _mm_cvtsi32_si128(first | (second << 8));
+  bytes = _mm_unpacklo_epi8(bytes, bytes);
+  bytes = _mm_unpacklo_epi16(bytes, bytes);
+  bytes = _mm_unpacklo_epi32(bytes, bytes);
+
+  return _mm_cmpeq_epi8(_mm_and_si128(bytes, bitMasks), bitMasks);
+}
+
+
+void decodeIndicesSimd(
+  const std::uint8_t* pFirstGroup,
+  const std::uint8_t* pSecondGroup,
+  const EgaPlaneLayout& layout,
+  std::uint8_t* pIndices)
+{
+  auto indices = _mm_setzero_si128();
+  auto addPlane = [&](const std::size_t offset, const unsigned bitValue) {
+    const auto bits = expandBits(pFirstGroup[offset], pSecondGroup[offset]);
+    indices = _mm_or_si128(
+      indices, _mm_and_si128(bits, _mm_set1_epi8(char(bitValue))));
+  };
+
+  auto offset = std::size_t{0};
+  if (layout.mHasMask)
+  {
+    addPlane(offset, MASK_INDEX_BIT);
+    offset += layout.mPlaneStride;
+  }
+
+  for (auto plane = 0u; plane < GameTraits::egaPlanes; ++plane)
+  {
+    addPlane(offset, 1u << plane);
+    offset += layout.mPlaneStride;
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(pIndices), indices);
+}
+
+#elif defined(RIGEL_EGA_DECODER_USE_NEON)
+
+/** Turn the bits of two bytes into 16 bytes of 0xFF (bit set) or 0 */
+uint8x16_t expandBits(const std::uint8_t first, const std::uint8_t second)
+{
+  static const std::uint8_t BIT_MASKS[] = {
+    0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+    0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01};
+
+  const auto bytes = vcombine_u8(vdup_n_u8(first), vdup_n_u8(second));
+  return vtstq_u8(bytes, vld1q_u8(BIT_MASKS));
+}
+
+
+void decodeIndicesSimd(
+  const std::uint8_t* pFirstGroup,
+  const std::uint8_t* pSecondGroup,
+  const EgaPlaneLayout& layout,
+  std::uint8_t* pIndices)
+{
+  auto indices = vdupq_n_u8(0);
+  auto addPlane = [&](const std::size_t offset, const unsigned bitValue) {
+    const auto bits = expandBits(pFirstGroup[offset], pSecondGroup[offset]);
+    indices =
+      vorrq_u8(indices, vandq_u8(bits, vdupq_n_u8(std::uint8_t(bitValue))));
+  };
+
+  auto offset = std::size_t{0};
+  if (layout.mHasMask)
+  {
+    addPlane(offset, MASK_INDEX_BIT);
+    offset += layout.mPlaneStride;
+  }
+
+  for (auto plane = 0u; plane < GameTraits::egaPlanes; ++plane)
+  {
+    addPlane(offset, 1u << plane);
+    offset += layout.mPlaneStride;
+  }
+
+  vst1q_u8(pIndices, indices);
+}
+
+#endif
+
+
+#if defined(RIGEL_EGA_DECODER_USE_SSE2) ||                                    \
+  defined(RIGEL_EGA_DECODER_USE_NEON)
+
+  #define RIGEL_EGA_DECODER_HAS_SIMD
+
+void decodeTwoGroupsSimd(
+  const std::uint8_t* pFirstGroup,
+  const std::uint8_t* pSecondGroup,
+  const EgaPlaneLayout& layout,
+  const ColorTable& colors,
+  data::Pixel* pFirstTarget,
+  data::Pixel* pSecondTarget)
+{
+  std::array<std::uint8_t, PIXELS_PER_GROUP * 2> indices;
+  decodeIndicesSimd(pFirstGroup, pSecondGroup, layout, indices.data());
+
+  for (auto pixel = 0u; pixel < PIXELS_PER_GROUP; ++pixel)
+  {
+    pFirstTarget[pixel] = colors[indices[pixel]];
+    pSecondTarget[pixel] = colors[indices[pixel + PIXELS_PER_GROUP]];
+  }
+}
+
+#endif
+
+} // namespace
+
+
+bool isSimdEgaDecodingAvailable()
+{
+#if defined(RIGEL_EGA_DECODER_HAS_SIMD)
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+EgaPixelDecoder::EgaPixelDecoder(
+  const data::Palette16& palette,
+  const EgaDecoderBackend backend)
+  : mBackend(backend)
+{
+  static_assert(std::tuple_size_v<ColorTable> == MASK_INDEX_BIT * 2);
+
+  for (auto i = 0u; i < palette.size(); ++i)
+  {
+    mColors[i] = palette[i];
+    mColors[i + MASK_INDEX_BIT] = palette[i];
+    mColors[i + MASK_INDEX_BIT].a = 0;
+  }
+}
+
+
+void EgaPixelDecoder::decode(
+  const std::uint8_t* pSource,
+  const std::size_t numGroups,
+  const EgaPlaneLayout& layout,
+  data::Pixel* pTarget,
+  const std::size_t targetStride) const
+{
+  auto group = std::size_t{0};
+
+#if defined(RIGEL_EGA_DECODER_HAS_SIMD)
+  if (mBackend == EgaDecoderBackend::Simd)
+  {
+    for (; group + 1 < numGroups; group += 2)
+    {
+      decodeTwoGroupsSimd(
+        pSource + group * layout.mGroupStride,
+        pSource + (group + 1) * layout.mGroupStride,
+        layout,
+        mColors,
+        pTarget + group * targetStride,
+        pTarget + (group + 1) * targetStride);
+    }
+  }
+#else
+  static_cast<void>(mBackend);
+#endif
+
+  // Remaining group in case of an odd count, or everything if we're not
+  // using SIMD
+  for (; group < numGroups; ++group)
+  {
+    decodeGroupScalar(
+      pSource + group * layout.mGroupStride,
+      layout,
+      mColors,
+      pTarget + group * targetStride);
+  }
+}
+
+} // namespace rigel::assets
@@ -0,0 +1,96 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/image.hpp"
+#include "data/palette.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace rigel::assets
+{
+
+/** Describes where the bit planes of planar EGA data are located
+ *
+ * Planar EGA data is decoded in groups of 8 pixels, with one byte per plane
+ * for each group. The most significant bit of each byte corresponds to the
+ * left-most pixel. If there is a mask plane, it comes before the 4 color
+ * planes. A set mask bit makes the corresponding pixel transparent.
+ */
+struct EgaPlaneLayout
+{
+  // Distance in bytes between the start of two consecutive groups
+  std::size_t mGroupStride;
+
+  // Distance in bytes between the planes of a single group
+  std::size_t mPlaneStride;
+
+  bool mHasMask;
+};
+
+
+enum class EgaDecoderBackend
+{
+  // Portable implementation, decodes 8 pixels at a time using a lookup table
+  Scalar,
+
+  // Decodes 16 pixels at a time using SSE2 or NEON. Falls back to the scalar
+  // implementation if neither is available on the target platform.
+  Simd
+};
+
+
+/** True if the Simd backend is actually using vector instructions */
+bool isSimdEgaDecodingAvailable();
+
+
+/** Decodes planar EGA data into RGBA pixels
+ *
+ * Both backends produce identical results.
+ */
+class EgaPixelDecoder
+{
+public:
+  explicit EgaPixelDecoder(
+    const data::Palette16& palette,
+    EgaDecoderBackend backend = EgaDecoderBackend::Simd);
+
+  /** Decode numGroups groups of 8 pixels each
+   *
+   * The pixels of each group are written to consecutive locations, with
+   * targetStride pixels between the start of two consecutive groups in the
+   * target buffer.
+   */
+  void decode(
+    const std::uint8_t* pSource,
+    std::size_t numGroups,
+    const EgaPlaneLayout& layout,
+    data::Pixel* pTarget,
+    std::size_t targetStride) const;
+
+private:
+  // The palette, followed by fully transparent versions of each color. Can
+  // be indexed directly with a decoded color index that includes the mask
+  // bit.
+  std::array<data::Pixel, 32> mColors;
+  EgaDecoderBackend mBackend;
+};
+
+} // namespace rigel::assets
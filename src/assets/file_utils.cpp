@@ -67,14 +67,14 @@ void saveToFile(
 }
 
 
-std::string asText(const ByteBuffer& buffer)
+std::string asText(const ByteBufferView buffer)
 {
   const auto pBytesAsChars = reinterpret_cast<const char*>(buffer.data());
   return std::string(pBytesAsChars, pBytesAsChars + buffer.size());
 }
 
 
-LeStreamReader::LeStreamReader(const ByteBuffer& data)
+LeStreamReader::LeStreamReader(const ByteBufferView data)
   : LeStreamReader(data.begin(), data.end())
 {
 }
@@ -41,7 +41,7 @@ void saveToFile(
   const assets::ByteBuffer& buffer,
   const std::filesystem::path& filePath);
 
-std::string asText(const ByteBuffer& buffer);
+std::string asText(ByteBufferView buffer);
 
 
 /** Offers checked reading of little-endian data from a byte buffer
@@ -51,7 +51,7 @@ std::string asText(const ByteBuffer& buffer);
 class LeStreamReader
 {
 public:
-  explicit LeStreamReader(const ByteBuffer& data);
+  explicit LeStreamReader(ByteBufferView data);
   LeStreamReader(ByteBufferCIter begin, ByteBufferCIter end);
 
   std::uint8_t readU8();
@@ -0,0 +1,508 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "level_cache.hpp"
+
+#include "assets/mapped_file.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <type_traits>
+
+
+namespace rigel::assets
+{
+
+using data::map::LevelData;
+
+
+namespace
+{
+
+const auto LEVEL_CACHE_VERSION = std::uint32_t{1};
+const auto LEVEL_CACHE_MAGIC = std::uint32_t{0x4C564C52}; // 'RLVL'
+
+// Arrays are aligned to this many bytes within the file, so that their
+// contents can be used directly from a memory mapping if needed
+constexpr auto ARRAY_ALIGNMENT = std::size_t{8};
+
+
+std::size_t alignedOffset(const std::size_t offset)
+{
+  return (offset + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT;
+}
+
+
+class CacheWriter
+{
+public:
+  explicit CacheWriter(std::ostream& stream)
+    : mStream(stream)
+  {
+  }
+
+  template <typename T>
+  void write(const T& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    writeBytes(&value, sizeof(T));
+  }
+
+  template <typename T>
+  void writeArray(const std::vector<T>& values)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    write(std::uint32_t(values.size()));
+
+    const auto padding = alignedOffset(mOffset) - mOffset;
+    const char zeros[ARRAY_ALIGNMENT] = {};
+    writeBytes(zeros, padding);
+    writeBytes(values.data(), values.size() * sizeof(T));
+  }
+
+  void writeString(const std::string& string)
+  {
+    write(std::uint32_t(string.size()));
+    writeBytes(string.data(), string.size());
+  }
+
+private:
+  void writeBytes(const void* pData, const std::size_t size)
+  {
+    mStream.write(static_cast<const char*>(pData), size);
+    mOffset += size;
+  }
+
+  std::ostream& mStream;
+  std::size_t mOffset = 0;
+};
+
+
+/** Bounds-checked reading from a cache file
+ *
+ * All read functions return false once the end of the data has been
+ * reached, leaving the target untouched.
+ */
+class CacheReader
+{
+public:
+  explicit CacheReader(const ByteBufferView data)
+    : mData(data)
+  {
+  }
+
+  template <typename T>
+  bool read(T& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return readBytes(&value, sizeof(T));
+  }
+
+  template <typename T>
+  bool readArray(std::vector<T>& values)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    std::uint32_t size = 0;
+    if (!read(size))
+    {
+      return false;
+    }
+
+    mOffset = alignedOffset(mOffset);
+    if (mOffset > mData.size() || (mData.size() - mOffset) / sizeof(T) < size)
+    {
+      return false;
+    }
+
+    values.resize(size);
+    return readBytes(values.data(), size * sizeof(T));
+  }
+
+  bool readString(std::string& string)
+  {
+    std::uint32_t size = 0;
+    if (!read(size) || !hasBytes(size))
+    {
+      return false;
+    }
+
+    string.assign(
+      reinterpret_cast<const char*>(mData.data() + mOffset), size);
+    mOffset += size;
+    return true;
+  }
+
+private:
+  bool hasBytes(const std::size_t size) const
+  {
+    return mOffset <= mData.size() && mData.size() - mOffset >= size;
+  }
+
+  bool readBytes(void* pTarget, const std::size_t size)
+  {
+    if (!hasBytes(size))
+    {
+      return false;
+    }
+
+    std::memcpy(pTarget, mData.data() + mOffset, size);
+    mOffset += size;
+    return true;
+  }
+
+  ByteBufferView mData;
+  std::size_t mOffset = 0;
+};
+
+
+void writeImage(CacheWriter& writer, const data::Image& image)
+{
+  writer.write(std::uint32_t(image.width()));
+  writer.write(std::uint32_t(image.height()));
+  writer.writeArray(image.pixelData());
+}
+
+
+std::optional<data::Image> readImage(CacheReader& reader)
+{
+  std::uint32_t width = 0;
+  std::uint32_t height = 0;
+  data::PixelBuffer pixels;
+  if (
+    !reader.read(width) || !reader.read(height) || !reader.readArray(pixels) ||
+    pixels.size() != std::size_t(width) * height)
+  {
+    return std::nullopt;
+  }
+
+  return data::Image{std::move(pixels), width, height};
+}
+
+
+void writeMap(CacheWriter& writer, const data::map::Map& map)
+{
+  writer.write(std::int32_t(map.width()));
+  writer.write(std::int32_t(map.height()));
+  writer.writeArray(map.attributeDict().bitPacks());
+
+  for (auto layer = 0; layer < 2; ++layer)
+  {
+    std::vector<data::map::TileIndex> tiles;
+    tiles.reserve(std::size_t(map.width()) * map.height());
+
+    for (auto y = 0; y < map.height(); ++y)
+    {
+      for (auto x = 0; x < map.width(); ++x)
+      {
+        tiles.push_back(map.tileAt(layer, x, y));
+      }
+    }
+
+    writer.writeArray(tiles);
+  }
+}
+
+
+std::optional<data::map::Map> readMap(CacheReader& reader)
+{
+  std::int32_t width = 0;
+  std::int32_t height = 0;
+  data::map::TileAttributeDict::AttributeArray attributes;
+  if (
+    !reader.read(width) || !reader.read(height) ||
+    !reader.readArray(attributes) || width <= 0 || height <= 0)
+  {
+    return std::nullopt;
+  }
+
+  const auto numTiles = std::size_t(width) * std::size_t(height);
+  const auto numAttributes = attributes.size();
+
+  data::map::Map map(
+    width, height, data::map::TileAttributeDict{std::move(attributes)});
+
+  std::vector<data::map::TileIndex> tiles;
+  for (auto layer = 0; layer < 2; ++layer)
+  {
+    if (!reader.readArray(tiles) || tiles.size() != numTiles)
+    {
+      return std::nullopt;
+    }
+
+    for (auto y = 0; y < height; ++y)
+    {
+      for (auto x = 0; x < width; ++x)
+      {
+        const auto index = tiles[x + y * std::size_t(width)];
+        if (index >= numAttributes)
+        {
+          return std::nullopt;
+        }
+
+        map.setTileAt(layer, x, y, index);
+      }
+    }
+  }
+
+  return map;
+}
+
+
+void writeActor(CacheWriter& writer, const LevelData::Actor& actor)
+{
+  writer.write(std::int32_t(actor.mPosition.x));
+  writer.write(std::int32_t(actor.mPosition.y));
+  writer.write(std::int32_t(actor.mID));
+  writer.write(std::uint8_t(actor.mAssignedArea.has_value()));
+
+  if (actor.mAssignedArea)
+  {
+    const auto& area = *actor.mAssignedArea;
+    writer.write(std::int32_t(area.topLeft.x));
+    writer.write(std::int32_t(area.topLeft.y));
+    writer.write(std::int32_t(area.size.width));
+    writer.write(std::int32_t(area.size.height));
+  }
+}
+
+
+std::optional<LevelData::Actor> readActor(CacheReader& reader)
+{
+  std::int32_t x = 0;
+  std::int32_t y = 0;
+  std::int32_t id = 0;
+  std::uint8_t hasArea = 0;
+  if (
+    !reader.read(x) || !reader.read(y) || !reader.read(id) ||
+    !reader.read(hasArea))
+  {
+    return std::nullopt;
+  }
+
+  LevelData::Actor actor{{x, y}, static_cast<data::ActorID>(id), std::nullopt};
+
+  if (hasArea)
+  {
+    std::int32_t left = 0;
+    std::int32_t top = 0;
+    std::int32_t width = 0;
+    std::int32_t height = 0;
+    if (
+      !reader.read(left) || !reader.read(top) || !reader.read(width) ||
+      !reader.read(height))
+    {
+      return std::nullopt;
+    }
+
+    actor.mAssignedArea = base::Rect<int>{{left, top}, {width, height}};
+  }
+
+  return actor;
+}
+
+
+std::optional<LevelData> readLevel(CacheReader& reader)
+{
+  auto oTileSetImage = readImage(reader);
+  auto oBackdropImage = readImage(reader);
+
+  std::uint8_t hasSecondaryBackdrop = 0;
+  if (!oTileSetImage || !oBackdropImage || !reader.read(hasSecondaryBackdrop))
+  {
+    return std::nullopt;
+  }
+
+  std::optional<data::Image> oSecondaryBackdropImage;
+  if (hasSecondaryBackdrop)
+  {
+    oSecondaryBackdropImage = readImage(reader);
+    if (!oSecondaryBackdropImage)
+    {
+      return std::nullopt;
+    }
+  }
+
+  auto oMap = readMap(reader);
+
+  std::uint32_t numActors = 0;
+  if (!oMap || !reader.read(numActors))
+  {
+    return std::nullopt;
+  }
+
+  std::vector<LevelData::Actor> actors;
+  for (auto i = std::uint32_t{0}; i < numActors; ++i)
+  {
+    auto oActor = readActor(reader);
+    if (!oActor)
+    {
+      return std::nullopt;
+    }
+
+    actors.push_back(std::move(*oActor));
+  }
+
+  std::int32_t spawnX = 0;
+  std::int32_t spawnY = 0;
+  std::uint8_t playerFacingLeft = 0;
+  std::uint8_t scrollMode = 0;
+  std::uint8_t switchCondition = 0;
+  std::uint8_t earthquake = 0;
+  std::string musicFile;
+  if (
+    !reader.read(spawnX) || !reader.read(spawnY) ||
+    !reader.read(playerFacingLeft) || !reader.read(scrollMode) ||
+    !reader.read(switchCondition) || !reader.read(earthquake) ||
+    !reader.readString(musicFile))
+  {
+    return std::nullopt;
+  }
+
+  return LevelData{
+    std::move(*oTileSetImage),
+    std::move(*oBackdropImage),
+    std::move(oSecondaryBackdropImage),
+    std::move(*oMap),
+    std::move(actors),
+    base::Vec2{spawnX, spawnY},
+    playerFacingLeft != 0,
+    static_cast<data::map::BackdropScrollMode>(scrollMode),
+    static_cast<data::map::BackdropSwitchCondition>(switchCondition),
+    earthquake != 0,
+    std::move(musicFile)};
+}
+
+} // namespace
+
+
+std::filesystem::path levelCacheFile(
+  const std::filesystem::path& cacheDirectory,
+  const std::string_view mapName,
+  const data::Difficulty difficulty)
+{
+  // One file per level and difficulty. Whenever the key changes, the file
+  // is simply overwritten, so stale data doesn't accumulate.
+  std::stringstream fileName;
+  fileName << "level_" << std::filesystem::u8path(mapName).stem().u8string()
+           << '_' << static_cast<int>(difficulty) << ".bin";
+  return cacheDirectory / fileName.str();
+}
+
+
+std::optional<LevelData> loadCachedLevel(
+  const std::filesystem::path& path,
+  const std::uint64_t key)
+{
+  std::error_code ec;
+  if (!std::filesystem::exists(path, ec))
+  {
+    return std::nullopt;
+  }
+
+  try
+  {
+    const auto file = MappedFile{path};
+    CacheReader reader{file.data()};
+
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint64_t storedKey = 0;
+    if (
+      !reader.read(magic) || !reader.read(version) ||
+      !reader.read(storedKey) || magic != LEVEL_CACHE_MAGIC ||
+      version != LEVEL_CACHE_VERSION || storedKey != key)
+    {
+      return std::nullopt;
+    }
+
+    return readLevel(reader);
+  }
+  catch (const std::exception&)
+  {
+    return std::nullopt;
+  }
+}
+
+
+void saveLevelToCache(
+  const std::filesystem::path& path,
+  const std::uint64_t key,
+  const LevelData& level)
+{
+  std::error_code ec;
+  std::filesystem::create_directories(path.parent_path(), ec);
+
+  // Write to a temporary file first, so that an interrupted write can't leave
+  // a truncated cache file behind
+  auto tempPath = path;
+  tempPath += ".tmp";
+
+  {
+    std::ofstream file(tempPath, std::ios::binary);
+    if (!file.is_open())
+    {
+      return;
+    }
+
+    CacheWriter writer{file};
+
+    writer.write(LEVEL_CACHE_MAGIC);
+    writer.write(LEVEL_CACHE_VERSION);
+    writer.write(key);
+
+    writeImage(writer, level.mTileSetImage);
+    writeImage(writer, level.mBackdropImage);
+    writer.write(std::uint8_t(level.mSecondaryBackdropImage.has_value()));
+    if (level.mSecondaryBackdropImage)
+    {
+      writeImage(writer, *level.mSecondaryBackdropImage);
+    }
+
+    writeMap(writer, level.mMap);
+
+    writer.write(std::uint32_t(level.mActors.size()));
+    for (const auto& actor : level.mActors)
+    {
+      writeActor(writer, actor);
+    }
+
+    writer.write(std::int32_t(level.mPlayerSpawnPosition.x));
+    writer.write(std::int32_t(level.mPlayerSpawnPosition.y));
+    writer.write(std::uint8_t(level.mPlayerFacingLeft));
+    writer.write(std::uint8_t(level.mBackdropScrollMode));
+    writer.write(std::uint8_t(level.mBackdropSwitchCondition));
+    writer.write(std::uint8_t(level.mEarthquake));
+    writer.writeString(level.mMusicFile);
+
+    if (!file)
+    {
+      file.close();
+      std::filesystem::remove(tempPath, ec);
+      return;
+    }
+  }
+
+  std::filesystem::rename(tempPath, path, ec);
+  if (ec)
+  {
+    std::filesystem::remove(tempPath, ec);
+  }
+}
+
+} // namespace rigel::assets
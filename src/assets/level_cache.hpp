@@ -0,0 +1,61 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "data/game_session_data.hpp"
+#include "data/map.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+
+namespace rigel::assets
+{
+
+/** On-disk cache for fully decoded levels
+ *
+ * Decoding a level from the original game files involves parsing the level
+ * file, decoding the planar EGA tileset and backdrop images and
+ * pre-processing the actor list. The cache stores the end result, i.e. RGBA
+ * images, the map's tile layers and the final actor list, so that loading a
+ * previously decoded level only requires copying data out of a memory-mapped
+ * file.
+ *
+ * Each cache file stores a key alongside the data. The key is expected to
+ * cover everything that went into producing the level data (see
+ * ResourceLoader::contentHash()), a cache file with a different key is
+ * treated as stale. Values are stored in native byte order, so cache files
+ * are not portable across machines.
+ */
+std::filesystem::path levelCacheFile(
+  const std::filesystem::path& cacheDirectory,
+  std::string_view mapName,
+  data::Difficulty difficulty);
+
+
+/** Returns nothing if the file doesn't exist, is stale, or is corrupt */
+std::optional<data::map::LevelData>
+  loadCachedLevel(const std::filesystem::path& path, std::uint64_t key);
+
+void saveLevelToCache(
+  const std::filesystem::path& path,
+  std::uint64_t key,
+  const data::map::LevelData& level);
+
+} // namespace rigel::assets
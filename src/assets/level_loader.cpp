@@ -18,9 +18,11 @@
 
 #include "assets/bitwise_iter.hpp"
 #include "assets/file_utils.hpp"
+#include "assets/level_cache.hpp"
 #include "assets/resource_loader.hpp"
 #include "assets/rle_compression.hpp"
 #include "base/container_utils.hpp"
+#include "base/fnv_hash.hpp"
 #include "base/grid.hpp"
 #include "base/math_utils.hpp"
 #include "base/string_utils.hpp"
@@ -522,18 +524,42 @@ void sortByDrawIndex(ActorList& actors, const ResourceLoader& resources)
     });
 }
 
-} // namespace
-
-
-LevelData loadLevel(
+std::uint64_t levelCacheKey(
   std::string_view mapName,
+  LevelHeader& header,
   const ResourceLoader& resources,
   const Difficulty chosenDifficulty)
 {
-  const auto levelData = resources.file(mapName);
-  LeStreamReader levelReader(levelData);
+  // Bump this whenever a change to the level loading code affects the
+  // resulting LevelData
+  const auto LEVEL_LOADER_VERSION = std::uint32_t{1};
 
-  LevelHeader header(levelReader);
+  base::Fnv1aHasher hasher;
+  hasher.addValue(LEVEL_LOADER_VERSION);
+  hasher.addValue(chosenDifficulty);
+
+  hasher.addValue(resources.contentHash(mapName));
+  hasher.addValue(resources.contentHash(header.CZone));
+  hasher.addValue(resources.contentHash(header.backdrop));
+  if (header.flagBitSet(0x40) || header.flagBitSet(0x80))
+  {
+    hasher.addValue(resources.contentHash(
+      backdropNameFromNumber(header.alternativeBackdropNumber)));
+  }
+
+  // Actor draw indices determine the order of the actor list
+  hasher.addValue(resources.contentHash(ActorImagePackage::ACTOR_INFO_FILE));
+
+  return hasher.value();
+}
+
+
+LevelData decodeLevel(
+  LeStreamReader& levelReader,
+  LevelHeader& header,
+  const ResourceLoader& resources,
+  const Difficulty chosenDifficulty)
+{
   ActorList actors;
   for (size_t i = 0; i < header.numActorWords / 3u; ++i)
   {
@@ -546,6 +572,16 @@ LevelData loadLevel(
     }
   }
 
+  // Backdrops are decoded on worker threads while we process the rest of
+  // the level data
+  auto backdropImage = resources.loadBackdropAsync(header.backdrop);
+  std::optional<std::future<data::Image>> alternativeBackdropImage;
+  if (header.flagBitSet(0x40) || header.flagBitSet(0x80))
+  {
+    alternativeBackdropImage = resources.loadBackdropAsync(
+      backdropNameFromNumber(header.alternativeBackdropNumber));
+  }
+
   auto tileSet = resources.loadCZone(header.CZone);
 
   const auto width = static_cast<int>(levelReader.readU16());
@@ -635,22 +671,16 @@ LevelData loadLevel(
     }
   }
 
-  auto backdropImage = resources.loadBackdrop(header.backdrop);
-  std::optional<data::Image> alternativeBackdropImage;
-  if (header.flagBitSet(0x40) || header.flagBitSet(0x80))
-  {
-    alternativeBackdropImage = resources.loadBackdrop(
-      backdropNameFromNumber(header.alternativeBackdropNumber));
-  }
-
   auto [actorDescriptions, playerSpawnPosition, playerFacingLeft] =
     preProcessActorDescriptions(map, actors, chosenDifficulty);
   sortByDrawIndex(actorDescriptions, resources);
 
   return LevelData{
     std::move(tileSet.mTiles),
-    std::move(backdropImage),
-    std::move(alternativeBackdropImage),
+    backdropImage.get(),
+    alternativeBackdropImage
+      ? std::make_optional(alternativeBackdropImage->get())
+      : std::nullopt,
     std::move(map),
     std::move(actorDescriptions),
     playerSpawnPosition,
@@ -661,5 +691,55 @@ LevelData loadLevel(
     header.music};
 }
 
+} // namespace
+
+
+LevelData loadLevel(
+  std::string_view mapName,
+  const ResourceLoader& resources,
+  const Difficulty chosenDifficulty)
+{
+  const auto levelData = resources.fileView(mapName);
+  LeStreamReader levelReader(levelData);
+
+  LevelHeader header(levelReader);
+
+  std::optional<std::filesystem::path> cacheFile;
+  std::uint64_t cacheKey = 0;
+
+  if (const auto& oCacheDirectory = resources.cacheDirectory())
+  {
+    cacheKey = levelCacheKey(mapName, header, resources, chosenDifficulty);
+    cacheFile = levelCacheFile(*oCacheDirectory, mapName, chosenDifficulty);
+
+    if (auto oCachedLevel = loadCachedLevel(*cacheFile, cacheKey))
+    {
+      return std::move(*oCachedLevel);
+    }
+  }
+
+  auto level = decodeLevel(levelReader, header, resources, chosenDifficulty);
+
+  if (cacheFile)
+  {
+    saveLevelToCache(*cacheFile, cacheKey, level);
+  }
+
+  return level;
+}
+
+
+std::future<LevelData> loadLevelAsync(
+  std::string mapName,
+  const ResourceLoader& resources,
+  const Difficulty chosenDifficulty)
+{
+  return std::async(
+    ASYNC_LOAD_POLICY,
+    [mapName = std::move(mapName), &resources, chosenDifficulty]() {
+      return loadLevel(mapName, resources, chosenDifficulty);
+    });
+}
+
 
 } // namespace rigel::assets
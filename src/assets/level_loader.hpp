@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <future>
 #include <string>
 #include <vector>
 
@@ -36,4 +37,14 @@ data::map::LevelData loadLevel(
   const ResourceLoader& resources,
   data::Difficulty chosenDifficulty);
 
+
+/** Like loadLevel(), but loads on a worker thread
+ *
+ * The ResourceLoader must outlive the returned future.
+ */
+std::future<data::map::LevelData> loadLevelAsync(
+  std::string mapName,
+  const ResourceLoader& resources,
+  data::Difficulty chosenDifficulty);
+
 } // namespace rigel::assets
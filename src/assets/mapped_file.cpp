@@ -0,0 +1,193 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mapped_file.hpp"
+
+#include "assets/file_utils.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #include <windows.h>
+#elif !defined(__vita__)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+
+namespace rigel::assets
+{
+
+namespace
+{
+
+[[noreturn]] void
+  throwMappingError(const std::filesystem::path& path, const char* reason)
+{
+  throw std::runtime_error(
+    std::string("Cannot map file ") + path.u8string() + ": " + reason);
+}
+
+
+ByteBufferView::size_type
+  checkedSize(const std::filesystem::path& path, const std::uint64_t size)
+{
+  if (size > std::numeric_limits<ByteBufferView::size_type>::max())
+  {
+    throwMappingError(path, "file too large");
+  }
+
+  return static_cast<ByteBufferView::size_type>(size);
+}
+
+} // namespace
+
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+  mFileHandle = CreateFileW(
+    path.c_str(),
+    GENERIC_READ,
+    FILE_SHARE_READ,
+    nullptr,
+    OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL,
+    nullptr);
+  if (mFileHandle == INVALID_HANDLE_VALUE)
+  {
+    throw std::runtime_error(
+      std::string("File can't be opened: ") + path.u8string());
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(mFileHandle, &fileSize))
+  {
+    CloseHandle(mFileHandle);
+    throwMappingError(path, "cannot determine size");
+  }
+
+  mSize = checkedSize(path, fileSize.QuadPart);
+  if (mSize == 0)
+  {
+    // Empty files can't be mapped
+    return;
+  }
+
+  mMappingHandle =
+    CreateFileMappingW(mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mMappingHandle)
+  {
+    CloseHandle(mFileHandle);
+    throwMappingError(path, "CreateFileMapping failed");
+  }
+
+  mpData = static_cast<const std::uint8_t*>(
+    MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+  if (!mpData)
+  {
+    CloseHandle(mMappingHandle);
+    CloseHandle(mFileHandle);
+    throwMappingError(path, "MapViewOfFile failed");
+  }
+}
+
+
+MappedFile::~MappedFile()
+{
+  if (mpData)
+  {
+    UnmapViewOfFile(mpData);
+  }
+
+  if (mMappingHandle)
+  {
+    CloseHandle(mMappingHandle);
+  }
+
+  CloseHandle(mFileHandle);
+}
+
+#elif defined(__vita__)
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+  : mLoadedData(loadFile(path))
+{
+  mpData = mLoadedData.data();
+  mSize = checkedSize(path, mLoadedData.size());
+}
+
+
+MappedFile::~MappedFile() = default;
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+  const auto fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+  {
+    throw std::runtime_error(
+      std::string("File can't be opened: ") + path.u8string());
+  }
+
+  struct stat fileInfo;
+  if (fstat(fd, &fileInfo) != 0)
+  {
+    close(fd);
+    throwMappingError(path, "cannot determine size");
+  }
+
+  mSize = checkedSize(path, fileInfo.st_size);
+  if (mSize == 0)
+  {
+    // Empty files can't be mapped
+    close(fd);
+    return;
+  }
+
+  const auto pMapping = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  // The mapping stays valid after closing the file descriptor
+  close(fd);
+
+  if (pMapping == MAP_FAILED)
+  {
+    throwMappingError(path, "mmap failed");
+  }
+
+  mpData = static_cast<const std::uint8_t*>(pMapping);
+}
+
+
+MappedFile::~MappedFile()
+{
+  if (mpData)
+  {
+    munmap(const_cast<std::uint8_t*>(mpData), mSize);
+  }
+}
+
+#endif
+
+} // namespace rigel::assets
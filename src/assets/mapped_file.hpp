@@ -0,0 +1,58 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "assets/byte_buffer.hpp"
+
+#include <filesystem>
+
+
+namespace rigel::assets
+{
+
+/** Read-only memory mapping of a file
+ *
+ * The file's contents are paged in by the OS on demand, instead of being
+ * read into memory up front. On platforms without support for memory
+ * mapping, the whole file is loaded into memory instead.
+ *
+ * Throws an exception if the file can't be opened or mapped.
+ */
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::filesystem::path& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ByteBufferView data() const { return {mpData, mSize}; }
+
+private:
+  const std::uint8_t* mpData = nullptr;
+  ByteBufferView::size_type mSize = 0;
+
+#if defined(_WIN32)
+  void* mFileHandle = nullptr;
+  void* mMappingHandle = nullptr;
+#elif defined(__vita__)
+  ByteBuffer mLoadedData;
+#endif
+};
+
+} // namespace rigel::assets
@@ -27,13 +27,13 @@ data::Palette16 load6bitPalette16(ByteBufferCIter begin, ByteBufferCIter end);
 data::Palette256 load6bitPalette256(ByteBufferCIter begin, ByteBufferCIter end);
 
 
-inline data::Palette16 load6bitPalette16(const ByteBuffer& buffer)
+inline data::Palette16 load6bitPalette16(const ByteBufferView buffer)
 {
   return load6bitPalette16(buffer.begin(), buffer.end());
 }
 
 
-inline data::Palette256 load6bitPalette256(const ByteBuffer& buffer)
+inline data::Palette256 load6bitPalette256(const ByteBufferView buffer)
 {
   return load6bitPalette256(buffer.begin(), buffer.end());
 }
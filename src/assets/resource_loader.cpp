@@ -23,6 +23,8 @@
 #include "assets/png_image.hpp"
 #include "assets/voc_decoder.hpp"
 #include "base/container_utils.hpp"
+#include "base/fnv_hash.hpp"
+#include "base/string_utils.hpp"
 #include "data/game_traits.hpp"
 #include "data/unit_conversions.hpp"
 
@@ -83,27 +85,118 @@ std::string replacementSpriteImageName(const int id, const int frame)
 }
 
 
-std::optional<data::Image> loadReplacementTilesetIfPresent(
-  const fs::path& resourcePath,
-  std::string_view name)
+/** Name of the PNG file which replaces the given backdrop or tileset
+ *
+ * See ASSET_REPLACEMENTS_PATH. Returns nothing for all other kinds of files.
+ */
+std::optional<std::string> replacementImageName(std::string_view name)
 {
   using namespace std::literals;
 
-  std::regex tilesetNameRegex{"^CZONE([0-9A-Z])\\.MNI$", std::regex::icase};
+  static const std::regex backdropNameRegex{
+    "^DROP([0-9]+)\\.MNI$", std::regex::icase};
+  static const std::regex tilesetNameRegex{
+    "^CZONE([0-9A-Z])\\.MNI$", std::regex::icase};
+
   std::match_results<std::string_view::const_iterator> matches;
 
   if (
-    !std::regex_match(name.begin(), name.end(), matches, tilesetNameRegex) ||
-    matches.size() != 2)
+    std::regex_match(name.begin(), name.end(), matches, backdropNameRegex) &&
+    matches.size() == 2)
   {
-    return {};
+    return "backdrop"s + matches[1].str() + ".png";
   }
 
-  const auto number = matches[1].str();
-  const auto replacementName = "tileset"s + number + ".png";
-  const auto replacementPath = resourcePath / replacementName;
+  if (
+    std::regex_match(name.begin(), name.end(), matches, tilesetNameRegex) &&
+    matches.size() == 2)
+  {
+    return "tileset"s + matches[1].str() + ".png";
+  }
 
-  return loadPng(replacementPath.u8string());
+  return std::nullopt;
+}
+
+
+/** Mod paths whose files might resolve differently after switching mods
+ *
+ * A mod's files take priority over those of all mods preceding it in the
+ * list. Besides mods which were added or removed, this also includes all
+ * mods whose position relative to the others changed.
+ */
+std::vector<fs::path> modPathsWithChangedPriority(
+  const std::vector<fs::path>& oldPaths,
+  const std::vector<fs::path>& newPaths)
+{
+  auto contains = [](const std::vector<fs::path>& paths, const fs::path& p) {
+    return std::find(paths.begin(), paths.end(), p) != paths.end();
+  };
+
+  std::vector<fs::path> commonInOldOrder;
+  std::vector<fs::path> commonInNewOrder;
+  std::vector<fs::path> result;
+
+  for (const auto& path : oldPaths)
+  {
+    if (contains(newPaths, path))
+    {
+      commonInOldOrder.push_back(path);
+    }
+    else
+    {
+      result.push_back(path);
+    }
+  }
+
+  for (const auto& path : newPaths)
+  {
+    if (contains(oldPaths, path))
+    {
+      commonInNewOrder.push_back(path);
+    }
+    else
+    {
+      result.push_back(path);
+    }
+  }
+
+  for (auto i = 0u; i < commonInOldOrder.size(); ++i)
+  {
+    if (commonInOldOrder[i] != commonInNewOrder[i])
+    {
+      result.push_back(commonInOldOrder[i]);
+    }
+  }
+
+  return result;
+}
+
+
+/** Update changes according to the name of a file provided by a mod */
+void addAffectedResources(ChangedResources& changes, std::string_view name)
+{
+  const auto lowercaseName = strings::toLowercase(name);
+  const auto startsWith = [&](std::string_view prefix) {
+    return strings::startsWith(lowercaseName, prefix);
+  };
+
+  if (
+    startsWith("sound") || startsWith("sb_") || startsWith("intro") ||
+    startsWith("audio"))
+  {
+    changes.mSounds = true;
+  }
+  else if (startsWith("actor") || startsWith("actrinfo"))
+  {
+    changes.mSprites = true;
+
+    // ACTORS.MNI also contains the menu font
+    changes.mFont |= lowercaseName == "actors.mni";
+  }
+  else if (startsWith("status"))
+  {
+    changes.mUiSpriteSheet = true;
+  }
 }
 
 
@@ -141,18 +234,75 @@ std::string digitizedSoundFilenameForId(const data::SoundId soundId)
 ResourceLoader::ResourceLoader(
   std::filesystem::path gamePath,
   bool enableTopLevelMods,
-  std::vector<fs::path> modPaths)
+  std::vector<fs::path> modPaths,
+  std::optional<fs::path> cacheDirectory)
   : mGamePath(std::move(gamePath))
   , mModPaths(std::move(modPaths))
   , mEnableTopLevelMods(enableTopLevelMods)
-  , mFilePackage(mGamePath / "NUKEM2.CMP")
-  , mActorImagePackage(
-      file(ActorImagePackage::IMAGE_DATA_FILE),
-      file(ActorImagePackage::ACTOR_INFO_FILE))
+  , mCacheDirectory(std::move(cacheDirectory))
+  , mpFilePackage(std::make_unique<CMPFilePackage>(mGamePath / "NUKEM2.CMP"))
+  , mpActorImagePackage(std::make_unique<ActorImagePackage>(
+      fileView(ActorImagePackage::IMAGE_DATA_FILE),
+      fileView(ActorImagePackage::ACTOR_INFO_FILE)))
 {
 }
 
 
+ChangedResources ResourceLoader::changeSources(
+  std::filesystem::path gamePath,
+  const bool enableTopLevelMods,
+  std::vector<fs::path> modPaths)
+{
+  const auto gamePathChanged = gamePath != mGamePath;
+
+  ChangedResources result;
+  if (gamePathChanged || enableTopLevelMods != mEnableTopLevelMods)
+  {
+    // Top-level mods live directly in the game directory, so there's no
+    // easy way to tell which files they provide. Consider everything
+    // affected.
+    result = {true, true, true, true};
+  }
+  else
+  {
+    for (const auto& path : modPathsWithChangedPriority(mModPaths, modPaths))
+    {
+      std::error_code ec;
+      for (const fs::directory_entry& entry : fs::directory_iterator(path, ec))
+      {
+        addAffectedResources(result, entry.path().filename().u8string());
+      }
+    }
+  }
+
+  // Make sure that we can open the new package before changing anything
+  auto pFilePackage = gamePathChanged
+    ? std::make_unique<CMPFilePackage>(gamePath / "NUKEM2.CMP")
+    : nullptr;
+
+  mGamePath = std::move(gamePath);
+  mEnableTopLevelMods = enableTopLevelMods;
+  mModPaths = std::move(modPaths);
+
+  if (pFilePackage)
+  {
+    // The actor image package might reference data in the old package, so
+    // it needs to go first
+    mpActorImagePackage.reset();
+    mpFilePackage = std::move(pFilePackage);
+  }
+
+  if (gamePathChanged || result.mSprites || result.mFont)
+  {
+    mpActorImagePackage = std::make_unique<ActorImagePackage>(
+      fileView(ActorImagePackage::IMAGE_DATA_FILE),
+      fileView(ActorImagePackage::ACTOR_INFO_FILE));
+  }
+
+  return result;
+}
+
+
 template <typename TryLoadFunc, typename T>
 std::optional<T> ResourceLoader::tryLoadReplacement(TryLoadFunc&& tryLoad) const
 {
@@ -231,7 +381,7 @@ data::Image ResourceLoader::loadTiledFullscreenImage(
   const data::Palette16& overridePalette) const
 {
   return loadTiledImage(
-    file(name),
+    fileView(name),
     data::GameTraits::viewportWidthTiles,
     overridePalette,
     data::TileImageType::Unmasked);
@@ -241,7 +391,7 @@ data::Image ResourceLoader::loadTiledFullscreenImage(
 data::Image
   ResourceLoader::loadStandaloneFullscreenImage(std::string_view name) const
 {
-  const auto& data = file(name);
+  const auto data = fileView(name);
   const auto paletteStart = data.begin() + FULL_SCREEN_IMAGE_DATA_SIZE;
   const auto palette = load6bitPalette16(paletteStart, data.end());
 
@@ -263,7 +413,7 @@ data::Image ResourceLoader::loadAntiPiracyImage() const
   // then defines the pixel data in linear format.
   //
   // See http://www.shikadi.net/moddingwiki/Duke_Nukem_II_Full-screen_Images
-  const auto& data = file(ANTI_PIRACY_SCREEN_FILENAME);
+  const auto data = fileView(ANTI_PIRACY_SCREEN_FILENAME);
   const auto iImageStart = begin(data) + 256 * 3;
   const auto palette = load6bitPalette256(begin(data), iImageStart);
 
@@ -294,7 +444,7 @@ data::Image ResourceLoader::loadUltrawideHudFrameImage() const
 data::Palette16 ResourceLoader::loadPaletteFromFullScreenImage(
   std::string_view imageName) const
 {
-  const auto& data = file(imageName);
+  const auto data = fileView(imageName);
   const auto paletteStart = data.begin() + FULL_SCREEN_IMAGE_DATA_SIZE;
   return load6bitPalette16(paletteStart, data.end());
 }
@@ -304,7 +454,7 @@ ActorData ResourceLoader::loadActor(
   data::ActorID id,
   const data::Palette16& palette) const
 {
-  const auto& actorInfo = mActorImagePackage.loadActorInfo(id);
+  const auto& actorInfo = mpActorImagePackage->loadActorInfo(id);
 
   auto images = utils::transformed(
     actorInfo.mFrames, [&, frame = 0](const auto& frameHeader) mutable {
@@ -317,7 +467,7 @@ ActorData ResourceLoader::loadActor(
         frameHeader.mDrawOffset,
         frameHeader.mSizeInTiles,
         oReplacement ? *oReplacement
-                     : mActorImagePackage.loadImage(frameHeader, palette)};
+                     : mpActorImagePackage->loadImage(frameHeader, palette)};
     });
 
   return ActorData{actorInfo.mDrawIndex, std::move(images)};
@@ -326,19 +476,9 @@ ActorData ResourceLoader::loadActor(
 
 data::Image ResourceLoader::loadBackdrop(std::string_view name) const
 {
-  using namespace std::literals;
-
-  std::regex backdropNameRegex{"^DROP([0-9]+)\\.MNI$", std::regex::icase};
-  std::match_results<std::string_view::const_iterator> matches;
-
-  if (
-    std::regex_match(name.begin(), name.end(), matches, backdropNameRegex) &&
-    matches.size() == 2)
+  if (const auto oReplacementName = replacementImageName(name))
   {
-    const auto number = matches[1].str();
-    const auto replacementName = "backdrop"s + number + ".png";
-
-    if (const auto oReplacement = tryLoadPngReplacement(replacementName))
+    if (const auto oReplacement = tryLoadPngReplacement(*oReplacementName))
     {
       return *oReplacement;
     }
@@ -348,13 +488,32 @@ data::Image ResourceLoader::loadBackdrop(std::string_view name) const
 }
 
 
+std::future<data::Image>
+  ResourceLoader::loadBackdropAsync(std::string name) const
+{
+  return std::async(ASYNC_LOAD_POLICY, [this, name = std::move(name)]() {
+    return loadBackdrop(name);
+  });
+}
+
+
+std::future<std::vector<ActorData>>
+  ResourceLoader::loadActorsAsync(std::vector<data::ActorID> ids) const
+{
+  return std::async(ASYNC_LOAD_POLICY, [this, ids = std::move(ids)]() {
+    return utils::transformed(
+      ids, [this](const data::ActorID id) { return loadActor(id); });
+  });
+}
+
+
 TileSet ResourceLoader::loadCZone(std::string_view name) const
 {
   using namespace data;
   using namespace map;
   using T = data::TileImageType;
 
-  const auto& data = file(name);
+  const auto data = fileView(name);
   LeStreamReader attributeReader(
     data.begin(), data.begin() + GameTraits::CZone::attributeBytesTotal);
 
@@ -370,10 +529,10 @@ TileSet ResourceLoader::loadCZone(std::string_view name) const
     }
   }
 
-  const auto oReplacementImage =
-    tryLoadReplacement([name](const fs::path& path) {
-      return loadReplacementTilesetIfPresent(path, name);
-    });
+  const auto oReplacementName = replacementImageName(name);
+  const auto oReplacementImage = oReplacementName
+    ? tryLoadPngReplacement(*oReplacementName)
+    : std::nullopt;
 
   if (oReplacementImage)
   {
@@ -389,23 +548,27 @@ TileSet ResourceLoader::loadCZone(std::string_view name) const
   const auto maskedTilesBegin = tilesBegin +
     GameTraits::CZone::numSolidTiles * GameTraits::CZone::tileBytes;
 
+  // The two halves of the tileset are independent, so we decode the masked
+  // tiles on a worker thread while decoding the solid ones here.
+  auto maskedTilesImage = std::async(ASYNC_LOAD_POLICY, [&]() {
+    return loadTiledImage(
+      maskedTilesBegin,
+      data.end(),
+      GameTraits::CZone::tileSetImageWidth,
+      data::GameTraits::INGAME_PALETTE,
+      T::Masked);
+  });
   const auto solidTilesImage = loadTiledImage(
     tilesBegin,
     maskedTilesBegin,
     GameTraits::CZone::tileSetImageWidth,
     data::GameTraits::INGAME_PALETTE,
     T::Unmasked);
-  const auto maskedTilesImage = loadTiledImage(
-    maskedTilesBegin,
-    data.end(),
-    GameTraits::CZone::tileSetImageWidth,
-    data::GameTraits::INGAME_PALETTE,
-    T::Masked);
   fullImage.insertImage(0, 0, solidTilesImage);
   fullImage.insertImage(
     0,
     tilesToPixels(GameTraits::CZone::solidTilesImageHeight),
-    maskedTilesImage);
+    maskedTilesImage.get());
 
   return {std::move(fullImage), TileAttributeDict{std::move(attributes)}};
 }
@@ -430,7 +593,7 @@ data::Movie ResourceLoader::loadMovie(std::string_view name) const
 
 data::Song ResourceLoader::loadMusic(std::string_view name) const
 {
-  return assets::loadSong(file(name));
+  return assets::loadSong(fileView(name));
 }
 
 
@@ -495,7 +658,7 @@ std::vector<std::filesystem::path>
 
 base::AudioBuffer ResourceLoader::loadSound(std::string_view name) const
 {
-  return assets::decodeVoc(file(name));
+  return assets::decodeVoc(fileView(name));
 }
 
 
@@ -507,57 +670,100 @@ ScriptBundle ResourceLoader::loadScriptBundle(std::string_view fileName) const
 
 ByteBuffer ResourceLoader::file(std::string_view name) const
 {
-  // TODO: Eliminate duplication with tryLoadReplacement?
-  for (auto iPath = mModPaths.rbegin(); iPath != mModPaths.rend(); ++iPath)
+  if (const auto oPath = unpackedFilePath(name))
   {
-    const auto unpackedFilePath = *iPath / fs::u8path(name);
-    if (fs::exists(unpackedFilePath))
-    {
-      return loadFile(unpackedFilePath);
-    }
+    return loadFile(*oPath);
   }
 
-  if (mEnableTopLevelMods)
+  return mpFilePackage->file(name);
+}
+
+
+FileData ResourceLoader::fileView(std::string_view name) const
+{
+  if (const auto oPath = unpackedFilePath(name))
   {
-    const auto unpackedFilePath = mGamePath / fs::u8path(name);
-    if (fs::exists(unpackedFilePath))
-    {
-      return loadFile(unpackedFilePath);
-    }
+    return FileData{loadFile(*oPath)};
   }
 
-  return mFilePackage.file(name);
+  return FileData{mpFilePackage->fileView(name)};
 }
 
 
 std::string ResourceLoader::fileAsText(std::string_view name) const
 {
-  return asText(file(name));
+  return asText(fileView(name));
 }
 
 
 bool ResourceLoader::hasFile(std::string_view name) const
+{
+  return unpackedFilePath(name) || mpFilePackage->hasFile(name);
+}
+
+
+std::uint64_t ResourceLoader::contentHash(std::string_view name) const
+{
+  base::Fnv1aHasher hasher;
+
+  hasher.addValue(mEnableTopLevelMods);
+  for (const auto& path : mModPaths)
+  {
+    hasher.addString(path.u8string());
+  }
+
+  const auto data = fileView(name);
+  hasher.addValue(std::uint64_t(data.size()));
+  hasher.addBytes(data.data(), data.size());
+
+  if (const auto oReplacementName = replacementImageName(name))
+  {
+    auto tryLoadFile = [&](const fs::path& path) -> std::optional<ByteBuffer> {
+      const auto filePath = path / *oReplacementName;
+      if (!fs::exists(filePath))
+      {
+        return std::nullopt;
+      }
+
+      return loadFile(filePath);
+    };
+
+    const auto oReplacementFile = tryLoadReplacement(tryLoadFile);
+
+    if (oReplacementFile)
+    {
+      hasher.addValue(std::uint64_t(oReplacementFile->size()));
+      hasher.addBytes(oReplacementFile->data(), oReplacementFile->size());
+    }
+  }
+
+  return hasher.value();
+}
+
+
+std::optional<std::filesystem::path>
+  ResourceLoader::unpackedFilePath(std::string_view name) const
 {
   // TODO: Eliminate duplication with tryLoadReplacement?
   for (auto iPath = mModPaths.rbegin(); iPath != mModPaths.rend(); ++iPath)
   {
-    const auto unpackedFilePath = *iPath / fs::u8path(name);
-    if (fs::exists(unpackedFilePath))
+    auto path = *iPath / fs::u8path(name);
+    if (fs::exists(path))
     {
-      return true;
+      return path;
     }
   }
 
   if (mEnableTopLevelMods)
   {
-    const auto unpackedFilePath = mGamePath / fs::u8path(name);
-    if (fs::exists(unpackedFilePath))
+    auto path = mGamePath / fs::u8path(name);
+    if (fs::exists(path))
     {
-      return true;
+      return path;
     }
   }
 
-  return mFilePackage.hasFile(name);
+  return std::nullopt;
 }
 
 } // namespace rigel::assets
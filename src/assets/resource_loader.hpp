@@ -28,7 +28,11 @@
 #include "data/sound_ids.hpp"
 #include "data/tile_attributes.hpp"
 
+#include <cstdint>
 #include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -44,6 +48,19 @@ constexpr auto ULTRAWIDE_HUD_WIDTH = 560;
 constexpr auto ULTRAWIDE_HUD_HEIGHT = 70;
 constexpr auto ULTRAWIDE_HUD_INNER_WIDTH = 424;
 
+
+/** Launch policy for asynchronous asset loading
+ *
+ * Our Emscripten build doesn't enable threading support, so there, loading
+ * is deferred until the result is requested instead.
+ */
+#ifdef __EMSCRIPTEN__
+constexpr auto ASYNC_LOAD_POLICY = std::launch::deferred;
+#else
+constexpr auto ASYNC_LOAD_POLICY = std::launch::async;
+#endif
+
+
 struct TileSet
 {
   data::Image mTiles;
@@ -65,10 +82,42 @@ struct ActorData
 };
 
 
+/** Which kinds of preloaded resources are affected by a change of sources
+ *
+ * See ResourceLoader::changeSources(). Resources not listed here are loaded
+ * on demand, and will pick up any changes the next time they are loaded.
+ */
+struct ChangedResources
+{
+  bool mSounds = false;
+  bool mSprites = false;
+  bool mUiSpriteSheet = false;
+  bool mFont = false;
+
+  bool any() const { return mSounds || mSprites || mUiSpriteSheet || mFont; }
+};
+
+
 class ResourceLoader
 {
 public:
   ResourceLoader(
+    std::filesystem::path gamePath,
+    bool enableTopLevelMods,
+    std::vector<std::filesystem::path> modPaths,
+    std::optional<std::filesystem::path> cacheDirectory = std::nullopt);
+
+  /** Switch to a different game path and/or set of mods in place
+   *
+   * Returns which preloaded resources are affected by the switch. For a
+   * change of mods, this is determined by looking at the files provided by
+   * the mods which were added, removed, or changed priority. When the game
+   * path changes, everything is considered affected.
+   *
+   * Must not be called while any asynchronous loads are in progress. Views
+   * returned by fileView() become invalid if the game path changes.
+   */
+  ChangedResources changeSources(
     std::filesystem::path gamePath,
     bool enableTopLevelMods,
     std::vector<std::filesystem::path> modPaths);
@@ -84,11 +133,11 @@ public:
     data::ActorID id,
     const data::Palette16& palette = data::GameTraits::INGAME_PALETTE) const;
 
-  FontData loadFont() const { return mActorImagePackage.loadFont(); }
+  FontData loadFont() const { return mpActorImagePackage->loadFont(); }
 
   int drawIndexFor(data::ActorID id) const
   {
-    return mActorImagePackage.drawIndexFor(id);
+    return mpActorImagePackage->drawIndexFor(id);
   }
 
   data::Image loadAntiPiracyImage() const;
@@ -98,6 +147,17 @@ public:
 
   data::Image loadBackdrop(std::string_view name) const;
   TileSet loadCZone(std::string_view name) const;
+
+  /** Asynchronous variants of loadBackdrop() and loadActor()
+   *
+   * Decoding runs on a worker thread. Loading only reads from the
+   * ResourceLoader, so any number of loads can run concurrently. The
+   * ResourceLoader must outlive the returned futures.
+   */
+  std::future<data::Image> loadBackdropAsync(std::string name) const;
+  std::future<std::vector<ActorData>>
+    loadActorsAsync(std::vector<data::ActorID> ids) const;
+
   data::Movie loadMovie(std::string_view name) const;
 
   data::Song loadMusic(std::string_view name) const;
@@ -111,9 +171,34 @@ public:
   ScriptBundle loadScriptBundle(std::string_view fileName) const;
 
   ByteBuffer file(std::string_view name) const;
+
+  /** Like file(), but avoids copying data from the CMP package
+   *
+   * Files from the package are returned as a view into the memory-mapped
+   * package, which remains valid for the lifetime of the ResourceLoader.
+   * Only replacement files from mod directories need to be loaded into
+   * memory.
+   */
+  FileData fileView(std::string_view name) const;
+
   std::string fileAsText(std::string_view name) const;
   bool hasFile(std::string_view name) const;
 
+  /** Hash of everything that goes into decoding the given file
+   *
+   * Covers the file's contents as well as any PNG replacement image for it
+   * (in case of backdrops and tilesets), and the set of active mod paths.
+   * Meant to be used as a key for caching decoded assets - whenever the
+   * result changes, previously cached data must be considered stale.
+   */
+  std::uint64_t contentHash(std::string_view name) const;
+
+  /** Directory for caching decoded assets, if caching is enabled */
+  const std::optional<std::filesystem::path>& cacheDirectory() const
+  {
+    return mCacheDirectory;
+  }
+
 private:
   // The invoke_result of the TryLoadFunc is going to be a std::optional<T>,
   // hence we need to unpack the underlying T via the optional's value_type
@@ -124,6 +209,8 @@ private:
   std::optional<T> tryLoadReplacement(TryLoadFunc&& tryLoad) const;
   std::optional<data::Image>
     tryLoadPngReplacement(std::string_view filename) const;
+  std::optional<std::filesystem::path>
+    unpackedFilePath(std::string_view name) const;
 
   data::Image loadEmbeddedImageAsset(
     const char* replacementName,
@@ -138,9 +225,11 @@ private:
   std::filesystem::path mGamePath;
   std::vector<std::filesystem::path> mModPaths;
   bool mEnableTopLevelMods;
+  std::optional<std::filesystem::path> mCacheDirectory;
 
-  assets::CMPFilePackage mFilePackage;
-  assets::ActorImagePackage mActorImagePackage;
+  // Held by pointer so that they can be replaced by changeSources()
+  std::unique_ptr<assets::CMPFilePackage> mpFilePackage;
+  std::unique_ptr<assets::ActorImagePackage> mpActorImagePackage;
 };
 
 } // namespace rigel::assets
@@ -375,7 +375,7 @@ void decodeAudio(
 } // namespace
 
 
-base::AudioBuffer decodeVoc(const ByteBuffer& data)
+base::AudioBuffer decodeVoc(const ByteBufferView data)
 {
   LeStreamReader reader(data);
   if (!readAndValidateVocHeader(reader))
@@ -16,9 +16,14 @@
 
 #include "software_imf_player.hpp"
 
+#include "base/match.hpp"
 #include "base/math_utils.hpp"
+#include "base/profiler.hpp"
 #include "data/game_traits.hpp"
 
+#include <algorithm>
+#include <chrono>
+
 
 namespace rigel::audio
 {
@@ -26,6 +31,20 @@ namespace rigel::audio
 namespace
 {
 
+constexpr auto COMMAND_QUEUE_CAPACITY = std::size_t{16};
+
+// How many samples the render thread keeps ready for the audio callback.
+// This must be larger than the number of samples requested by a single
+// invocation of the callback, otherwise we'll get buffer underruns.
+constexpr auto RENDER_AHEAD_SAMPLES = std::size_t{4096};
+
+// The emulator is run in blocks of this many samples, instead of having the
+// audio callback's buffer size determine how much is rendered at a time.
+constexpr auto RENDER_BLOCK_SIZE = std::size_t{512};
+
+constexpr auto RENDER_THREAD_INTERVAL = std::chrono::milliseconds{2};
+
+
 int imfDelayToSamples(const int delay, const int sampleRate)
 {
   const auto samplesPerImfTick =
@@ -36,30 +55,47 @@ int imfDelayToSamples(const int delay, const int sampleRate)
 } // namespace
 
 
-SoftwareImfPlayer::SoftwareImfPlayer(const int sampleRate)
+SoftwareImfPlayer::SoftwareImfPlayer(
+  const int sampleRate,
+  const RenderMode renderMode)
   : mEmulator(sampleRate)
   , miNextCommand(mSongData.end())
+  , mRenderBlock(RENDER_BLOCK_SIZE)
   , mSampleRate(sampleRate)
-  , mSongSwitchPending(false)
-  , mTypeToUse(mEmulator.type())
+  , mRenderMode(renderMode)
+  , mCommands(COMMAND_QUEUE_CAPACITY)
+  , mRenderedSamples(RENDER_AHEAD_SAMPLES)
+  , mStopRequested(false)
 {
   mVolume.store(1.0f);
+
+  if (mRenderMode == RenderMode::Threaded)
+  {
+    renderAhead();
+    mRenderThread = std::thread{[this]() { runRenderThread(); }};
+  }
+}
+
+
+SoftwareImfPlayer::~SoftwareImfPlayer()
+{
+  if (mRenderThread.joinable())
+  {
+    mStopRequested = true;
+    mRenderThread.join();
+  }
 }
 
 
 void SoftwareImfPlayer::setType(const AdlibEmulator::Type type)
 {
-  mTypeToUse = type;
+  pushCommand(type);
 }
 
 
 void SoftwareImfPlayer::playSong(data::Song&& song)
 {
-  {
-    std::lock_guard<std::mutex> takeLock{mAudioLock};
-    mNextSongData = std::move(song);
-  }
-  mSongSwitchPending = true;
+  pushCommand(std::move(song));
 }
 
 
@@ -73,40 +109,117 @@ void SoftwareImfPlayer::render(
   std::int16_t* pBuffer,
   std::size_t samplesRequired)
 {
-  const auto emulatorType = mTypeToUse.load();
-  if (emulatorType != mEmulator.type())
+  if (mRenderMode == RenderMode::Synchronous)
   {
-    mEmulator = AdlibEmulator{mSampleRate, emulatorType};
+    processCommands();
+    renderSong(pBuffer, samplesRequired);
+  }
+  else
+  {
+    const auto samplesCopied = mRenderedSamples.pop(pBuffer, samplesRequired);
+
+    // Buffer underrun, output silence for the missing part instead of
+    // waiting for the render thread
+    std::fill(
+      pBuffer + samplesCopied, pBuffer + samplesRequired, std::int16_t{0});
+  }
+
+  if (const auto volume = mVolume.load(); volume < 1.0f)
+  {
+    std::transform(
+      pBuffer, pBuffer + samplesRequired, pBuffer, [volume](const auto sample) {
+        return std::int16_t(sample * volume);
+      });
+  }
+}
 
-    // Replay all previously played commands
-    for (auto iCommand = mSongData.begin(); iCommand != miNextCommand;
-         ++iCommand)
+
+void SoftwareImfPlayer::pushCommand(Command&& command)
+{
+  while (!mCommands.tryPush(std::move(command)))
+  {
+    if (mRenderMode == RenderMode::Synchronous)
+    {
+      // Without a render thread, there's nothing that would make space in
+      // the queue for us, so we need to do it ourselves.
+      processCommands();
+    }
+    else
     {
-      mEmulator.writeRegister(iCommand->reg, iCommand->value);
+      std::this_thread::yield();
     }
   }
+}
+
+
+void SoftwareImfPlayer::processCommands()
+{
+  Command command;
+  while (mCommands.tryPop(command))
+  {
+    base::match(
+      command,
+      [this](data::Song& song) {
+        mSongData = std::move(song);
+        miNextCommand = mSongData.begin();
+        mSamplesAvailable = 0;
+      },
+      [this](const AdlibEmulator::Type type) { switchEmulatorType(type); });
+  }
+}
 
-  if (mSongSwitchPending && mAudioLock.try_lock())
+
+void SoftwareImfPlayer::switchEmulatorType(const AdlibEmulator::Type type)
+{
+  if (type == mEmulator.type())
   {
-    mSongData = std::move(mNextSongData);
-    mSongSwitchPending = false;
-    mAudioLock.unlock();
+    return;
+  }
 
-    miNextCommand = mSongData.begin();
-    mSamplesAvailable = 0;
+  mEmulator = AdlibEmulator{mSampleRate, type};
+
+  // Replay all previously played commands
+  for (auto iCommand = mSongData.begin(); iCommand != miNextCommand; ++iCommand)
+  {
+    mEmulator.writeRegister(iCommand->reg, iCommand->value);
   }
+}
+
 
+void SoftwareImfPlayer::renderAhead()
+{
+  auto samplesToRender = mRenderedSamples.freeSpace();
+  if (samplesToRender == 0)
+  {
+    return;
+  }
+
+  // Only profiled here, not in render() - the audio callback mustn't lock
+  RIGEL_PROFILE_ZONE("Music rendering");
+
+  while (samplesToRender > 0)
+  {
+    const auto blockSize = std::min(samplesToRender, mRenderBlock.size());
+    renderSong(mRenderBlock.data(), blockSize);
+    mRenderedSamples.push(mRenderBlock.data(), blockSize);
+    samplesToRender -= blockSize;
+  }
+}
+
+
+void SoftwareImfPlayer::renderSong(
+  std::int16_t* pBuffer,
+  std::size_t samplesRequired)
+{
   if (mSongData.empty())
   {
     std::fill(pBuffer, pBuffer + samplesRequired, int16_t{0});
     return;
   }
 
-  const auto volume = mVolume.load();
-
   while (samplesRequired > mSamplesAvailable)
   {
-    mEmulator.render(mSamplesAvailable, pBuffer, volume);
+    mEmulator.render(mSamplesAvailable, pBuffer, 1.0f);
     pBuffer += mSamplesAvailable;
     samplesRequired -= mSamplesAvailable;
 
@@ -126,9 +239,19 @@ void SoftwareImfPlayer::render(
     mSamplesAvailable = imfDelayToSamples(commandDelay, mSampleRate);
   }
 
-  mEmulator.render(samplesRequired, pBuffer, volume);
+  mEmulator.render(samplesRequired, pBuffer, 1.0f);
   mSamplesAvailable -= samplesRequired;
 }
 
 
+void SoftwareImfPlayer::runRenderThread()
+{
+  while (!mStopRequested)
+  {
+    processCommands();
+    renderAhead();
+    std::this_thread::sleep_for(RENDER_THREAD_INTERVAL);
+  }
+}
+
 } // namespace rigel::audio
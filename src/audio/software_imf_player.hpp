@@ -17,19 +17,49 @@
 #pragma once
 
 #include "audio/adlib_emulator.hpp"
+#include "base/spsc_queue.hpp"
 #include "data/song.hpp"
 
 #include <atomic>
-#include <mutex>
+#include <thread>
+#include <variant>
+#include <vector>
 
 
 namespace rigel::audio
 {
 
+/** Plays IMF music using an AdLib emulator
+ *
+ * By default, the emulator runs on a separate thread, which renders ahead
+ * into a buffer of samples. render() is meant to be called from an audio
+ * callback, and only copies samples out of that buffer - it never locks,
+ * allocates memory, or runs the emulator. Song and emulator type changes are
+ * handed over to the rendering thread via a queue, and become audible once the
+ * samples which have already been rendered ahead have been played.
+ *
+ * In synchronous mode, no thread is started and render() runs the emulator
+ * directly. This is used on platforms without thread support.
+ */
 class SoftwareImfPlayer
 {
 public:
-  explicit SoftwareImfPlayer(int sampleRate);
+  enum class RenderMode
+  {
+    Threaded,
+    Synchronous
+  };
+
+#ifdef __EMSCRIPTEN__
+  static constexpr auto DEFAULT_RENDER_MODE = RenderMode::Synchronous;
+#else
+  static constexpr auto DEFAULT_RENDER_MODE = RenderMode::Threaded;
+#endif
+
+  explicit SoftwareImfPlayer(
+    int sampleRate,
+    RenderMode renderMode = DEFAULT_RENDER_MODE);
+  ~SoftwareImfPlayer();
   SoftwareImfPlayer(const SoftwareImfPlayer&) = delete;
   SoftwareImfPlayer& operator=(const SoftwareImfPlayer&) = delete;
 
@@ -41,18 +71,29 @@ public:
   void render(std::int16_t* pBuffer, std::size_t samplesRequired);
 
 private:
-  AdlibEmulator mEmulator;
-  std::mutex mAudioLock;
-  data::Song mNextSongData;
+  using Command = std::variant<data::Song, AdlibEmulator::Type>;
 
+  void pushCommand(Command&& command);
+  void processCommands();
+  void switchEmulatorType(AdlibEmulator::Type type);
+  void renderAhead();
+  void renderSong(std::int16_t* pBuffer, std::size_t samplesRequired);
+  void runRenderThread();
+
+  // Only accessed by the thread doing the rendering
+  AdlibEmulator mEmulator;
   data::Song mSongData;
   data::Song::const_iterator miNextCommand;
   std::size_t mSamplesAvailable = 0;
+  std::vector<std::int16_t> mRenderBlock;
   int mSampleRate;
+  RenderMode mRenderMode;
 
+  base::SpscQueue<Command> mCommands;
+  base::SpscQueue<std::int16_t> mRenderedSamples;
   std::atomic<float> mVolume;
-  std::atomic<bool> mSongSwitchPending;
-  std::atomic<AdlibEmulator::Type> mTypeToUse;
+  std::atomic<bool> mStopRequested;
+  std::thread mRenderThread;
 };
 
 } // namespace rigel::audio
@@ -20,7 +20,9 @@
 #include "assets/resource_loader.hpp"
 #include "audio/adlib_emulator.hpp"
 #include "audio/software_imf_player.hpp"
+#include "base/fnv_hash.hpp"
 #include "base/math_utils.hpp"
+#include "base/profiler.hpp"
 #include "base/string_utils.hpp"
 #include "sdl_utils/error.hpp"
 
@@ -39,7 +41,12 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <fstream>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <thread>
 #include <utility>
 
 
@@ -76,6 +83,40 @@ const auto COMBINED_SOUNDS_ADLIB_PERCENTAGE = 0.30f;
 const auto DESIRED_SAMPLE_RATE = 44100;
 const auto BUFFER_SIZE = 2048;
 
+// Increment this whenever the way AdLib sounds are rendered or resampled
+// changes, to invalidate previously cached sounds
+const auto ADLIB_SOUND_CACHE_VERSION = std::uint32_t{1};
+const auto ADLIB_SOUND_CACHE_MAGIC = std::uint32_t{0x444E5352}; // 'RSND'
+
+
+/** Calls func(i) for each i in [0, count), spread across worker threads
+ *
+ * func must be safe to invoke concurrently for different indices.
+ */
+template <typename Func>
+void parallelFor(const int count, const Func& func)
+{
+  const auto numWorkers =
+    int(std::max(std::thread::hardware_concurrency(), 1u));
+
+  std::vector<std::future<void>> workers;
+  for (auto worker = 0; worker < std::min(numWorkers, count); ++worker)
+  {
+    workers.push_back(std::async(assets::ASYNC_LOAD_POLICY, [=, &func]() {
+      for (auto i = worker; i < count; i += numWorkers)
+      {
+        func(i);
+      }
+    }));
+  }
+
+  for (auto& worker : workers)
+  {
+    worker.get();
+  }
+}
+
+
 base::AudioBuffer
   resampleAudio(const base::AudioBuffer& buffer, const int newSampleRate)
 {
@@ -246,22 +287,203 @@ base::AudioBuffer renderAdlibSound(
 }
 
 
+// Renders all AdLib sounds and prepares them for the given sample rate
+std::vector<base::AudioBuffer> renderAdlibSounds(
+  const assets::AudioPackage& soundPackage,
+  const AdlibEmulator::Type emulatorType,
+  const int sampleRate)
+{
+  // Note that the emulators' global lookup tables have already been
+  // initialized at this point, since the music player creates an emulator
+  // instance on construction. Emulator instances are otherwise independent,
+  // so rendering on multiple threads is safe.
+  std::vector<base::AudioBuffer> sounds(soundPackage.size());
+  parallelFor(int(soundPackage.size()), [&](const int index) {
+    auto rendered = renderAdlibSound(soundPackage[index], emulatorType);
+    if (!rendered.mSamples.empty())
+    {
+      sounds[index] = prepareBuffer(rendered, sampleRate);
+    }
+  });
+
+  return sounds;
+}
+
+
+std::uint64_t adlibSoundCacheKey(
+  const assets::ByteBufferView audioDictData,
+  const assets::ByteBufferView audioData,
+  const AdlibEmulator::Type emulatorType,
+  const int sampleRate)
+{
+  base::Fnv1aHasher hasher;
+  hasher.addBytes(audioDictData.data(), audioDictData.size());
+  hasher.addBytes(audioData.data(), audioData.size());
+  hasher.addValue(static_cast<std::uint64_t>(emulatorType));
+  hasher.addValue(static_cast<std::uint64_t>(sampleRate));
+  hasher.addValue(ADLIB_SOUND_CACHE_VERSION);
+
+  return hasher.value();
+}
+
+
+std::filesystem::path adlibSoundCacheFile(
+  const std::filesystem::path& cacheDirectory,
+  const std::uint64_t key)
+{
+  std::stringstream fileName;
+  fileName << "adlib_sounds_" << std::hex << std::setw(16)
+           << std::setfill('0') << key << ".bin";
+  return cacheDirectory / fileName.str();
+}
+
+
+template <typename T>
+void writeValue(std::ostream& stream, const T& value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+
+template <typename T>
+bool readValue(std::istream& stream, T& value)
+{
+  return bool(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+
+// The cache is only meant to be used on the machine that created it, so
+// values are written in native byte order.
+std::optional<std::vector<base::AudioBuffer>> loadCachedAdlibSounds(
+  const std::filesystem::path& path,
+  const std::uint64_t key)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open())
+  {
+    return std::nullopt;
+  }
+
+  std::uint32_t magic = 0;
+  std::uint32_t version = 0;
+  std::uint64_t storedKey = 0;
+  std::uint32_t numSounds = 0;
+  if (
+    !readValue(file, magic) || !readValue(file, version) ||
+    !readValue(file, storedKey) || !readValue(file, numSounds) ||
+    magic != ADLIB_SOUND_CACHE_MAGIC || version != ADLIB_SOUND_CACHE_VERSION ||
+    storedKey != key || numSounds != assets::NUM_ADLIB_SOUNDS)
+  {
+    return std::nullopt;
+  }
+
+  std::error_code ec;
+  const auto fileSize = std::filesystem::file_size(path, ec);
+  if (ec)
+  {
+    return std::nullopt;
+  }
+
+  std::vector<base::AudioBuffer> sounds(numSounds);
+  for (auto& sound : sounds)
+  {
+    std::uint32_t sampleRate = 0;
+    std::uint32_t numSamples = 0;
+    if (!readValue(file, sampleRate) || !readValue(file, numSamples))
+    {
+      return std::nullopt;
+    }
+
+    // Don't trust the sample count before allocating memory for it
+    const auto bytesLeft = fileSize - std::uint64_t(file.tellg());
+    if (std::uint64_t(numSamples) * sizeof(base::Sample) > bytesLeft)
+    {
+      return std::nullopt;
+    }
+
+    sound.mSampleRate = int(sampleRate);
+    sound.mSamples.resize(numSamples);
+    if (!file.read(
+          reinterpret_cast<char*>(sound.mSamples.data()),
+          numSamples * sizeof(base::Sample)))
+    {
+      return std::nullopt;
+    }
+  }
+
+  return sounds;
+}
+
+
+void saveAdlibSoundCache(
+  const std::filesystem::path& path,
+  const std::uint64_t key,
+  const std::vector<base::AudioBuffer>& sounds)
+{
+  std::error_code ec;
+  std::filesystem::create_directories(path.parent_path(), ec);
+
+  // Write to a temporary file first, so that an interrupted write can't leave
+  // a truncated cache file behind
+  auto tempPath = path;
+  tempPath += ".tmp";
+
+  {
+    std::ofstream file(tempPath, std::ios::binary);
+    if (!file.is_open())
+    {
+      LOG_F(
+        WARNING,
+        "Couldn't write sound cache file %s",
+        tempPath.u8string().c_str());
+      return;
+    }
+
+    writeValue(file, ADLIB_SOUND_CACHE_MAGIC);
+    writeValue(file, ADLIB_SOUND_CACHE_VERSION);
+    writeValue(file, key);
+    writeValue(file, std::uint32_t(sounds.size()));
+
+    for (const auto& sound : sounds)
+    {
+      writeValue(file, std::uint32_t(sound.mSampleRate));
+      writeValue(file, std::uint32_t(sound.mSamples.size()));
+      file.write(
+        reinterpret_cast<const char*>(sound.mSamples.data()),
+        sound.mSamples.size() * sizeof(base::Sample));
+    }
+
+    if (!file)
+    {
+      file.close();
+      std::filesystem::remove(tempPath, ec);
+      return;
+    }
+  }
+
+  std::filesystem::rename(tempPath, path, ec);
+  if (ec)
+  {
+    std::filesystem::remove(tempPath, ec);
+  }
+}
+
+
 base::AudioBuffer loadSoundForStyle(
   const data::SoundId id,
   const data::SoundStyle soundStyle,
   const int sampleRate,
   const assets::ResourceLoader& resources,
-  const assets::AudioPackage& soundPackage,
-  const AdlibEmulator::Type emulatorType)
+  const std::vector<base::AudioBuffer>& adlibSounds)
 {
   auto loadAdlibSound = [&](const data::SoundId soundId) {
     const auto idAsIndex = static_cast<int>(soundId);
-    if (idAsIndex < 0 || idAsIndex >= 34)
+    if (idAsIndex < 0 || idAsIndex >= int(adlibSounds.size()))
     {
       throw std::invalid_argument("Invalid sound ID");
     }
 
-    return renderAdlibSound(soundPackage[idAsIndex], emulatorType);
+    return adlibSounds[idAsIndex];
   };
 
   auto loadPreferredSound = [&](const data::SoundId soundId) {
@@ -271,7 +493,7 @@ base::AudioBuffer loadSoundForStyle(
       return loadAdlibSound(soundId);
     }
 
-    return buffer;
+    return prepareBuffer(buffer, sampleRate);
   };
 
 
@@ -280,30 +502,28 @@ base::AudioBuffer loadSoundForStyle(
     // The intro sounds don't have AdLib versions, so always load
     // the 'preferred' version (SoundBlaster) regardless of chosen
     // sound style.
-    return prepareBuffer(loadPreferredSound(id), sampleRate);
+    return loadPreferredSound(id);
   }
 
   switch (soundStyle)
   {
     case data::SoundStyle::AdLib:
-      return prepareBuffer(loadAdlibSound(id), sampleRate);
+      return loadAdlibSound(id);
 
     case data::SoundStyle::Combined:
       {
-        auto buffer = prepareBuffer(loadPreferredSound(id), sampleRate);
+        auto buffer = loadPreferredSound(id);
         if (resources.hasSoundBlasterSound(id))
         {
           overlaySound(
-            buffer,
-            prepareBuffer(loadAdlibSound(id), sampleRate),
-            COMBINED_SOUNDS_ADLIB_PERCENTAGE);
+            buffer, loadAdlibSound(id), COMBINED_SOUNDS_ADLIB_PERCENTAGE);
         }
 
         return buffer;
       }
 
     default:
-      return prepareBuffer(loadPreferredSound(id), sampleRate);
+      return loadPreferredSound(id);
   }
 }
 
@@ -383,7 +603,8 @@ SoundSystem::LoadedSound::LoadedSound(sdl_utils::Ptr<Mix_Chunk> pMixChunk)
 SoundSystem::SoundSystem(
   const assets::ResourceLoader* pResources,
   const data::SoundStyle soundStyle,
-  const data::AdlibPlaybackType adlibPlaybackType)
+  const data::AdlibPlaybackType adlibPlaybackType,
+  std::optional<std::filesystem::path> cacheDirectory)
   : mCloseMixerGuard(std::invoke([]() {
     LOG_F(INFO, "Opening audio device");
     sdl_mixer::check(Mix_OpenAudio(
@@ -395,6 +616,7 @@ SoundSystem::SoundSystem(
     return &Mix_CloseAudio;
   }))
   , mpResources(pResources)
+  , mCacheDirectory(std::move(cacheDirectory))
   , mCurrentSoundStyle(soundStyle)
   , mCurrentAdlibPlaybackType(adlibPlaybackType)
 {
@@ -555,6 +777,32 @@ void SoundSystem::setSoundVolume(const float volume)
 }
 
 
+void SoundSystem::reloadResources(const bool soundsChanged)
+{
+  stopMusic();
+  mReplacementSongFileCache.clear();
+
+  if (!soundsChanged)
+  {
+    return;
+  }
+
+  stopAllSounds();
+
+  int sampleRate = 0;
+  std::uint16_t audioFormat = 0;
+  int numChannels = 0;
+  Mix_QuerySpec(&sampleRate, &audioFormat, &numChannels);
+
+  // Replacement sound files might have been added or removed, so we can't
+  // reuse anything
+  mSounds = {};
+  loadAllSounds(sampleRate, audioFormat, numChannels, mCurrentSoundStyle);
+
+  applySoundVolume(mCurrentSoundVolume);
+}
+
+
 void SoundSystem::loadAllSounds(
   const int sampleRate,
   const std::uint16_t audioFormat,
@@ -565,9 +813,7 @@ void SoundSystem::loadAllSounds(
 
   LOG_F(INFO, "Loading sound effects");
 
-  const auto soundPackage = assets::loadAdlibSoundData(
-    mpResources->file(assets::AUDIO_DICT_FILE),
-    mpResources->file(assets::AUDIO_DATA_FILE));
+  std::vector<data::SoundId> soundsToRender;
 
   data::forEachSoundId([&](const auto id) {
     for (const auto& replacementPath : mpResources->replacementSoundPaths(id))
@@ -585,17 +831,11 @@ void SoundSystem::loadAllSounds(
       }
     }
 
-    const auto soundData = loadSoundForStyle(
-      id,
-      soundStyle,
-      sampleRate,
-      *mpResources,
-      soundPackage,
-      toEmulationType(mCurrentAdlibPlaybackType));
-
-    mSounds[idToIndex(id)] =
-      LoadedSound{convertBuffer(soundData, audioFormat, numChannels)};
+    soundsToRender.push_back(id);
   });
+
+  renderSounds(
+    soundsToRender, sampleRate, audioFormat, numChannels, soundStyle);
 }
 
 
@@ -612,9 +852,7 @@ void SoundSystem::reloadAllSounds()
 
   LOG_F(INFO, "Reloading sound effects");
 
-  const auto soundPackage = assets::loadAdlibSoundData(
-    mpResources->file(assets::AUDIO_DICT_FILE),
-    mpResources->file(assets::AUDIO_DATA_FILE));
+  std::vector<data::SoundId> soundsToRender;
 
   data::forEachSoundId([&](const auto id) {
     const auto index = idToIndex(id);
@@ -625,21 +863,85 @@ void SoundSystem::reloadAllSounds()
       return;
     }
 
-    const auto soundData = loadSoundForStyle(
-      id,
-      mCurrentSoundStyle,
-      sampleRate,
-      *mpResources,
-      soundPackage,
-      toEmulationType(mCurrentAdlibPlaybackType));
-    mSounds[index] =
-      LoadedSound{convertBuffer(soundData, audioFormat, numChannels)};
+    soundsToRender.push_back(id);
   });
 
+  renderSounds(
+    soundsToRender, sampleRate, audioFormat, numChannels, mCurrentSoundStyle);
+
   applySoundVolume(mCurrentSoundVolume);
 }
 
 
+void SoundSystem::renderSounds(
+  const std::vector<data::SoundId>& ids,
+  const int sampleRate,
+  const std::uint16_t audioFormat,
+  const int numChannels,
+  const data::SoundStyle soundStyle)
+{
+  const auto needsAdlibSounds = soundStyle != data::SoundStyle::SoundBlaster ||
+    std::any_of(ids.begin(), ids.end(), [this](const data::SoundId id) {
+      return !mpResources->hasSoundBlasterSound(id);
+    });
+
+  const auto adlibSounds = needsAdlibSounds
+    ? loadAdlibSounds(sampleRate)
+    : std::vector<base::AudioBuffer>{};
+
+  std::vector<base::AudioBuffer> renderedSounds(ids.size());
+  parallelFor(int(ids.size()), [&](const int i) {
+    renderedSounds[i] = loadSoundForStyle(
+      ids[i], soundStyle, sampleRate, *mpResources, adlibSounds);
+  });
+
+  // Creating Mix_Chunks needs to happen on the main thread
+  for (auto i = 0u; i < ids.size(); ++i)
+  {
+    mSounds[idToIndex(ids[i])] =
+      LoadedSound{convertBuffer(renderedSounds[i], audioFormat, numChannels)};
+  }
+}
+
+
+std::vector<base::AudioBuffer>
+  SoundSystem::loadAdlibSounds(const int sampleRate) const
+{
+  RIGEL_PROFILE_ZONE("Load AdLib sounds");
+
+  const auto audioDictData = mpResources->fileView(assets::AUDIO_DICT_FILE);
+  const auto audioData = mpResources->fileView(assets::AUDIO_DATA_FILE);
+  const auto emulatorType = toEmulationType(mCurrentAdlibPlaybackType);
+
+  std::optional<std::filesystem::path> cacheFile;
+  std::uint64_t cacheKey = 0;
+
+  if (mCacheDirectory)
+  {
+    cacheKey =
+      adlibSoundCacheKey(audioDictData, audioData, emulatorType, sampleRate);
+    cacheFile = adlibSoundCacheFile(*mCacheDirectory, cacheKey);
+
+    if (auto cachedSounds = loadCachedAdlibSounds(*cacheFile, cacheKey))
+    {
+      LOG_F(INFO, "Using cached AdLib sounds");
+      return std::move(*cachedSounds);
+    }
+  }
+
+  const auto soundPackage =
+    assets::loadAdlibSoundData(audioDictData, audioData);
+  auto sounds = renderAdlibSounds(soundPackage, emulatorType, sampleRate);
+
+  if (cacheFile)
+  {
+    saveAdlibSoundCache(*cacheFile, cacheKey, sounds);
+  }
+
+  return sounds;
+}
+
+
 void SoundSystem::applySoundVolume(const float volume)
 {
   const auto sdlVolume =
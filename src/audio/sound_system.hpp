@@ -24,9 +24,12 @@
 #include "sdl_utils/ptr.hpp"
 
 #include <array>
+#include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 
 namespace rigel::assets
@@ -48,6 +51,10 @@ using RawBuffer = std::vector<std::uint8_t>;
  * an audio device and loads all sound effects from the game's data files. From
  * that point on, sound effects and music playback can be triggered at any time
  * using the class' interface. Sound and music volume can also be adjusted.
+ *
+ * Rendering the AdLib versions of the sound effects takes a while, so if a
+ * cache directory is given, the results are stored there and reused on
+ * subsequent runs.
  */
 class SoundSystem
 {
@@ -55,7 +62,8 @@ public:
   explicit SoundSystem(
     const assets::ResourceLoader* pResources,
     data::SoundStyle soundStyle,
-    data::AdlibPlaybackType adlibPlaybackType);
+    data::AdlibPlaybackType adlibPlaybackType,
+    std::optional<std::filesystem::path> cacheDirectory = std::nullopt);
   ~SoundSystem();
 
   void setSoundStyle(data::SoundStyle soundStyle);
@@ -88,6 +96,15 @@ public:
   void setMusicVolume(float volume);
   void setSoundVolume(float volume);
 
+  /** Pick up changes after switching mods or game path
+   *
+   * Should be called after changing the sources of the ResourceLoader given
+   * on construction. Stops music playback and forgets about previously
+   * found replacement music files. If soundsChanged is true, all sound
+   * effects are reloaded as well. The audio device stays open.
+   */
+  void reloadResources(bool soundsChanged);
+
 private:
   void loadAllSounds(
     int sampleRate,
@@ -95,6 +112,13 @@ private:
     int numChannels,
     data::SoundStyle soundStyle);
   void reloadAllSounds();
+  void renderSounds(
+    const std::vector<data::SoundId>& ids,
+    int sampleRate,
+    std::uint16_t audioFormat,
+    int numChannels,
+    data::SoundStyle soundStyle);
+  std::vector<base::AudioBuffer> loadAdlibSounds(int sampleRate) const;
   void applySoundVolume(float volume);
   void hookMusic() const;
   void unhookMusic() const;
@@ -119,6 +143,7 @@ private:
   mutable std::unordered_map<std::string, std::string>
     mReplacementSongFileCache;
   const assets::ResourceLoader* mpResources;
+  std::optional<std::filesystem::path> mCacheDirectory;
   float mCurrentSoundVolume;
   data::SoundStyle mCurrentSoundStyle;
   data::AdlibPlaybackType mCurrentAdlibPlaybackType;
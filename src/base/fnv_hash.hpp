@@ -0,0 +1,69 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+
+namespace rigel::base
+{
+
+/** Incremental 64-bit FNV-1a hash
+ *
+ * Not suitable for anything security-related, but fast and good enough for
+ * detecting changes in input data, e.g. to validate caches.
+ */
+class Fnv1aHasher
+{
+public:
+  void addBytes(const std::uint8_t* pData, const std::size_t size)
+  {
+    for (auto i = std::size_t{0}; i < size; ++i)
+    {
+      mHash ^= pData[i];
+      mHash *= PRIME;
+    }
+  }
+
+  void addString(const std::string_view string)
+  {
+    // Hash the size as well, so that consecutive strings can't be confused
+    // with a single concatenated one
+    addValue(std::uint64_t(string.size()));
+    addBytes(
+      reinterpret_cast<const std::uint8_t*>(string.data()), string.size());
+  }
+
+  template <typename T>
+  void addValue(const T& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    addBytes(reinterpret_cast<const std::uint8_t*>(&value), sizeof(T));
+  }
+
+  std::uint64_t value() const { return mHash; }
+
+private:
+  static constexpr auto PRIME = std::uint64_t{0x100000001B3};
+
+  std::uint64_t mHash = 0xCBF29CE484222325;
+};
+
+} // namespace rigel::base
@@ -0,0 +1,100 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+namespace rigel::base
+{
+
+/** Allocates memory for objects of a single type in chunks
+ *
+ * Objects allocated one after another end up next to each other in memory,
+ * and freed slots are reused before growing the pool. This makes the pool
+ * suitable as the backing store for class-specific operator new/delete.
+ * Memory is only returned to the system when the pool itself is destroyed.
+ *
+ * Not thread-safe.
+ */
+template <typename T, std::size_t ObjectsPerChunk = 64>
+class ObjectPool
+{
+public:
+  ObjectPool() = default;
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+
+  void* allocate()
+  {
+    if (!mpFreeList)
+    {
+      addChunk();
+    }
+
+    auto pSlot = mpFreeList;
+    mpFreeList = pSlot->mpNext;
+    ++mNumAllocated;
+    return pSlot;
+  }
+
+  void deallocate(void* pMemory)
+  {
+    assert(mNumAllocated > 0);
+
+    auto pSlot = static_cast<Slot*>(pMemory);
+    pSlot->mpNext = mpFreeList;
+    mpFreeList = pSlot;
+    --mNumAllocated;
+  }
+
+  std::size_t numAllocated() const { return mNumAllocated; }
+  std::size_t capacity() const { return mChunks.size() * ObjectsPerChunk; }
+
+private:
+  union Slot
+  {
+    Slot* mpNext;
+    alignas(T) unsigned char mStorage[sizeof(T)];
+  };
+
+  void addChunk()
+  {
+    auto pChunk = std::make_unique<Slot[]>(ObjectsPerChunk);
+
+    // Link slots in ascending order, so that consecutive allocations are
+    // also consecutive in memory
+    for (auto i = std::size_t{0}; i < ObjectsPerChunk - 1; ++i)
+    {
+      pChunk[i].mpNext = &pChunk[i + 1];
+    }
+    pChunk[ObjectsPerChunk - 1].mpNext = mpFreeList;
+
+    mpFreeList = pChunk.get();
+    mChunks.push_back(std::move(pChunk));
+  }
+
+  std::vector<std::unique_ptr<Slot[]>> mChunks;
+  Slot* mpFreeList = nullptr;
+  std::size_t mNumAllocated = 0;
+};
+
+} // namespace rigel::base
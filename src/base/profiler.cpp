@@ -0,0 +1,272 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+
+
+namespace rigel::base::profiler
+{
+
+namespace
+{
+
+// Enough for several seconds worth of frames
+constexpr auto RING_BUFFER_CAPACITY = std::size_t{1} << 16;
+
+constexpr auto FRAMES_PER_BREAKDOWN = 30;
+
+
+struct ZoneRecord
+{
+  const char* mpName;
+  Clock::time_point mStartTime;
+  Clock::time_point mEndTime;
+  std::uint32_t mThreadIndex;
+  int mDepth;
+};
+
+
+struct AccumulatedZone
+{
+  const char* mpName;
+  Clock::time_point mFirstStartTime;
+  double mTotalMilliseconds;
+  int mDepth;
+};
+
+
+struct ProfilerState
+{
+  std::mutex mMutex;
+
+  std::vector<ZoneRecord> mRingBuffer;
+  std::size_t mNextRecord = 0;
+  bool mRingBufferFull = false;
+
+  std::vector<AccumulatedZone> mAccumulatedZones;
+  std::vector<ZoneTiming> mBreakdown;
+  int mFramesAccumulated = 0;
+
+  Clock::time_point mEpoch = Clock::now();
+};
+
+
+ProfilerState& profilerState()
+{
+  static ProfilerState state;
+  return state;
+}
+
+
+std::uint32_t currentThreadIndex()
+{
+  static std::atomic<std::uint32_t> nextThreadIndex{0};
+  thread_local const auto threadIndex = nextThreadIndex++;
+  return threadIndex;
+}
+
+
+thread_local int tCurrentDepth = 0;
+
+
+bool sameName(const char* pLhs, const char* pRhs)
+{
+  return pLhs == pRhs || std::strcmp(pLhs, pRhs) == 0;
+}
+
+
+void accumulate(ProfilerState& state, const ZoneRecord& record)
+{
+  using namespace std::chrono;
+
+  const auto milliseconds =
+    duration<double, std::milli>(record.mEndTime - record.mStartTime).count();
+
+  const auto iExisting = std::find_if(
+    state.mAccumulatedZones.begin(),
+    state.mAccumulatedZones.end(),
+    [&](const AccumulatedZone& zone) {
+      return sameName(zone.mpName, record.mpName);
+    });
+
+  if (iExisting != state.mAccumulatedZones.end())
+  {
+    iExisting->mTotalMilliseconds += milliseconds;
+    iExisting->mFirstStartTime =
+      std::min(iExisting->mFirstStartTime, record.mStartTime);
+    iExisting->mDepth = std::min(iExisting->mDepth, record.mDepth);
+  }
+  else
+  {
+    state.mAccumulatedZones.push_back(
+      {record.mpName, record.mStartTime, milliseconds, record.mDepth});
+  }
+}
+
+
+void recordZone(const ZoneRecord& record)
+{
+  auto& state = profilerState();
+  std::lock_guard<std::mutex> lock{state.mMutex};
+
+  if (state.mRingBuffer.empty())
+  {
+    state.mRingBuffer.resize(RING_BUFFER_CAPACITY);
+  }
+
+  state.mRingBuffer[state.mNextRecord] = record;
+  ++state.mNextRecord;
+  if (state.mNextRecord == state.mRingBuffer.size())
+  {
+    state.mNextRecord = 0;
+    state.mRingBufferFull = true;
+  }
+
+  accumulate(state, record);
+}
+
+} // namespace
+
+
+ScopedZone::ScopedZone(const char* name)
+  : mpName(name)
+  , mStartTime(Clock::now())
+  , mDepth(tCurrentDepth++)
+{
+}
+
+
+ScopedZone::~ScopedZone()
+{
+  --tCurrentDepth;
+  recordZone(
+    {mpName, mStartTime, Clock::now(), currentThreadIndex(), mDepth});
+}
+
+
+void beginFrame()
+{
+  auto& state = profilerState();
+  std::lock_guard<std::mutex> lock{state.mMutex};
+
+  ++state.mFramesAccumulated;
+  if (state.mFramesAccumulated < FRAMES_PER_BREAKDOWN)
+  {
+    return;
+  }
+
+  std::sort(
+    state.mAccumulatedZones.begin(),
+    state.mAccumulatedZones.end(),
+    [](const AccumulatedZone& lhs, const AccumulatedZone& rhs) {
+      return lhs.mFirstStartTime < rhs.mFirstStartTime;
+    });
+
+  state.mBreakdown.clear();
+  for (const auto& zone : state.mAccumulatedZones)
+  {
+    state.mBreakdown.push_back(
+      {zone.mpName,
+       zone.mTotalMilliseconds / state.mFramesAccumulated,
+       zone.mDepth});
+  }
+
+  state.mAccumulatedZones.clear();
+  state.mFramesAccumulated = 0;
+}
+
+
+const std::vector<ZoneTiming>& frameBreakdown()
+{
+  // Only modified by beginFrame(), which runs on the same thread as the
+  // caller, so we don't need to lock here.
+  return profilerState().mBreakdown;
+}
+
+
+bool writeChromeTrace(const std::filesystem::path& path)
+{
+  using namespace std::chrono;
+
+  auto& state = profilerState();
+
+  std::vector<ZoneRecord> records;
+  {
+    std::lock_guard<std::mutex> lock{state.mMutex};
+
+    // Oldest records first
+    if (state.mRingBufferFull)
+    {
+      records.insert(
+        records.end(),
+        state.mRingBuffer.begin() + state.mNextRecord,
+        state.mRingBuffer.end());
+    }
+
+    records.insert(
+      records.end(),
+      state.mRingBuffer.begin(),
+      state.mRingBuffer.begin() + state.mNextRecord);
+  }
+
+  std::ofstream file(path, std::ios::binary);
+  if (!file.is_open())
+  {
+    return false;
+  }
+
+  auto toMicroseconds = [](const Clock::duration time) {
+    return duration<double, std::micro>(time).count();
+  };
+
+  file << std::fixed << std::setprecision(3);
+  file << "{\"traceEvents\":[\n";
+
+  auto first = true;
+  for (const auto& record : records)
+  {
+    if (!first)
+    {
+      file << ",\n";
+    }
+    first = false;
+
+    // clang-format off
+    file
+      << "{\"name\":\"" << record.mpName << "\""
+      << ",\"ph\":\"X\""
+      << ",\"pid\":1"
+      << ",\"tid\":" << record.mThreadIndex
+      << ",\"ts\":" << toMicroseconds(record.mStartTime - state.mEpoch)
+      << ",\"dur\":" << toMicroseconds(record.mEndTime - record.mStartTime)
+      << "}";
+    // clang-format on
+  }
+
+  file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+  return file.good();
+}
+
+} // namespace rigel::base::profiler
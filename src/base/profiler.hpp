@@ -0,0 +1,117 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/clock.hpp"
+
+#include <filesystem>
+#include <vector>
+
+
+/* Lightweight instrumentation for finding out where a frame's time goes.
+ *
+ * Code is instrumented by placing RIGEL_PROFILE_ZONE("Name") at the start of
+ * a scope. The time spent in that scope is then recorded into a ring buffer,
+ * which can be written to disk in Chrome's trace event format (viewable in
+ * chrome://tracing or https://ui.perfetto.dev) via writeChromeTrace().
+ * Additionally, a per-zone breakdown averaged over the last couple of frames
+ * is available via frameBreakdown().
+ *
+ * Unless RIGEL_ENABLE_PROFILER is defined (ENABLE_PROFILER CMake option),
+ * the macros expand to nothing, so instrumentation has no cost in regular
+ * builds. Zone names must be string literals, or otherwise outlive the
+ * profiler - only the pointer is stored.
+ *
+ * Recording a zone takes a lock and may allocate memory, so zones must not be
+ * placed on realtime threads like the audio callback.
+ */
+namespace rigel::base::profiler
+{
+
+#ifdef RIGEL_ENABLE_PROFILER
+constexpr auto ENABLED = true;
+#else
+constexpr auto ENABLED = false;
+#endif
+
+
+struct ZoneTiming
+{
+  const char* mpName;
+  double mMilliseconds;
+  int mDepth;
+};
+
+
+/** Marks the start of a new frame. To be called once per frame by the
+ * main loop.
+ */
+void beginFrame();
+
+/** Average time spent per frame in each zone, updated every couple of frames
+ *
+ * Zones are listed in the order in which they were first entered. The depth
+ * indicates how deeply nested the zone is within other zones on the same
+ * thread.
+ */
+const std::vector<ZoneTiming>& frameBreakdown();
+
+/** Writes the contents of the ring buffer in Chrome trace event format
+ *
+ * Returns false if the file couldn't be written.
+ */
+bool writeChromeTrace(const std::filesystem::path& path);
+
+
+class ScopedZone
+{
+public:
+  explicit ScopedZone(const char* name);
+  ~ScopedZone();
+
+  ScopedZone(const ScopedZone&) = delete;
+  ScopedZone& operator=(const ScopedZone&) = delete;
+
+private:
+  const char* mpName;
+  base::Clock::time_point mStartTime;
+  int mDepth;
+};
+
+} // namespace rigel::base::profiler
+
+
+#ifdef RIGEL_ENABLE_PROFILER
+
+  #define RIGEL_PROFILE_CONCAT_IMPL(a, b) a##b
+  #define RIGEL_PROFILE_CONCAT(a, b) RIGEL_PROFILE_CONCAT_IMPL(a, b)
+
+  #define RIGEL_PROFILE_ZONE(name)                                             \
+    const ::rigel::base::profiler::ScopedZone RIGEL_PROFILE_CONCAT(            \
+      profilerZone, __LINE__)                                                  \
+    {                                                                          \
+      name                                                                     \
+    }
+
+  #define RIGEL_PROFILE_BEGIN_FRAME() ::rigel::base::profiler::beginFrame()
+
+#else
+
+  #define RIGEL_PROFILE_ZONE(name) static_cast<void>(0)
+  #define RIGEL_PROFILE_BEGIN_FRAME() static_cast<void>(0)
+
+#endif
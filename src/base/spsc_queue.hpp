@@ -0,0 +1,155 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+namespace rigel::base
+{
+
+/** Fixed-capacity wait-free queue for one producer and one consumer thread
+ *
+ * Push operations must only ever be called from one thread, and pop
+ * operations only from one (possibly different) thread. None of the
+ * operations block or allocate memory, which makes the queue suitable for
+ * communicating with realtime threads like an audio callback.
+ *
+ * Besides pushing and popping individual items, there's also a bulk
+ * interface for streaming data like audio samples.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+  explicit SpscQueue(const std::size_t capacity)
+    // One slot always stays empty to distinguish a full from an empty queue
+    : mStorage(capacity + 1)
+  {
+  }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  std::size_t capacity() const { return mStorage.size() - 1; }
+
+  /** Number of items which can currently be popped. Consumer only. */
+  std::size_t size() const
+  {
+    const auto readPos = mReadPos.load(std::memory_order_relaxed);
+    const auto writePos = mWritePos.load(std::memory_order_acquire);
+    return distance(readPos, writePos);
+  }
+
+  /** Number of items which can currently be pushed. Producer only. */
+  std::size_t freeSpace() const
+  {
+    const auto readPos = mReadPos.load(std::memory_order_acquire);
+    const auto writePos = mWritePos.load(std::memory_order_relaxed);
+    return capacity() - distance(readPos, writePos);
+  }
+
+  /** Returns false if the queue is full
+   *
+   * The given item is left untouched in that case, so it's safe to retry
+   * with the same (rvalue) item.
+   */
+  template <typename U>
+  bool tryPush(U&& item)
+  {
+    const auto writePos = mWritePos.load(std::memory_order_relaxed);
+    const auto nextWritePos = advance(writePos, 1);
+    if (nextWritePos == mReadPos.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+
+    mStorage[writePos] = std::forward<U>(item);
+    mWritePos.store(nextWritePos, std::memory_order_release);
+    return true;
+  }
+
+  /** Returns false if the queue is empty */
+  bool tryPop(T& item)
+  {
+    const auto readPos = mReadPos.load(std::memory_order_relaxed);
+    if (readPos == mWritePos.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+
+    item = std::move(mStorage[readPos]);
+    mReadPos.store(advance(readPos, 1), std::memory_order_release);
+    return true;
+  }
+
+  /** Push as many of the given items as fit, returns how many were pushed */
+  std::size_t push(const T* pItems, const std::size_t count)
+  {
+    const auto writePos = mWritePos.load(std::memory_order_relaxed);
+    const auto numToPush = std::min(count, freeSpace());
+
+    const auto firstPart = std::min(numToPush, mStorage.size() - writePos);
+    std::copy(pItems, pItems + firstPart, mStorage.begin() + writePos);
+    std::copy(pItems + firstPart, pItems + numToPush, mStorage.begin());
+
+    mWritePos.store(advance(writePos, numToPush), std::memory_order_release);
+    return numToPush;
+  }
+
+  /** Pop up to count items, returns how many were popped */
+  std::size_t pop(T* pItems, const std::size_t count)
+  {
+    const auto readPos = mReadPos.load(std::memory_order_relaxed);
+    const auto numToPop = std::min(count, size());
+
+    const auto firstPart = std::min(numToPop, mStorage.size() - readPos);
+    std::copy(
+      mStorage.begin() + readPos,
+      mStorage.begin() + readPos + firstPart,
+      pItems);
+    std::copy(
+      mStorage.begin(),
+      mStorage.begin() + (numToPop - firstPart),
+      pItems + firstPart);
+
+    mReadPos.store(advance(readPos, numToPop), std::memory_order_release);
+    return numToPop;
+  }
+
+private:
+  std::size_t advance(const std::size_t position, const std::size_t count)
+    const
+  {
+    return (position + count) % mStorage.size();
+  }
+
+  std::size_t distance(const std::size_t from, const std::size_t to) const
+  {
+    return to >= from ? to - from : to + mStorage.size() - from;
+  }
+
+  std::vector<T> mStorage;
+  std::atomic<std::size_t> mReadPos{0};
+  std::atomic<std::size_t> mWritePos{0};
+};
+
+} // namespace rigel::base
@@ -24,6 +24,7 @@ RIGEL_DISABLE_WARNINGS
 RIGEL_RESTORE_WARNINGS
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 
@@ -46,6 +47,9 @@ constexpr auto ENABLE_VSYNC_DEFAULT = true;
 constexpr auto MUSIC_VOLUME_DEFAULT = 1.0f;
 constexpr auto SOUND_VOLUME_DEFAULT = 1.0f;
 
+constexpr auto REWIND_MEMORY_BUDGET_MB_DEFAULT = 64;
+constexpr auto MAX_REWIND_MEMORY_BUDGET_MB = 1024;
+
 enum class WindowMode
 {
   Fullscreen,
@@ -142,6 +146,7 @@ struct GameOptions
   SDL_Keycode mFireKeybinding = SDLK_LALT;
   SDL_Keycode mQuickSaveKeybinding = SDLK_F5;
   SDL_Keycode mQuickLoadKeybinding = SDLK_F7;
+  SDL_Keycode mRewindKeybinding = SDLK_BACKSPACE;
 
   // Modding
   bool mEnableTopLevelMods = true;
@@ -154,6 +159,8 @@ struct GameOptions
   WidescreenHudStyle mWidescreenHudStyle = WidescreenHudStyle::Classic;
   bool mShowRadarInModernHud = true;
   bool mQuickSavingEnabled = false;
+  bool mRewindEnabled = false;
+  int mRewindMemoryBudgetMb = REWIND_MEMORY_BUDGET_MB_DEFAULT;
   bool mSkipIntro = false;
   bool mMotionSmoothing = false;
 
@@ -170,7 +177,12 @@ struct GameOptions
     return mCompatibilityModeOn && !mWidescreenModeOn;
   }
 
-  std::array<SDL_Keycode*, 8> allKeyBindings()
+  std::size_t rewindMemoryBudgetInBytes() const
+  {
+    return std::size_t(mRewindMemoryBudgetMb) * 1024 * 1024;
+  }
+
+  std::array<SDL_Keycode*, 9> allKeyBindings()
   {
     return {
       &mUpKeybinding,
@@ -181,6 +193,7 @@ struct GameOptions
       &mFireKeybinding,
       &mQuickSaveKeybinding,
       &mQuickLoadKeybinding,
+      &mRewindKeybinding,
     };
   }
 
@@ -30,6 +30,71 @@ namespace rigel::data::map
 using namespace std;
 
 
+namespace
+{
+
+constexpr auto BITS_PER_WORD = std::size_t{64};
+
+} // namespace
+
+
+Map::BitPlane::BitPlane(const size_t numLines, const size_t lineLength)
+  : mWords(numLines * ((lineLength + BITS_PER_WORD - 1) / BITS_PER_WORD), 0)
+  , mWordsPerLine((lineLength + BITS_PER_WORD - 1) / BITS_PER_WORD)
+{
+}
+
+
+void Map::BitPlane::set(
+  const size_t line,
+  const size_t position,
+  const bool value)
+{
+  auto& word = mWords[line * mWordsPerLine + position / BITS_PER_WORD];
+  const auto bit = uint64_t{1} << (position % BITS_PER_WORD);
+
+  if (value)
+  {
+    word |= bit;
+  }
+  else
+  {
+    word &= ~bit;
+  }
+}
+
+
+bool Map::BitPlane::anySet(
+  const size_t line,
+  const size_t first,
+  const size_t last) const
+{
+  const auto pLine = mWords.data() + line * mWordsPerLine;
+  const auto firstWord = first / BITS_PER_WORD;
+  const auto lastWord = last / BITS_PER_WORD;
+
+  for (auto i = firstWord; i <= lastWord; ++i)
+  {
+    auto mask = ~uint64_t{0};
+    if (i == firstWord)
+    {
+      mask &= ~uint64_t{0} << (first % BITS_PER_WORD);
+    }
+    if (i == lastWord)
+    {
+      mask &= ~uint64_t{0} >> (BITS_PER_WORD - 1 - last % BITS_PER_WORD);
+    }
+
+    if ((pLine[i] & mask) != 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
 Map::Map(
   const int widthInTiles,
   const int heightInTiles,
@@ -43,6 +108,24 @@ Map::Map(
 {
   assert(widthInTiles >= 0);
   assert(heightInTiles >= 0);
+
+  for (auto& plane : mSolidityByRow)
+  {
+    plane = BitPlane{mHeightInTiles, mWidthInTiles};
+  }
+
+  for (auto& plane : mSolidityByColumn)
+  {
+    plane = BitPlane{mWidthInTiles, mHeightInTiles};
+  }
+
+  for (auto y = 0; y < heightInTiles; ++y)
+  {
+    for (auto x = 0; x < widthInTiles; ++x)
+    {
+      updateSolidity(x, y);
+    }
+  }
 }
 
 
@@ -59,6 +142,7 @@ void Map::setTileAt(const int layer, const int x, const int y, TileIndex index)
     throw invalid_argument("Tile index too large for tile set");
   }
   tileRefAt(layer, x, y) = index;
+  updateSolidity(x, y);
 }
 
 
@@ -85,6 +169,29 @@ const TileAttributeDict& Map::attributeDict() const
 }
 
 
+std::size_t Map::memoryUsage() const
+{
+  auto result = mAttributes.bitPacks().capacity() * sizeof(std::uint16_t);
+
+  for (const auto& layer : mLayers)
+  {
+    result += layer.capacity() * sizeof(TileIndex);
+  }
+
+  for (const auto& plane : mSolidityByRow)
+  {
+    result += plane.memoryUsage();
+  }
+
+  for (const auto& plane : mSolidityByColumn)
+  {
+    result += plane.memoryUsage();
+  }
+
+  return result;
+}
+
+
 TileAttributes Map::attributes(const int x, const int y) const
 {
   if (
@@ -125,6 +232,88 @@ CollisionData Map::collisionData(const int x, const int y) const
     return CollisionData{};
   }
 
+  return computeCollisionData(x, y);
+}
+
+
+bool Map::isSolidOnHorizontalSpan(
+  const int startX,
+  const int endX,
+  const int y,
+  const SolidEdge edge) const
+{
+  if (startX > endX)
+  {
+    return false;
+  }
+
+  if (startX < 0 || static_cast<std::size_t>(endX) >= mWidthInTiles)
+  {
+    // Left/right edge of the map are always solid
+    return true;
+  }
+
+  if (static_cast<std::size_t>(y) >= mHeightInTiles)
+  {
+    // Bottom/top edge of the map are never solid
+    return false;
+  }
+
+  for (auto i = 0; i < NUM_SOLID_EDGES; ++i)
+  {
+    if (
+      (edge.mFlagsBitPack & (1 << i)) != 0 &&
+      mSolidityByRow[i].anySet(y, startX, endX))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+bool Map::isSolidOnVerticalSpan(
+  const int startY,
+  const int endY,
+  const int x,
+  const SolidEdge edge) const
+{
+  if (startY > endY)
+  {
+    return false;
+  }
+
+  if (static_cast<std::size_t>(x) >= mWidthInTiles)
+  {
+    // Left/right edge of the map are always solid
+    return true;
+  }
+
+  // Parts of the span outside of the map are never solid
+  const auto firstRow = std::max(startY, 0);
+  const auto lastRow = std::min(endY, height() - 1);
+  if (firstRow > lastRow)
+  {
+    return false;
+  }
+
+  for (auto i = 0; i < NUM_SOLID_EDGES; ++i)
+  {
+    if (
+      (edge.mFlagsBitPack & (1 << i)) != 0 &&
+      mSolidityByColumn[i].anySet(x, firstRow, lastRow))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+CollisionData Map::computeCollisionData(const int x, const int y) const
+{
   if (tileAt(0, x, y) != 0 && tileAt(1, x, y) != 0)
   {
     // "Composite" tiles (content on both layers) are ignored for collision
@@ -138,6 +327,20 @@ CollisionData Map::collisionData(const int x, const int y) const
 }
 
 
+void Map::updateSolidity(const int x, const int y)
+{
+  const auto data = computeCollisionData(x, y);
+
+  for (auto i = 0; i < NUM_SOLID_EDGES; ++i)
+  {
+    const auto edge = SolidEdge{static_cast<uint8_t>(1 << i)};
+    const auto isSolid = data.isSolidOn(edge);
+    mSolidityByRow[i].set(y, x, isSolid);
+    mSolidityByColumn[i].set(x, y, isSolid);
+  }
+}
+
+
 const map::TileIndex&
   Map::tileRefAt(const int layerS, const int xS, const int yS) const
 {
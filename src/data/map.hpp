@@ -22,6 +22,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
@@ -69,14 +70,67 @@ public:
 
   CollisionData collisionData(int x, int y) const;
 
+  /** Test if any tile in a horizontal span is solid on the given edge
+   *
+   * Equivalent to testing collisionData(x, y).isSolidOn(edge) for each x in
+   * [startX, endX], but uses precomputed bit planes to test up to 64 tiles
+   * at once.
+   */
+  bool isSolidOnHorizontalSpan(int startX, int endX, int y, SolidEdge edge)
+    const;
+
+  /** Test if any tile in a vertical span is solid on the given edge
+   *
+   * Equivalent to testing collisionData(x, y).isSolidOn(edge) for each y in
+   * [startY, endY], see isSolidOnHorizontalSpan().
+   */
+  bool isSolidOnVerticalSpan(int startY, int endY, int x, SolidEdge edge)
+    const;
+
+  /** Heap memory held by the map, in bytes */
+  std::size_t memoryUsage() const;
+
 private:
+  /** One bit per tile, stored line by line */
+  class BitPlane
+  {
+  public:
+    BitPlane() = default;
+    BitPlane(std::size_t numLines, std::size_t lineLength);
+
+    void set(std::size_t line, std::size_t position, bool value);
+
+    /** Test if any bit in [first, last] of the given line is set */
+    bool anySet(std::size_t line, std::size_t first, std::size_t last) const;
+
+    std::size_t memoryUsage() const
+    {
+      return mWords.capacity() * sizeof(std::uint64_t);
+    }
+
+  private:
+    std::vector<std::uint64_t> mWords;
+    std::size_t mWordsPerLine = 0;
+  };
+
+  static constexpr auto NUM_SOLID_EDGES = 4;
+
   const TileIndex& tileRefAt(int layer, int x, int y) const;
   TileIndex& tileRefAt(int layer, int x, int y);
 
+  CollisionData computeCollisionData(int x, int y) const;
+  void updateSolidity(int x, int y);
+
 private:
   using TileArray = std::vector<TileIndex>;
   std::array<TileArray, 2> mLayers;
 
+  // Solidity of each tile, one plane per edge. Horizontal spans are tested
+  // using the row-major planes, vertical spans using the column-major ones.
+  // Kept in sync with the tile data by setTileAt().
+  std::array<BitPlane, NUM_SOLID_EDGES> mSolidityByRow;
+  std::array<BitPlane, NUM_SOLID_EDGES> mSolidityByColumn;
+
   std::size_t mWidthInTiles;
   std::size_t mHeightInTiles;
 
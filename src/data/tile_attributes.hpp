@@ -38,6 +38,7 @@ public:
   static SolidEdge any();
 
   friend class CollisionData;
+  friend class Map;
 
 private:
   explicit SolidEdge(const std::uint8_t bitPack)
@@ -100,6 +101,8 @@ public:
   TileAttributes attributes(TileIndex tile) const;
   CollisionData collisionData(TileIndex tile) const;
 
+  const AttributeArray& bitPacks() const { return mAttributeBitPacks; }
+
 private:
   std::uint16_t bitPackFor(TileIndex tile) const;
 
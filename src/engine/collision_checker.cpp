@@ -29,6 +29,19 @@ using data::map::SolidEdge;
 using namespace engine::components;
 
 
+namespace
+{
+
+template <typename T>
+const T* componentPtrIfPresent(ex::Entity entity)
+{
+  return entity.has_component<T>() ? entity.component<const T>().get()
+                                   : nullptr;
+}
+
+} // namespace
+
+
 CollisionChecker::CollisionChecker(
   const data::map::Map* pMap,
   ex::EntityManager& entities,
@@ -36,11 +49,18 @@ CollisionChecker::CollisionChecker(
   : mpMap(pMap)
 {
   entities.each<SolidBody>([this](ex::Entity entity, const SolidBody&) {
-    mSolidBodies.push_back(entity);
+    mSolidBodies.push_back(SolidBodyInfo{
+      entity,
+      componentPtrIfPresent<WorldPosition>(entity),
+      componentPtrIfPresent<BoundingBox>(entity)});
   });
 
   eventManager.subscribe<ex::ComponentAddedEvent<SolidBody>>(*this);
   eventManager.subscribe<ex::ComponentRemovedEvent<SolidBody>>(*this);
+  eventManager.subscribe<ex::ComponentAddedEvent<WorldPosition>>(*this);
+  eventManager.subscribe<ex::ComponentRemovedEvent<WorldPosition>>(*this);
+  eventManager.subscribe<ex::ComponentAddedEvent<BoundingBox>>(*this);
+  eventManager.subscribe<ex::ComponentRemovedEvent<BoundingBox>>(*this);
 }
 
 
@@ -95,15 +115,7 @@ bool CollisionChecker::testHorizontalSpan(
     }
   }
 
-  for (int x = startX; x <= endX; ++x)
-  {
-    if (mpMap->collisionData(x, y).isSolidOn(edge))
-    {
-      return true;
-    }
-  }
-
-  return false;
+  return mpMap->isSolidOnHorizontalSpan(startX, endX, y, edge);
 }
 
 
@@ -122,15 +134,7 @@ bool CollisionChecker::testVerticalSpan(
     }
   }
 
-  for (int y = startY; y <= endY; ++y)
-  {
-    if (mpMap->collisionData(x, y).isSolidOn(edge))
-    {
-      return true;
-    }
-  }
-
-  return false;
+  return mpMap->isSolidOnVerticalSpan(startY, endY, x, edge);
 }
 
 
@@ -140,14 +144,11 @@ bool CollisionChecker::testSolidBodyCollision(
   return any_of(
     begin(mSolidBodies),
     end(mSolidBodies),
-    [&bboxToTest](const ex::Entity& entity) {
-      if (
-        entity.has_component<BoundingBox>() &&
-        entity.has_component<WorldPosition>())
+    [&bboxToTest](const SolidBodyInfo& info) {
+      if (info.mpBbox && info.mpPosition)
       {
-        const auto solidBodyBbox = engine::toWorldSpace(
-          *entity.component<const BoundingBox>(),
-          *entity.component<const WorldPosition>());
+        const auto solidBodyBbox =
+          engine::toWorldSpace(*info.mpBbox, *info.mpPosition);
         return solidBodyBbox.intersects(bboxToTest);
       }
 
@@ -156,6 +157,18 @@ bool CollisionChecker::testSolidBodyCollision(
 }
 
 
+CollisionChecker::SolidBodyInfo*
+  CollisionChecker::findSolidBody(const ex::Entity entity)
+{
+  const auto it = find_if(
+    begin(mSolidBodies), end(mSolidBodies), [&entity](const auto& info) {
+      return info.mEntity == entity;
+    });
+
+  return it != end(mSolidBodies) ? &*it : nullptr;
+}
+
+
 bool CollisionChecker::isTouchingCeiling(
   const BoundingBox& worldSpaceBbox) const
 {
@@ -201,21 +214,87 @@ bool CollisionChecker::isTouchingRightWall(
 
 void CollisionChecker::receive(const ex::ComponentAddedEvent<SolidBody>& event)
 {
-  mSolidBodies.push_back(event.entity);
+  mSolidBodies.push_back(SolidBodyInfo{
+    event.entity,
+    componentPtrIfPresent<WorldPosition>(event.entity),
+    componentPtrIfPresent<BoundingBox>(event.entity)});
 }
 
 
 void CollisionChecker::receive(
   const ex::ComponentRemovedEvent<SolidBody>& event)
 {
-  const auto it = find_if(
-    begin(mSolidBodies), end(mSolidBodies), [&event](const auto& entity) {
-      return entity == event.entity;
-    });
+  if (const auto pInfo = findSolidBody(event.entity))
+  {
+    // Order doesn't matter, so avoid shifting the remaining elements
+    *pInfo = mSolidBodies.back();
+    mSolidBodies.pop_back();
+  }
+}
+
+
+void CollisionChecker::receive(
+  const ex::ComponentAddedEvent<WorldPosition>& event)
+{
+  // This event is received for all entities, but only solid bodies are of
+  // interest. Checking for the SolidBody component first keeps it cheap.
+  auto entity = event.entity;
+  if (!entity.has_component<SolidBody>())
+  {
+    return;
+  }
+
+  if (const auto pInfo = findSolidBody(entity))
+  {
+    pInfo->mpPosition = entity.component<const WorldPosition>().get();
+  }
+}
+
+
+void CollisionChecker::receive(
+  const ex::ComponentRemovedEvent<WorldPosition>& event)
+{
+  auto entity = event.entity;
+  if (!entity.has_component<SolidBody>())
+  {
+    return;
+  }
+
+  if (const auto pInfo = findSolidBody(entity))
+  {
+    pInfo->mpPosition = nullptr;
+  }
+}
+
+
+void CollisionChecker::receive(
+  const ex::ComponentAddedEvent<BoundingBox>& event)
+{
+  auto entity = event.entity;
+  if (!entity.has_component<SolidBody>())
+  {
+    return;
+  }
+
+  if (const auto pInfo = findSolidBody(entity))
+  {
+    pInfo->mpBbox = entity.component<const BoundingBox>().get();
+  }
+}
+
+
+void CollisionChecker::receive(
+  const ex::ComponentRemovedEvent<BoundingBox>& event)
+{
+  auto entity = event.entity;
+  if (!entity.has_component<SolidBody>())
+  {
+    return;
+  }
 
-  if (it != end(mSolidBodies))
+  if (const auto pInfo = findSolidBody(entity))
   {
-    mSolidBodies.erase(it);
+    pInfo->mpBbox = nullptr;
   }
 }
 
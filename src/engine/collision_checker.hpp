@@ -70,12 +70,36 @@ public:
     receive(const entityx::ComponentAddedEvent<components::SolidBody>& event);
   void
     receive(const entityx::ComponentRemovedEvent<components::SolidBody>& event);
+  void receive(
+    const entityx::ComponentAddedEvent<components::WorldPosition>& event);
+  void receive(
+    const entityx::ComponentRemovedEvent<components::WorldPosition>& event);
+  void receive(
+    const entityx::ComponentAddedEvent<components::BoundingBox>& event);
+  void receive(
+    const entityx::ComponentRemovedEvent<components::BoundingBox>& event);
 
 private:
+  /** Cached component addresses of a solid body
+   *
+   * entityx never relocates components while they are assigned, so we can
+   * keep pointers to them instead of looking them up on every collision
+   * test. The pointers are kept up to date via component added/removed
+   * events, and are null while the corresponding component is missing.
+   */
+  struct SolidBodyInfo
+  {
+    entityx::Entity mEntity;
+    const components::WorldPosition* mpPosition = nullptr;
+    const components::BoundingBox* mpBbox = nullptr;
+  };
+
   bool
     testSolidBodyCollision(const engine::components::BoundingBox& bbox) const;
 
-  std::vector<entityx::Entity> mSolidBodies;
+  SolidBodyInfo* findSolidBody(entityx::Entity entity);
+
+  std::vector<SolidBodyInfo> mSolidBodies;
   const data::map::Map* mpMap;
 };
 
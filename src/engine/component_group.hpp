@@ -0,0 +1,187 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/warnings.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+
+namespace rigel::engine
+{
+
+/** Packed list of all entities having a certain combination of components
+ *
+ * Iterating over a component combination via EntityManager::each() checks
+ * the component mask of every single entity, and then looks up each
+ * component individually. For hot combinations like the ones used by the
+ * physics system, this group keeps a contiguous array of the matching
+ * entities together with the addresses of their components instead.
+ * entityx never relocates components while they are assigned, so the
+ * addresses stay valid until the group learns about the component's
+ * removal via the corresponding event.
+ *
+ * each() is a drop-in replacement for EntityManager::each(): Entities are
+ * visited in the same order (ascending entity index), and changes made by
+ * the callback are handled the same way. Entities which lose one of the
+ * components before being visited are skipped, and entities created or
+ * completed during the iteration are visited if their index is higher than
+ * the current one - unless they occupy a slot which didn't exist yet when
+ * the iteration started.
+ */
+template <typename... Components>
+class ComponentGroup : public entityx::Receiver<ComponentGroup<Components...>>
+{
+public:
+  ComponentGroup(
+    entityx::EntityManager& entities,
+    entityx::EventManager& eventManager)
+    : mpEntities(&entities)
+  {
+    entities.each<Components...>(
+      [this](entityx::Entity entity, Components&... components) {
+        mItems.push_back(Item{entity, std::make_tuple(&components...)});
+      });
+
+    (eventManager.subscribe<entityx::ComponentAddedEvent<Components>>(*this),
+     ...);
+    (eventManager.subscribe<entityx::ComponentRemovedEvent<Components>>(*this),
+     ...);
+  }
+
+  ComponentGroup(const ComponentGroup&) = delete;
+  ComponentGroup& operator=(const ComponentGroup&) = delete;
+
+  template <typename Callback>
+  void each(Callback&& callback)
+  {
+    const auto indexLimit = mpEntities->capacity();
+    auto lastSeenModificationCount = mModificationCount;
+
+    for (auto i = std::size_t{0}; i < mItems.size();)
+    {
+      // The callback might add or remove items, so we can't keep a
+      // reference into the list.
+      const auto item = mItems[i];
+      const auto index = item.mEntity.id().index();
+      if (index >= indexLimit)
+      {
+        break;
+      }
+
+      std::apply(
+        [&](Components*... pComponents) {
+          callback(item.mEntity, *pComponents...);
+        },
+        item.mComponents);
+
+      if (mModificationCount == lastSeenModificationCount)
+      {
+        ++i;
+      }
+      else
+      {
+        lastSeenModificationCount = mModificationCount;
+        i = std::distance(mItems.begin(), findFirstAfter(index));
+      }
+    }
+  }
+
+  std::size_t size() const { return mItems.size(); }
+
+  template <typename C>
+  void receive(const entityx::ComponentAddedEvent<C>& event)
+  {
+    entityx::Entity entity = event.entity;
+    if (!(entity.has_component<Components>() && ...))
+    {
+      return;
+    }
+
+    const auto item =
+      Item{entity, std::make_tuple(entity.component<Components>().get()...)};
+
+    const auto iItem = findFirstNotBefore(entity.id().index());
+    if (iItem != mItems.end() && iItem->mEntity == entity)
+    {
+      *iItem = item;
+    }
+    else
+    {
+      mItems.insert(iItem, item);
+    }
+
+    ++mModificationCount;
+  }
+
+  template <typename C>
+  void receive(const entityx::ComponentRemovedEvent<C>& event)
+  {
+    const auto iItem = findFirstNotBefore(event.entity.id().index());
+    if (iItem != mItems.end() && iItem->mEntity == event.entity)
+    {
+      mItems.erase(iItem);
+      ++mModificationCount;
+    }
+  }
+
+private:
+  struct Item
+  {
+    entityx::Entity mEntity;
+    std::tuple<Components*...> mComponents;
+  };
+
+  using ItemIter = typename std::vector<Item>::iterator;
+
+  ItemIter findFirstNotBefore(const std::uint32_t index)
+  {
+    return std::lower_bound(
+      mItems.begin(),
+      mItems.end(),
+      index,
+      [](const Item& item, const std::uint32_t value) {
+        return item.mEntity.id().index() < value;
+      });
+  }
+
+  ItemIter findFirstAfter(const std::uint32_t index)
+  {
+    return std::upper_bound(
+      mItems.begin(),
+      mItems.end(),
+      index,
+      [](const std::uint32_t value, const Item& item) {
+        return value < item.mEntity.id().index();
+      });
+  }
+
+  std::vector<Item> mItems;
+  entityx::EntityManager* mpEntities;
+  std::uint64_t mModificationCount = 0;
+};
+
+} // namespace rigel::engine
@@ -98,4 +98,158 @@ void markActiveEntities(
   });
 }
 
+
+EntityActivationSystem::EntityActivationSystem(
+  entityx::EntityManager& entities,
+  entityx::EventManager& eventManager)
+{
+  entities.each<WorldPosition, BoundingBox>(
+    [this](entityx::Entity entity, const WorldPosition&, const BoundingBox&) {
+      mPendingEntities.push_back(entity);
+    });
+
+  eventManager.subscribe<entityx::ComponentAddedEvent<WorldPosition>>(*this);
+  eventManager.subscribe<entityx::ComponentAddedEvent<BoundingBox>>(*this);
+  eventManager.subscribe<entityx::ComponentAddedEvent<ActivationSettings>>(
+    *this);
+}
+
+
+void EntityActivationSystem::update(
+  const base::Vec2& cameraPosition,
+  const base::Size& viewportSize)
+{
+  const BoundingBox activeRegionBox{cameraPosition, viewportSize};
+
+  // Newly added entities are only looked at here, not when receiving the
+  // event, since their position is often still adjusted after assigning
+  // components.
+  mCandidates.clear();
+  mCandidates.insert(
+    mCandidates.end(), mPendingEntities.begin(), mPendingEntities.end());
+  mCandidates.insert(
+    mCandidates.end(), mActiveEntities.begin(), mActiveEntities.end());
+  mRegionIndex.forEachCandidate(
+    activeRegionBox,
+    [this](const entityx::Entity entity) { mCandidates.push_back(entity); });
+
+  mPendingEntities.clear();
+  mActiveEntities.clear();
+  mNumVisitedEntities = 0;
+  ++mGeneration;
+
+  for (const auto entity : mCandidates)
+  {
+    visit(entity, activeRegionBox);
+  }
+}
+
+
+void EntityActivationSystem::markMoved(const entityx::Entity entity)
+{
+  mPendingEntities.push_back(entity);
+}
+
+
+void EntityActivationSystem::receive(
+  const entityx::ComponentAddedEvent<WorldPosition>& event)
+{
+  mPendingEntities.push_back(event.entity);
+}
+
+
+void EntityActivationSystem::receive(
+  const entityx::ComponentAddedEvent<BoundingBox>& event)
+{
+  mPendingEntities.push_back(event.entity);
+}
+
+
+void EntityActivationSystem::receive(
+  const entityx::ComponentAddedEvent<ActivationSettings>& event)
+{
+  mPendingEntities.push_back(event.entity);
+}
+
+
+void EntityActivationSystem::visit(
+  entityx::Entity entity,
+  const base::Rect<int>& activeRegion)
+{
+  const auto index = entity.id().index();
+  if (index >= mIndexEntries.size())
+  {
+    if (!entity.valid())
+    {
+      return;
+    }
+
+    mIndexEntries.resize(index + 1);
+  }
+
+  auto& entry = mIndexEntries[index];
+  if (entry.mEntity != entity)
+  {
+    // Candidates can refer to destroyed entities. If the slot has been
+    // reused in the meantime, the previous entity's index entry needs to be
+    // replaced.
+    if (!entity.valid())
+    {
+      return;
+    }
+
+    unindex(entry);
+    entry = IndexEntry{entity};
+  }
+
+  if (entry.mLastVisitedGeneration == mGeneration)
+  {
+    return;
+  }
+
+  entry.mLastVisitedGeneration = mGeneration;
+  ++mNumVisitedEntities;
+
+  if (
+    !entity.valid() || !entity.has_component<WorldPosition>() ||
+    !entity.has_component<BoundingBox>())
+  {
+    unindex(entry);
+    return;
+  }
+
+  const auto bounds = toWorldSpace(
+    *entity.component<const BoundingBox>(),
+    *entity.component<const WorldPosition>());
+  if (entry.mIsIndexed)
+  {
+    mRegionIndex.move(entity, entry.mBounds, bounds);
+  }
+  else
+  {
+    mRegionIndex.insert(entity, bounds);
+    entry.mIsIndexed = true;
+  }
+  entry.mBounds = bounds;
+
+  const auto inActiveRegion = bounds.intersects(activeRegion);
+  const auto active = determineActiveState(entity, inActiveRegion);
+  setTag<Active>(entity, active);
+  if (active)
+  {
+    entity.component<Active>()->mIsOnScreen = inActiveRegion;
+    mActiveEntities.push_back(entity);
+  }
+}
+
+
+void EntityActivationSystem::unindex(IndexEntry& entry)
+{
+  if (entry.mIsIndexed)
+  {
+    mRegionIndex.remove(entry.mEntity, entry.mBounds);
+    entry.mIsIndexed = false;
+  }
+}
+
 } // namespace rigel::engine
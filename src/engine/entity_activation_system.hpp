@@ -18,18 +18,95 @@
 
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
+#include "engine/base_components.hpp"
+#include "engine/spatial_grid.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstdint>
+#include <vector>
+
 
 namespace rigel::engine
 {
 
+/** Updates the Active tag of all entities by visiting each one of them
+ *
+ * Cost is linear in the total number of entities. The game uses
+ * EntityActivationSystem instead, this is kept as a reference.
+ */
 void markActiveEntities(
   entityx::EntityManager& es,
   const base::Vec2& cameraPosition,
   const base::Size& viewportSize);
 
-}
+
+/** Maintains the Active tag incrementally
+ *
+ * Produces the same result as markActiveEntities(), but only visits entities
+ * which can possibly change their state: Those which are currently active
+ * (this includes all always-active ones), those located in the map regions
+ * overlapped by the active region, and newly added ones. Cost thus depends
+ * on what's near the screen instead of on the total number of entities.
+ *
+ * Entities are assigned to regions based on the position they had when they
+ * were last visited. Inactive entities are mostly not updated by the game
+ * logic, so their position normally doesn't change. Code which does move
+ * entities regardless of their Active tag (like the item bounce effect) has
+ * to report this via markMoved(). Assigning ActivationSettings is
+ * picked up right away, but modifying them in place only takes effect the
+ * next time the entity is visited - which is on every frame for active
+ * entities.
+ */
+class EntityActivationSystem
+  : public entityx::Receiver<EntityActivationSystem>
+{
+public:
+  static constexpr auto REGION_SIZE = 16;
+
+  EntityActivationSystem(
+    entityx::EntityManager& entities,
+    entityx::EventManager& eventManager);
+
+  void update(const base::Vec2& cameraPosition, const base::Size& viewportSize);
+
+  std::size_t numVisitedEntities() const { return mNumVisitedEntities; }
+  std::size_t numActiveEntities() const { return mActiveEntities.size(); }
+
+  /** Make the next update() look at the entity's current position
+   *
+   * Only needed for entities which were moved while inactive.
+   */
+  void markMoved(entityx::Entity entity);
+
+  void receive(
+    const entityx::ComponentAddedEvent<components::WorldPosition>& event);
+  void receive(
+    const entityx::ComponentAddedEvent<components::BoundingBox>& event);
+  void receive(
+    const entityx::ComponentAddedEvent<components::ActivationSettings>& event);
+
+private:
+  struct IndexEntry
+  {
+    entityx::Entity mEntity;
+    base::Rect<int> mBounds;
+    std::uint32_t mLastVisitedGeneration = 0;
+    bool mIsIndexed = false;
+  };
+
+  void visit(entityx::Entity entity, const base::Rect<int>& activeRegion);
+  void unindex(IndexEntry& entry);
+
+  SpatialGrid<entityx::Entity> mRegionIndex{REGION_SIZE};
+  std::vector<IndexEntry> mIndexEntries;
+  std::vector<entityx::Entity> mActiveEntities;
+  std::vector<entityx::Entity> mPendingEntities;
+  std::vector<entityx::Entity> mCandidates;
+  std::size_t mNumVisitedEntities = 0;
+  std::uint32_t mGeneration = 0;
+};
+
+} // namespace rigel::engine
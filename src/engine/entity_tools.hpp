@@ -23,6 +23,9 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstddef>
+#include <vector>
+
 
 namespace rigel::engine
 {
@@ -80,4 +83,37 @@ inline void resetActivation(entityx::Entity entity)
   entity.component<components::ActivationSettings>()->mHasBeenActivated = false;
 }
 
+
+/** Prepares the entity manager for creating many short-lived entities
+ *
+ * Afterwards, at least count entities can be created without the entity
+ * manager having to grow its storage. Destroyed entities already have their
+ * slot (including component storage) recycled by the entity manager, so this
+ * avoids allocation spikes when spawning large bursts of effects like debris
+ * or explosions.
+ *
+ * The reserved slots are put back into the entity manager's free list in
+ * reverse order. Since the free list is used in last-in first-out order,
+ * subsequently created entities receive exactly the same indices as they
+ * would have without the reservation. This is important, since entity
+ * indices determine the update order of many systems.
+ */
+inline void reserveEntities(
+  entityx::EntityManager& entities,
+  const std::size_t count)
+{
+  std::vector<entityx::Entity> reserved;
+  reserved.reserve(count);
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    reserved.push_back(entities.create());
+  }
+
+  for (auto iEntity = reserved.rbegin(); iEntity != reserved.rend(); ++iEntity)
+  {
+    iEntity->destroy();
+  }
+}
+
 } // namespace rigel::engine
@@ -0,0 +1,97 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/warnings.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+namespace rigel::engine
+{
+
+/** Collects events of one type for delivery at a later point
+ *
+ * Emitting an event via entityx::EventManager immediately invokes all
+ * receivers, which is costly when done for many entities in the middle of a
+ * hot loop. Systems can instead push events into a queue, which only appends
+ * to a vector. flush() then delivers all queued events in the order they
+ * were pushed, via the regular event manager, so receivers don't need to be
+ * aware of the queue. Events which are pushed while flushing are delivered
+ * as part of the same flush.
+ *
+ * The queue's storage is kept across flushes, so once it has grown to the
+ * typical number of events per frame, no more allocations happen.
+ *
+ * Receivers run later than they would with immediate delivery, so this is
+ * only suitable for events whose receivers don't need to run before the
+ * emitting code continues.
+ */
+template <typename Event>
+class EventQueue
+{
+public:
+  template <typename... Args>
+  void push(Args&&... args)
+  {
+    mEvents.push_back(Event{std::forward<Args>(args)...});
+  }
+
+  void flush(entityx::EventManager& events)
+  {
+    flush(events, [](const Event&) { return true; });
+  }
+
+  /** Deliver queued events for which shouldDeliver returns true
+   *
+   * Useful to skip events that refer to entities which have been destroyed
+   * since the event was pushed.
+   */
+  template <typename Predicate>
+  void flush(entityx::EventManager& events, Predicate&& shouldDeliver)
+  {
+    // Receivers might push more events, which can reallocate the storage,
+    // so we can't hold on to references or iterators here.
+    for (std::size_t i = 0; i < mEvents.size(); ++i)
+    {
+      const auto event = mEvents[i];
+      if (shouldDeliver(event))
+      {
+        events.emit(event);
+      }
+    }
+
+    mEvents.clear();
+  }
+
+  void clear() { mEvents.clear(); }
+
+  bool empty() const { return mEvents.empty(); }
+  std::size_t size() const { return mEvents.size(); }
+
+private:
+  std::vector<Event> mEvents;
+};
+
+} // namespace rigel::engine
@@ -60,10 +60,9 @@ struct TileBlockData
 };
 
 
-void buildBlock(
+std::array<TileBlock, 2> buildBlock(
   const int blockX,
   const int blockY,
-  TileRenderData& renderData,
   const data::map::Map& map,
   const TiledTexture& tileSetTexture,
   renderer::Renderer* pRenderer)
@@ -114,6 +113,7 @@ void buildBlock(
   }
 
   // Commit block data
+  auto result = std::array<TileBlock, 2>{};
   for (auto layer = 0; layer < 2; ++layer)
   {
     auto& data = blockData[layer];
@@ -122,15 +122,24 @@ void buildBlock(
       ? renderer::INVALID_VERTEX_BUFFER_ID
       : pRenderer->createVertexBuffer(data.mVertices);
 
-    renderData.mLayers[layer].push_back(
-      {buffer, std::move(data.mAnimatedTiles)});
+    result[layer] = {buffer, std::move(data.mAnimatedTiles)};
+  }
+
+  return result;
+}
+
+
+void destroyBlock(const TileBlock& block, renderer::Renderer* pRenderer)
+{
+  if (block.mTilesBuffer != renderer::INVALID_VERTEX_BUFFER_ID)
+  {
+    pRenderer->destroyVertexBuffer(block.mTilesBuffer);
   }
 }
 
 
-TileRenderData buildRenderData(
+TileRenderData createEmptyRenderData(
   const data::map::Map& map,
-  const TiledTexture& tileSetTexture,
   renderer::Renderer* pRenderer)
 {
   const auto numBlocksX = base::integerDivCeil(map.width(), BLOCK_SIZE);
@@ -138,12 +147,11 @@ TileRenderData buildRenderData(
 
   TileRenderData result{{numBlocksX, numBlocksY}, pRenderer};
 
-  for (auto blockY = 0; blockY < numBlocksY; ++blockY)
+  for (auto& layer : result.mLayers)
   {
-    for (auto blockX = 0; blockX < numBlocksX; ++blockX)
-    {
-      buildBlock(blockX, blockY, result, map, tileSetTexture, pRenderer);
-    }
+    layer.resize(
+      numBlocksX * numBlocksY,
+      TileBlock{renderer::INVALID_VERTEX_BUFFER_ID, {}});
   }
 
   return result;
@@ -229,10 +237,7 @@ TileRenderData::~TileRenderData()
   {
     for (const auto& block : layer)
     {
-      if (block.mTilesBuffer != renderer::INVALID_VERTEX_BUFFER_ID)
-      {
-        mpRenderer->destroyVertexBuffer(block.mTilesBuffer);
-      }
+      destroyBlock(block, mpRenderer);
     }
   }
 }
@@ -240,7 +245,7 @@ TileRenderData::~TileRenderData()
 
 MapRenderer::MapRenderer(
   renderer::Renderer* pRenderer,
-  const data::map::Map& map,
+  data::map::Map map,
   const data::map::TileAttributeDict* pTileAttributes,
   MapRenderData&& renderData)
   : mpRenderer(pRenderer)
@@ -250,7 +255,10 @@ MapRenderer::MapRenderer(
       TILE_SET_IMAGE_LOGICAL_SIZE,
       pRenderer)
   , mBackdropTexture(mpRenderer, renderData.mBackdropImage)
-  , mRenderData(buildRenderData(map, mTileSetTexture, pRenderer))
+  , mMap(std::move(map))
+  , mRenderData(createEmptyRenderData(mMap, pRenderer))
+  , mDirtyBlocks(
+      std::size_t(mRenderData.mSize.width * mRenderData.mSize.height), true)
   , mScrollMode(renderData.mBackdropScrollMode)
 {
   if (renderData.mSecondaryBackdropImage)
@@ -261,10 +269,90 @@ MapRenderer::MapRenderer(
 }
 
 
-void MapRenderer::synchronizeTo(const MapRenderer& other)
+MapRenderer::SavedState MapRenderer::saveState() const
+{
+  return {mBackdropAutoScrollOffset, mElapsedFrames};
+}
+
+
+void MapRenderer::restoreState(
+  const SavedState& state,
+  const data::map::Map& map)
+{
+  mBackdropAutoScrollOffset = state.mBackdropAutoScrollOffset;
+  mElapsedFrames = state.mElapsedFrames;
+
+  updateTiles(map, {{}, {mMap.width(), mMap.height()}});
+}
+
+
+void MapRenderer::updateTiles(
+  const data::map::Map& map,
+  const base::Rect<int>& section)
+{
+  const auto startX = std::max(section.left(), 0);
+  const auto startY = std::max(section.top(), 0);
+  const auto endX = std::min(section.right(), mMap.width() - 1);
+  const auto endY = std::min(section.bottom(), mMap.height() - 1);
+
+  for (auto y = startY; y <= endY; ++y)
+  {
+    for (auto x = startX; x <= endX; ++x)
+    {
+      for (auto layer = 0; layer < 2; ++layer)
+      {
+        const auto tileIndex = map.tileAt(layer, x, y);
+        if (tileIndex != mMap.tileAt(layer, x, y))
+        {
+          mMap.setTileAt(layer, x, y, tileIndex);
+
+          const auto blockIndex =
+            x / BLOCK_SIZE + y / BLOCK_SIZE * mRenderData.mSize.width;
+          mDirtyBlocks[blockIndex] = true;
+        }
+      }
+    }
+  }
+}
+
+
+void MapRenderer::buildPendingBlocks(const int maxBlocks)
+{
+  auto numBlocksBuilt = 0;
+
+  for (auto blockIndex = 0; blockIndex < int(mDirtyBlocks.size());
+       ++blockIndex)
+  {
+    if (numBlocksBuilt == maxBlocks)
+    {
+      break;
+    }
+
+    if (mDirtyBlocks[blockIndex])
+    {
+      rebuildBlock(
+        blockIndex % mRenderData.mSize.width,
+        blockIndex / mRenderData.mSize.width);
+      ++numBlocksBuilt;
+    }
+  }
+}
+
+
+void MapRenderer::rebuildBlock(const int blockX, const int blockY) const
 {
-  mBackdropAutoScrollOffset = other.mBackdropAutoScrollOffset;
-  mElapsedFrames = other.mElapsedFrames;
+  const auto blockIndex = blockX + blockY * mRenderData.mSize.width;
+
+  auto blocks = buildBlock(blockX, blockY, mMap, mTileSetTexture, mpRenderer);
+
+  for (auto layer = 0; layer < 2; ++layer)
+  {
+    auto& block = mRenderData.mLayers[layer][blockIndex];
+    destroyBlock(block, mpRenderer);
+    block = std::move(blocks[layer]);
+  }
+
+  mDirtyBlocks[blockIndex] = false;
 }
 
 
@@ -433,6 +521,11 @@ void MapRenderer::renderMapTiles(
            ++x)
       {
         const auto blockIndex = x + y * mRenderData.mSize.width;
+        if (mDirtyBlocks[blockIndex])
+        {
+          rebuildBlock(x, y);
+        }
+
         func(mRenderData.mLayers[layerIndex][blockIndex]);
       }
     }
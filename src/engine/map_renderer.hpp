@@ -94,13 +94,40 @@ public:
     data::map::BackdropScrollMode mBackdropScrollMode;
   };
 
+  /** Animation state, the tiles are saved separately via map() */
+  struct SavedState
+  {
+    float mBackdropAutoScrollOffset;
+    std::uint32_t mElapsedFrames;
+  };
+
   MapRenderer(
     renderer::Renderer* renderer,
-    const data::map::Map& map,
+    data::map::Map map,
     const data::map::TileAttributeDict* pTileAttributes,
     MapRenderData&& renderData);
 
-  void synchronizeTo(const MapRenderer& other);
+  SavedState saveState() const;
+  void restoreState(const SavedState& state, const data::map::Map& map);
+
+  /** CPU-side copy of the tiles, without any GPU resources */
+  const data::map::Map& map() const { return mMap; }
+
+  /** Copy tiles in the given section from the given map
+   *
+   * Used to keep the cached tile blocks up to date when the map changes
+   * during gameplay. Blocks containing modified tiles are rebuilt the next
+   * time they become visible.
+   */
+  void updateTiles(const data::map::Map& map, const base::Rect<int>& section);
+
+  /** Build up to maxBlocks tile blocks which are out of date
+   *
+   * Blocks are built on demand once they become visible, but building all of
+   * them up front would stall the level start. Calling this once per frame
+   * spreads out the remaining work.
+   */
+  void buildPendingBlocks(int maxBlocks);
 
   bool hasHighResReplacements() const;
 
@@ -144,6 +171,8 @@ private:
     DrawMode drawMode) const;
   data::map::TileIndex animatedTileIndex(data::map::TileIndex) const;
 
+  void rebuildBlock(int blockX, int blockY) const;
+
 private:
   renderer::Renderer* mpRenderer;
   const data::map::TileAttributeDict* mpTileAttributes;
@@ -152,7 +181,13 @@ private:
   renderer::Texture mBackdropTexture;
   renderer::Texture mAlternativeBackdropTexture;
 
-  TileRenderData mRenderData;
+  data::map::Map mMap;
+
+  // Tile blocks are a cache of the contents of mMap. Initially, all blocks
+  // are dirty. Blocks are also marked as dirty by updateTiles(), and
+  // (re)built on demand during rendering or by buildPendingBlocks().
+  mutable TileRenderData mRenderData;
+  mutable std::vector<bool> mDirtyBlocks;
 
   data::map::BackdropScrollMode mScrollMode;
 
@@ -16,16 +16,14 @@
 
 #include "particle_system.hpp"
 
+#include "base/math_utils.hpp"
 #include "data/unit_conversions.hpp"
-#include "engine/motion_smoothing.hpp"
 #include "engine/random_number_generator.hpp"
 #include "renderer/renderer.hpp"
 
 #include <algorithm>
 #include <array>
 #include <cassert>
-#include <functional>
-#include <memory>
 
 
 namespace rigel::engine
@@ -47,15 +45,19 @@ constexpr std::array<std::int16_t, 44> VERTICAL_MOVEMENT_TABLE{
 
 constexpr auto SPAWN_OFFSET = base::Vec2{0, -1};
 
+constexpr auto FLOATS_PER_VERTEX = 6;
+
+// Enough for a couple of simultaneous explosions without having to grow the
+// storage in the middle of the action
+constexpr auto INITIAL_GROUP_CAPACITY = 32;
+
 
 static_assert(
   INITIAL_INDEX_LIMIT + PARTICLE_SYSTEM_LIFE_TIME <
   VERTICAL_MOVEMENT_TABLE.size());
 
 
-auto yOffsetAtTime(
-  const std::int16_t initialOffsetIndex,
-  const int framesElapsed)
+int yOffsetAtTime(const int initialOffsetIndex, const int framesElapsed)
 {
   assert(
     initialOffsetIndex + framesElapsed <
@@ -67,123 +69,35 @@ auto yOffsetAtTime(
   return baseOffset - VERTICAL_MOVEMENT_TABLE[initialOffsetIndex];
 }
 
-
-struct Particle
-{
-  base::Vec2 offsetAtTime(const int framesElapsed) const
-  {
-    return {
-      mVelocityX * framesElapsed,
-      yOffsetAtTime(mInitialOffsetIndexY, framesElapsed)};
-  }
-
-  std::int16_t mVelocityX;
-  std::int16_t mInitialOffsetIndexY;
-};
-
-
-using ParticlesList = std::array<Particle, 64>;
-
-
-std::unique_ptr<ParticlesList> createParticles(
-  RandomNumberGenerator& randomGenerator,
-  const int velocityScaleX)
-{
-  auto pParticles = std::make_unique<ParticlesList>();
-  for (auto& particle : *pParticles)
-  {
-    const auto randomVariation = randomGenerator.gen() % 20;
-    particle.mVelocityX = static_cast<std::int16_t>(
-      velocityScaleX == 0 ? 10 - randomVariation
-                          : velocityScaleX * (randomVariation + 1));
-    particle.mInitialOffsetIndexY =
-      randomGenerator.gen() % (INITIAL_INDEX_LIMIT + 1);
-  }
-  return pParticles;
-}
-
 } // namespace
 
 
-struct ParticleGroup
-{
-  ParticleGroup(
-    const base::Vec2& origin,
-    const base::Color& color,
-    std::unique_ptr<ParticlesList> pParticles)
-    : mpParticles(std::move(pParticles))
-    , mOrigin(origin)
-    , mColor(color)
-  {
-  }
-
-  ParticleGroup(const ParticleGroup& other)
-    : mpParticles(std::make_unique<ParticlesList>(*other.mpParticles))
-    , mOrigin(other.mOrigin)
-    , mColor(other.mColor)
-  {
-  }
-
-  ParticleGroup& operator=(const ParticleGroup& other)
-  {
-    auto copy = other;
-    std::swap(mpParticles, copy.mpParticles);
-    mOrigin = copy.mOrigin;
-    mColor = copy.mColor;
-    mFramesElapsed = copy.mFramesElapsed;
-    return *this;
-  }
-
-  ParticleGroup(ParticleGroup&&) = default;
-  ParticleGroup& operator=(ParticleGroup&&) = default;
-
-  void update() { ++mFramesElapsed; }
-
-  void render(
-    Renderer& renderer,
-    const base::Vec2& cameraPosition,
-    const float interpolation)
-  {
-    const auto screenSpaceOrigin =
-      data::tilesToPixels(mOrigin - cameraPosition);
-    for (auto& particle : *mpParticles)
-    {
-      const auto currentParticlePosition =
-        particle.offsetAtTime(mFramesElapsed);
-      const auto previousParticlePosition =
-        particle.offsetAtTime(std::max(0, mFramesElapsed - 1));
-
-      const auto particlePosition = lerpRounded(
-        previousParticlePosition, currentParticlePosition, interpolation);
-      renderer.drawPoint(screenSpaceOrigin + particlePosition, mColor);
-    }
-  }
-
-
-  bool isExpired() const { return mFramesElapsed >= PARTICLE_SYSTEM_LIFE_TIME; }
-
-  std::unique_ptr<ParticlesList> mpParticles;
-  base::Vec2 mOrigin;
-  base::Color mColor;
-  int mFramesElapsed = 0;
-};
-
-
 ParticleSystem::ParticleSystem(
   RandomNumberGenerator* pRandomGenerator,
   Renderer* pRenderer)
   : mpRandomGenerator(pRandomGenerator)
   , mpRenderer(pRenderer)
 {
+  mParticleGroups.reserve(INITIAL_GROUP_CAPACITY);
+  mVelocitiesX.reserve(INITIAL_GROUP_CAPACITY * PARTICLES_PER_GROUP);
+  mInitialOffsetIndicesY.reserve(INITIAL_GROUP_CAPACITY * PARTICLES_PER_GROUP);
 }
 
 
 ParticleSystem::~ParticleSystem() = default;
 
 
-void ParticleSystem::synchronizeTo(const ParticleSystem& other)
+ParticleSystem::SavedState ParticleSystem::saveState() const
+{
+  return {mParticleGroups, mVelocitiesX, mInitialOffsetIndicesY};
+}
+
+
+void ParticleSystem::restoreState(const SavedState& state)
 {
-  mParticleGroups = other.mParticleGroups;
+  mParticleGroups = state.mParticleGroups;
+  mVelocitiesX = state.mVelocitiesX;
+  mInitialOffsetIndicesY = state.mInitialOffsetIndicesY;
 }
 
 
@@ -192,25 +106,48 @@ void ParticleSystem::spawnParticles(
   const base::Color& color,
   int velocityScaleX)
 {
-  auto pParticles = createParticles(*mpRandomGenerator, velocityScaleX);
-  mParticleGroups.emplace_back(
-    origin + SPAWN_OFFSET, color, std::move(pParticles));
+  auto& randomGenerator = *mpRandomGenerator;
+
+  // The order of random number generation must remain as it is, since the
+  // generator is shared with the game logic.
+  for (auto i = 0; i < PARTICLES_PER_GROUP; ++i)
+  {
+    const auto randomVariation = randomGenerator.gen() % 20;
+    mVelocitiesX.push_back(static_cast<std::int16_t>(
+      velocityScaleX == 0 ? 10 - randomVariation
+                          : velocityScaleX * (randomVariation + 1)));
+    mInitialOffsetIndicesY.push_back(static_cast<std::int16_t>(
+      randomGenerator.gen() % (INITIAL_INDEX_LIMIT + 1)));
+  }
+
+  mParticleGroups.push_back(ParticleGroup{origin + SPAWN_OFFSET, color});
 }
 
 
 void ParticleSystem::update()
 {
-  using namespace std;
-
-  const auto it = remove_if(
-    begin(mParticleGroups),
-    end(mParticleGroups),
-    mem_fn(&ParticleGroup::isExpired));
-  mParticleGroups.erase(it, end(mParticleGroups));
+  // All groups have the same life time and are appended in the order they
+  // were spawned, so expired groups are always at the front.
+  const auto iFirstLiveGroup = std::find_if(
+    mParticleGroups.begin(),
+    mParticleGroups.end(),
+    [](const ParticleGroup& group) {
+      return group.mFramesElapsed < PARTICLE_SYSTEM_LIFE_TIME;
+    });
+  const auto numExpiredParticles =
+    std::distance(mParticleGroups.begin(), iFirstLiveGroup) *
+    PARTICLES_PER_GROUP;
+
+  mParticleGroups.erase(mParticleGroups.begin(), iFirstLiveGroup);
+  mVelocitiesX.erase(
+    mVelocitiesX.begin(), mVelocitiesX.begin() + numExpiredParticles);
+  mInitialOffsetIndicesY.erase(
+    mInitialOffsetIndicesY.begin(),
+    mInitialOffsetIndicesY.begin() + numExpiredParticles);
 
   for (auto& group : mParticleGroups)
   {
-    group.update();
+    ++group.mFramesElapsed;
   }
 }
 
@@ -219,10 +156,67 @@ void ParticleSystem::render(
   const base::Vec2& cameraPosition,
   const float interpolation)
 {
-  for (auto& group : mParticleGroups)
+  if (mParticleGroups.empty())
   {
-    group.render(*mpRenderer, cameraPosition, interpolation);
+    return;
   }
+
+  mpRenderer->drawPoints(computeVertices(cameraPosition, interpolation));
+}
+
+
+base::ArrayView<float> ParticleSystem::computeVertices(
+  const base::Vec2& cameraPosition,
+  const float interpolation)
+{
+  mVertices.resize(numParticles() * FLOATS_PER_VERTEX);
+
+  auto pVertex = mVertices.data();
+  auto pVelocityX = mVelocitiesX.data();
+  auto pOffsetIndexY = mInitialOffsetIndicesY.data();
+
+  for (const auto& group : mParticleGroups)
+  {
+    const auto framesElapsed = group.mFramesElapsed;
+    const auto previousFramesElapsed = std::max(0, framesElapsed - 1);
+    const auto screenSpaceOrigin =
+      data::tilesToPixels(group.mOrigin - cameraPosition);
+
+    const auto r = group.mColor.r / 255.0f;
+    const auto g = group.mColor.g / 255.0f;
+    const auto b = group.mColor.b / 255.0f;
+    const auto a = group.mColor.a / 255.0f;
+
+    // Plain loop over flat arrays without any branches, to give the compiler
+    // a chance to vectorize it
+    for (auto i = 0; i < PARTICLES_PER_GROUP; ++i)
+    {
+      const auto velocityX = int(pVelocityX[i]);
+      const auto offsetIndexY = int(pOffsetIndexY[i]);
+
+      const auto x = base::lerp(
+        float(velocityX * previousFramesElapsed),
+        float(velocityX * framesElapsed),
+        interpolation);
+      const auto y = base::lerp(
+        float(yOffsetAtTime(offsetIndexY, previousFramesElapsed)),
+        float(yOffsetAtTime(offsetIndexY, framesElapsed)),
+        interpolation);
+
+      pVertex[0] = float(screenSpaceOrigin.x + base::round(x));
+      pVertex[1] = float(screenSpaceOrigin.y + base::round(y));
+      pVertex[2] = r;
+      pVertex[3] = g;
+      pVertex[4] = b;
+      pVertex[5] = a;
+      pVertex += FLOATS_PER_VERTEX;
+    }
+
+    pVelocityX += PARTICLES_PER_GROUP;
+    pOffsetIndexY += PARTICLES_PER_GROUP;
+  }
+
+  return {mVertices.data(), mVertices.size()};
 }
 
 } // namespace rigel::engine
@@ -16,9 +16,12 @@
 
 #pragma once
 
+#include "base/array_view.hpp"
 #include "base/color.hpp"
 #include "base/spatial_types.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace rigel::renderer
@@ -32,18 +35,41 @@ namespace rigel::engine
 
 class RandomNumberGenerator;
 
-struct ParticleGroup;
-
 
+/** Simulates and renders particle effects
+ *
+ * Particles are spawned in groups of PARTICLES_PER_GROUP, all sharing the
+ * same origin, color and age. Per-particle data is stored as a structure of
+ * arrays, and a particle's position is a function of its age, so updating
+ * only needs to touch the groups. Rendering turns all live particles into a
+ * single stream of point vertices, which is then drawn in one batch.
+ */
 class ParticleSystem
 {
 public:
+  static constexpr auto PARTICLES_PER_GROUP = 64;
+
+  struct ParticleGroup
+  {
+    base::Vec2 mOrigin;
+    base::Color mColor;
+    int mFramesElapsed = 0;
+  };
+
+  struct SavedState
+  {
+    std::vector<ParticleGroup> mParticleGroups;
+    std::vector<std::int16_t> mVelocitiesX;
+    std::vector<std::int16_t> mInitialOffsetIndicesY;
+  };
+
   ParticleSystem(
     RandomNumberGenerator* pRandomGenerator,
     renderer::Renderer* pRenderer);
   ~ParticleSystem();
 
-  void synchronizeTo(const ParticleSystem& other);
+  SavedState saveState() const;
+  void restoreState(const SavedState& state);
 
   void spawnParticles(
     const base::Vec2& origin,
@@ -53,8 +79,25 @@ public:
   void update();
   void render(const base::Vec2& cameraPosition, float interpolation);
 
+  /** Compute point vertices for all live particles
+   *
+   * This is the CPU side of render(). The result uses the vertex format
+   * expected by renderer::Renderer::drawPoints(), and remains valid until
+   * the next call.
+   */
+  base::ArrayView<float>
+    computeVertices(const base::Vec2& cameraPosition, float interpolation);
+
+  std::size_t numParticles() const { return mVelocitiesX.size(); }
+
 private:
   std::vector<ParticleGroup> mParticleGroups;
+
+  // Per-particle data, PARTICLES_PER_GROUP consecutive entries per group
+  std::vector<std::int16_t> mVelocitiesX;
+  std::vector<std::int16_t> mInitialOffsetIndicesY;
+
+  std::vector<float> mVertices;
   RandomNumberGenerator* mpRandomGenerator;
   renderer::Renderer* mpRenderer;
 };
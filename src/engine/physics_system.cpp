@@ -46,15 +46,27 @@ PhysicsSystem::PhysicsSystem(
 
 void PhysicsSystem::update(ex::EntityManager& es)
 {
-  es.each<MovingBody, WorldPosition, BoundingBox, components::Active>(
-    [this](
-      ex::Entity entity,
-      MovingBody& body,
-      WorldPosition& position,
-      const BoundingBox& collisionRect,
-      const components::Active&) {
+  if (!mBodies)
+  {
+    mBodies.emplace(es, *mpEvents);
+    mpEntities = &es;
+  }
+
+  assert(mpEntities == &es);
+
+  // The Active tag changes frequently, so it's not part of the group.
+  // Checking it here still visits entities in the same order as iterating
+  // over all four components via the entity manager.
+  mBodies->each([this](
+                  ex::Entity entity,
+                  MovingBody& body,
+                  WorldPosition& position,
+                  const BoundingBox& collisionRect) {
+    if (entity.has_component<components::Active>())
+    {
       applyPhysics(entity, body, position, collisionRect);
-    });
+    }
+  });
 }
 
 
@@ -105,7 +117,17 @@ void PhysicsSystem::applyPhysics(
 
   setTag<components::CollidedWithWorld>(entity, result.has_value());
 
-  if (result)
+  if (!result)
+  {
+    return;
+  }
+
+  if (mCollisionEventMode == CollisionEventMode::Deferred)
+  {
+    mCollisionEvents.push(
+      entity, result->mLeft, result->mRight, result->mTop, result->mBottom);
+  }
+  else
   {
     mpEvents->emit(events::CollidedWithWorld{
       entity, result->mLeft, result->mRight, result->mTop, result->mBottom});
@@ -113,6 +135,26 @@ void PhysicsSystem::applyPhysics(
 }
 
 
+void PhysicsSystem::flushCollisionEvents()
+{
+  mCollisionEvents.flush(*mpEvents, [](const events::CollidedWithWorld& event) {
+    return event.mEntity.valid();
+  });
+}
+
+
+void PhysicsSystem::setCollisionEventMode(const CollisionEventMode mode)
+{
+  if (mode == CollisionEventMode::Immediate)
+  {
+    // Don't leave any events behind which would otherwise never be delivered
+    flushCollisionEvents();
+  }
+
+  mCollisionEventMode = mode;
+}
+
+
 void PhysicsSystem::receive(
   const entityx::ComponentAddedEvent<components::MovingBody>& event)
 {
@@ -19,6 +19,8 @@
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 #include "engine/base_components.hpp"
+#include "engine/component_group.hpp"
+#include "engine/event_queue.hpp"
 #include "engine/physical_components.hpp"
 
 RIGEL_DISABLE_WARNINGS
@@ -26,6 +28,7 @@ RIGEL_DISABLE_WARNINGS
 RIGEL_RESTORE_WARNINGS
 
 #include <cstdint>
+#include <optional>
 #include <tuple>
 
 
@@ -62,6 +65,18 @@ class CollisionChecker;
 class PhysicsSystem : public entityx::Receiver<PhysicsSystem>
 {
 public:
+  enum class CollisionEventMode
+  {
+    // Emit CollidedWithWorld events as soon as a collision happens, so
+    // receivers run before the next entity is moved.
+    Immediate,
+
+    // Queue the events and deliver them all at once when calling
+    // flushCollisionEvents(). Events for entities which have been destroyed
+    // in the meantime are dropped.
+    Deferred
+  };
+
   PhysicsSystem(
     const engine::CollisionChecker* pCollisionChecker,
     const data::map::Map* pMap,
@@ -90,6 +105,15 @@ public:
    */
   void updatePhase2(entityx::EntityManager& es);
 
+  /** Deliver collision events queued since the last flush
+   *
+   * Does nothing in immediate mode.
+   */
+  void flushCollisionEvents();
+
+  void setCollisionEventMode(CollisionEventMode mode);
+  CollisionEventMode collisionEventMode() const { return mCollisionEventMode; }
+
   void
     receive(const entityx::ComponentAddedEvent<components::MovingBody>& event);
   void receive(
@@ -102,10 +126,21 @@ private:
     components::WorldPosition& position,
     const components::BoundingBox& collisionRect);
 
+  using BodyGroup = ComponentGroup<
+    components::MovingBody,
+    components::WorldPosition,
+    components::BoundingBox>;
+
+  // Created on first update, since the entity manager isn't known before
+  std::optional<BodyGroup> mBodies;
+  entityx::EntityManager* mpEntities = nullptr;
+
+  EventQueue<events::CollidedWithWorld> mCollisionEvents;
   std::vector<entityx::Entity> mPhysicsObjectsForPhase2;
   const CollisionChecker* mpCollisionChecker;
   const data::map::Map* mpMap;
   entityx::EventManager* mpEvents;
+  CollisionEventMode mCollisionEventMode = CollisionEventMode::Immediate;
   bool mShouldCollectForPhase2 = false;
 };
 
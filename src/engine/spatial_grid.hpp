@@ -0,0 +1,193 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/spatial_types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+namespace rigel::engine
+{
+
+/** Uniform grid for broad-phase intersection tests
+ *
+ * Divides the world into square cells of a fixed size (in tiles). Each item
+ * is stored in all cells that are overlapped by its bounding box. Querying
+ * an area then only needs to look at the items stored in the cells
+ * overlapped by that area, instead of at all items.
+ *
+ * Query results are candidates: They can contain items which don't actually
+ * intersect the query area, and an item spanning multiple cells is reported
+ * once per cell. Clients are expected to do exact intersection tests on the
+ * results.
+ *
+ * Cells are created on demand, so the grid doesn't need to know the size of
+ * the map, and items can also be located outside of the map. Clearing the
+ * grid keeps the memory allocated for the cells, which makes it cheap to
+ * rebuild the grid from scratch every frame.
+ */
+template <typename T>
+class SpatialGrid
+{
+public:
+  static constexpr auto DEFAULT_CELL_SIZE = 4;
+
+  explicit SpatialGrid(const int cellSize = DEFAULT_CELL_SIZE)
+    : mCellSize(cellSize)
+  {
+    assert(cellSize > 0);
+  }
+
+  void insert(const T& item, const base::Rect<int>& bounds)
+  {
+    forEachCell(bounds, [&](const CellKey key) {
+      mCells[key].push_back(item);
+    });
+    ++mSize;
+  }
+
+  /** Remove an item
+   *
+   * The given bounds must be the same as those used when inserting the item.
+   */
+  void remove(const T& item, const base::Rect<int>& bounds)
+  {
+    forEachCell(bounds, [&](const CellKey key) {
+      const auto iCell = mCells.find(key);
+      if (iCell == mCells.end())
+      {
+        return;
+      }
+
+      auto& items = iCell->second;
+      const auto it = std::find(items.begin(), items.end(), item);
+      if (it != items.end())
+      {
+        // Order within a cell doesn't matter, so we can avoid shifting
+        // the remaining elements.
+        *it = std::move(items.back());
+        items.pop_back();
+      }
+    });
+
+    assert(mSize > 0);
+    --mSize;
+  }
+
+  /** Update an item's bounds
+   *
+   * oldBounds must be the bounds currently used for the item. If the item
+   * still overlaps the same cells afterwards, which is the common case for
+   * small movements, this doesn't need to touch the cells at all.
+   */
+  void move(
+    const T& item,
+    const base::Rect<int>& oldBounds,
+    const base::Rect<int>& newBounds)
+  {
+    if (cellRange(oldBounds) == cellRange(newBounds))
+    {
+      return;
+    }
+
+    remove(item, oldBounds);
+    insert(item, newBounds);
+  }
+
+  void clear()
+  {
+    for (auto& [key, items] : mCells)
+    {
+      items.clear();
+    }
+
+    mSize = 0;
+  }
+
+  std::size_t size() const { return mSize; }
+
+  /** Invoke callback for each item in the cells overlapped by area */
+  template <typename Callback>
+  void forEachCandidate(const base::Rect<int>& area, Callback&& callback) const
+  {
+    forEachCell(area, [&](const CellKey key) {
+      const auto iCell = mCells.find(key);
+      if (iCell != mCells.end())
+      {
+        for (const auto& item : iCell->second)
+        {
+          callback(item);
+        }
+      }
+    });
+  }
+
+private:
+  using CellKey = std::uint64_t;
+
+  int cellCoordinate(const int tileCoordinate) const
+  {
+    // Round towards negative infinity, so that negative coordinates
+    // end up in the right cell
+    return tileCoordinate >= 0 ? tileCoordinate / mCellSize
+                               : (tileCoordinate + 1) / mCellSize - 1;
+  }
+
+  static CellKey makeKey(const int cellX, const int cellY)
+  {
+    return (CellKey(std::uint32_t(cellX)) << 32) | std::uint32_t(cellY);
+  }
+
+  /** First and last cell coordinates overlapped by bounds
+   *
+   * In the order first x, first y, last x, last y.
+   */
+  std::array<int, 4> cellRange(const base::Rect<int>& bounds) const
+  {
+    return {
+      cellCoordinate(bounds.left()),
+      cellCoordinate(bounds.top()),
+      cellCoordinate(std::max(bounds.left(), bounds.right())),
+      cellCoordinate(std::max(bounds.top(), bounds.bottom()))};
+  }
+
+  template <typename Func>
+  void forEachCell(const base::Rect<int>& bounds, Func&& func) const
+  {
+    const auto [firstX, firstY, lastX, lastY] = cellRange(bounds);
+
+    for (auto y = firstY; y <= lastY; ++y)
+    {
+      for (auto x = firstX; x <= lastX; ++x)
+      {
+        func(makeKey(x, y));
+      }
+    }
+  }
+
+  std::unordered_map<CellKey, std::vector<T>> mCells;
+  int mCellSize;
+  std::size_t mSize = 0;
+};
+
+} // namespace rigel::engine
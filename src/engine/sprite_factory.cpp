@@ -18,9 +18,14 @@
 
 #include "assets/resource_loader.hpp"
 #include "base/container_utils.hpp"
+#include "base/math_utils.hpp"
 #include "data/unit_conversions.hpp"
 
+#include <algorithm>
 #include <array>
+#include <future>
+#include <iterator>
+#include <thread>
 
 
 namespace rigel::engine
@@ -799,6 +804,46 @@ int adjustedDrawOrder(const ActorID id, const int baseDrawOrder)
   }
 }
 
+
+/** Loads all parts of all in-game sprite actors, in order
+ *
+ * Decoding the actor images makes up most of the work of setting up the
+ * SpriteFactory, so we distribute it across worker threads.
+ */
+std::vector<assets::ActorData>
+  loadAllActorParts(const assets::ResourceLoader& resources)
+{
+  std::vector<ActorID> allPartIds;
+  for (const auto mainId : INGAME_SPRITE_ACTOR_IDS)
+  {
+    const auto partIds = actorIDListForActor(mainId);
+    allPartIds.insert(allPartIds.end(), partIds.begin(), partIds.end());
+  }
+
+  const auto numParts = int(allPartIds.size());
+  const auto numWorkers =
+    int(std::max(std::thread::hardware_concurrency(), 1u));
+  const auto partsPerWorker = base::integerDivCeil(numParts, numWorkers);
+
+  std::vector<std::future<std::vector<assets::ActorData>>> pendingResults;
+  for (auto first = 0; first < numParts; first += partsPerWorker)
+  {
+    const auto last = std::min(first + partsPerWorker, numParts);
+    pendingResults.push_back(resources.loadActorsAsync(
+      {allPartIds.begin() + first, allPartIds.begin() + last}));
+  }
+
+  std::vector<assets::ActorData> result;
+  result.reserve(allPartIds.size());
+  for (auto& pendingResult : pendingResults)
+  {
+    auto actors = pendingResult.get();
+    std::move(actors.begin(), actors.end(), std::back_inserter(result));
+  }
+
+  return result;
+}
+
 } // namespace
 
 
@@ -862,6 +907,10 @@ auto SpriteFactory::construct(
   std::vector<data::Image> spriteImages;
   spriteImages.reserve(INGAME_SPRITE_ACTOR_IDS.size());
 
+  // non-const so we can move the Image objects into the vector
+  auto allActorParts = loadAllActorParts(*pResourceLoader);
+  auto iActorData = allActorParts.begin();
+
   for (const auto mainId : INGAME_SPRITE_ACTOR_IDS)
   {
     engine::SpriteDrawData drawData;
@@ -870,17 +919,10 @@ auto SpriteFactory::construct(
     int lastFrameCount = 0;
     std::vector<int> framesToRender;
 
-    const auto actorPartIds = actorIDListForActor(mainId);
-
-    // non-const so we can move the Image objects into the vector
-    auto actorParts =
-      utils::transformed(actorPartIds, [&](const ActorID partId) {
-        return pResourceLoader->loadActor(partId);
-      });
-
-    // Similarly, non-const for move semantics
-    for (auto& actorData : actorParts)
+    const auto numActorParts = actorIDListForActor(mainId).size();
+    for (auto i = 0u; i < numActorParts; ++i, ++iActorData)
     {
+      auto& actorData = *iActorData;
       lastDrawOrder = actorData.mDrawIndex;
 
       // Similarly, non-const for move semantics
@@ -918,10 +960,12 @@ auto SpriteFactory::construct(
       mainId, SpriteData{std::move(drawData), std::move(framesToRender)});
   }
 
+  auto textureAtlas = pRenderer
+    ? std::make_optional<renderer::TextureAtlas>(pRenderer, spriteImages)
+    : std::nullopt;
+
   return {
-    std::move(spriteDataMap),
-    renderer::TextureAtlas{pRenderer, spriteImages},
-    highResReplacementsFound};
+    std::move(spriteDataMap), std::move(textureAtlas), highResReplacementsFound};
 }
 
 
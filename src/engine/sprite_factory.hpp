@@ -20,6 +20,7 @@
 #include "engine/isprite_factory.hpp"
 #include "renderer/texture_atlas.hpp"
 
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
@@ -52,6 +53,13 @@ bool hasAssociatedSprite(data::ActorID actorID);
 class SpriteFactory : public ISpriteFactory
 {
 public:
+  /** Load all in-game sprites
+   *
+   * pRenderer can be nullptr, in which case only the sprite metadata
+   * (frame sizes, offsets, draw orders etc.) is loaded. This is sufficient
+   * for running game logic in headless mode, but textureAtlas() must not
+   * be used in that case.
+   */
   SpriteFactory(
     renderer::Renderer* pRenderer,
     const assets::ResourceLoader* pResourceLoader);
@@ -64,7 +72,7 @@ public:
 
   const renderer::TextureAtlas& textureAtlas() const
   {
-    return mSpritesTextureAtlas;
+    return *mSpritesTextureAtlas;
   }
 
 private:
@@ -76,7 +84,7 @@ private:
 
   using CtorArgs = std::tuple<
     std::unordered_map<data::ActorID, SpriteData>,
-    renderer::TextureAtlas,
+    std::optional<renderer::TextureAtlas>,
     bool>;
 
   SpriteFactory(CtorArgs args);
@@ -85,7 +93,7 @@ private:
     const assets::ResourceLoader* pResourceLoader);
 
   std::unordered_map<data::ActorID, SpriteData> mSpriteDataMap;
-  renderer::TextureAtlas mSpritesTextureAtlas;
+  std::optional<renderer::TextureAtlas> mSpritesTextureAtlas;
   bool mHasHighResReplacements;
 };
 
@@ -21,11 +21,17 @@
 #include "engine/motion_smoothing.hpp"
 #include "engine/sprite_tools.hpp"
 #include "engine/visual_components.hpp"
+#include "renderer/custom_quad_batch.hpp"
+#include "renderer/shader.hpp"
 #include "renderer/texture_atlas.hpp"
 #include "renderer/upscaling.hpp"
 
 #include <algorithm>
+#include <array>
 #include <functional>
+#include <limits>
+#include <numeric>
+#include <tuple>
 
 
 namespace ex = entityx;
@@ -45,6 +51,227 @@ using components::WorldPosition;
 namespace
 {
 
+// Draw orders produced by the sprite factory span a small range, which allows
+// sorting with a counting sort. Should an unexpectedly large range show up,
+// we fall back to a comparison sort to keep memory use for the buckets
+// bounded.
+constexpr auto MAX_DRAW_ORDER_RANGE = 256;
+
+// Sprites with the same texture are drawn in a single draw call, up to this
+// many at once.
+constexpr auto MAX_SPRITES_PER_BATCH = 4096;
+
+constexpr auto FLOATS_PER_SPRITE_VERTEX = 5;
+constexpr auto FLOATS_PER_SPRITE = FLOATS_PER_SPRITE_VERTEX * 4;
+
+
+// Same as the standard textured quad shader, but with the white flash
+// effect applied per vertex instead of via a uniform. This makes it possible
+// to draw sprites which are flashing white in the same batch as other
+// sprites. The renderer's own textured quad state (color modulation, overlay
+// color, texture repeat) is mirrored via uniforms, see submitBatch().
+#ifdef __vita__
+const char* VERTEX_SOURCE_SPRITE = R"shd(
+uniform float4x4 transform;
+
+void main(
+  float2 position,
+  float2 texCoord,
+  float overlayAmount,
+  float4 out gl_Position : POSITION,
+  float2 out texCoordFrag : TEXCOORD0,
+  float out overlayAmountFrag : TEXCOORD1
+) {
+  gl_Position = mul(float4(position, 0.0, 1.0), transform);
+  texCoordFrag = float2(texCoord.x, 1.0 - texCoord.y);
+  overlayAmountFrag = overlayAmount;
+}
+)shd";
+
+const char* FRAGMENT_SOURCE_SPRITE = R"shd(
+uniform sampler2D textureData;
+uniform float4 flashColor;
+uniform float4 overlayColor;
+
+uniform float4 colorModulation;
+uniform bool enableRepeat;
+
+float4 main(
+  float2 texCoordFrag : TEXCOORD0,
+  float overlayAmountFrag : TEXCOORD1
+) {
+  float2 texCoords = texCoordFrag;
+  if (enableRepeat) {
+    texCoords.x = frac(texCoords.x);
+    texCoords.y = frac(texCoords.y);
+  }
+
+  float4 baseColor = TEXTURE_LOOKUP(textureData, texCoords);
+  float4 modulated = baseColor * colorModulation;
+  float3 withOverlay =
+    lerp(modulated.rgb, overlayColor.rgb, overlayColor.a);
+
+  return float4(
+    lerp(withOverlay, flashColor.rgb, overlayAmountFrag), modulated.a);
+}
+)shd";
+#else
+const char* VERTEX_SOURCE_SPRITE = R"shd(
+ATTRIBUTE HIGHP vec2 position;
+ATTRIBUTE HIGHP vec2 texCoord;
+ATTRIBUTE float overlayAmount;
+
+OUT HIGHP vec2 texCoordFrag;
+OUT float overlayAmountFrag;
+
+uniform mat4 transform;
+
+void main() {
+  gl_Position = transform * vec4(position, 0.0, 1.0);
+  texCoordFrag = vec2(texCoord.x, 1.0 - texCoord.y);
+  overlayAmountFrag = overlayAmount;
+}
+)shd";
+
+const char* FRAGMENT_SOURCE_SPRITE = R"shd(
+DEFAULT_PRECISION_DECLARATION
+OUTPUT_COLOR_DECLARATION
+
+IN HIGHP vec2 texCoordFrag;
+IN float overlayAmountFrag;
+
+uniform sampler2D textureData;
+uniform vec4 flashColor;
+uniform vec4 overlayColor;
+
+uniform vec4 colorModulation;
+uniform bool enableRepeat;
+
+void main() {
+  HIGHP vec2 texCoords = texCoordFrag;
+  if (enableRepeat) {
+    texCoords.x = fract(texCoords.x);
+    texCoords.y = fract(texCoords.y);
+  }
+
+  vec4 baseColor = TEXTURE_LOOKUP(textureData, texCoords);
+  vec4 modulated = baseColor * colorModulation;
+  vec3 withOverlay = mix(modulated.rgb, overlayColor.rgb, overlayColor.a);
+
+  OUTPUT_COLOR =
+    vec4(mix(withOverlay, flashColor.rgb, overlayAmountFrag), modulated.a);
+}
+)shd";
+#endif
+
+
+constexpr auto SPRITE_TEXTURE_UNIT_NAMES = std::array{"textureData"};
+
+const renderer::ShaderSpec SPRITE_SHADER{
+  renderer::VertexLayout::PositionTexCoordsAndOverlay,
+  SPRITE_TEXTURE_UNIT_NAMES,
+  VERTEX_SOURCE_SPRITE,
+  FRAGMENT_SOURCE_SPRITE};
+
+
+void appendSpriteVertices(
+  std::vector<float>& vertices,
+  const renderer::TexCoords& texCoords,
+  const base::Rect<int>& destRect,
+  const float overlayAmount)
+{
+  const auto left = float(destRect.topLeft.x);
+  const auto right = float(destRect.topLeft.x + destRect.size.width);
+  const auto top = float(destRect.topLeft.y);
+  const auto bottom = float(destRect.topLeft.y + destRect.size.height);
+
+  // clang-format off
+  const float quadVertices[] = {
+    left,  bottom, texCoords.left,  texCoords.bottom, overlayAmount,
+    left,  top,    texCoords.left,  texCoords.top,    overlayAmount,
+    right, bottom, texCoords.right, texCoords.bottom, overlayAmount,
+    right, top,    texCoords.right, texCoords.top,    overlayAmount,
+  };
+  // clang-format on
+
+  vertices.insert(
+    vertices.end(), std::begin(quadVertices), std::end(quadVertices));
+}
+
+
+/** Sorts sprites by (draw topmost, draw order), preserving submission order
+ * for sprites with identical keys.
+ *
+ * Writes the result to output, and returns the number of sprites which are
+ * not drawn topmost.
+ */
+std::size_t sortByDrawOrder(
+  std::vector<SortableDrawSpec>& input,
+  std::vector<SpriteDrawSpec>& output,
+  std::vector<std::size_t>& bucketOffsets)
+{
+  using std::begin;
+  using std::end;
+
+  output.clear();
+
+  if (input.empty())
+  {
+    return 0;
+  }
+
+  const auto [iMin, iMax] = std::minmax_element(
+    begin(input),
+    end(input),
+    [](const SortableDrawSpec& lhs, const SortableDrawSpec& rhs) {
+      return lhs.mDrawOrder < rhs.mDrawOrder;
+    });
+  const auto minDrawOrder = iMin->mDrawOrder;
+  const auto range = std::size_t(iMax->mDrawOrder - minDrawOrder) + 1;
+
+  if (range > MAX_DRAW_ORDER_RANGE)
+  {
+    std::stable_sort(begin(input), end(input));
+
+    output.reserve(input.size());
+    std::transform(
+      begin(input),
+      end(input),
+      std::back_inserter(output),
+      [](const SortableDrawSpec& sortableSpec) { return sortableSpec.mSpec; });
+
+    const auto iFirstTopMostSprite = std::find_if(
+      begin(input), end(input), std::mem_fn(&SortableDrawSpec::mDrawTopMost));
+    return std::size_t(std::distance(begin(input), iFirstTopMostSprite));
+  }
+
+  // Topmost sprites go into a second set of buckets following the regular
+  // ones, so that they end up after all regular sprites.
+  auto bucketIndex = [&](const SortableDrawSpec& sortableSpec) {
+    return std::size_t(sortableSpec.mDrawOrder - minDrawOrder) +
+      (sortableSpec.mDrawTopMost ? range : 0);
+  };
+
+  bucketOffsets.assign(range * 2 + 1, 0);
+  for (const auto& sortableSpec : input)
+  {
+    ++bucketOffsets[bucketIndex(sortableSpec) + 1];
+  }
+
+  std::partial_sum(
+    begin(bucketOffsets), end(bucketOffsets), begin(bucketOffsets));
+  const auto numRegularSprites = bucketOffsets[range];
+
+  output.resize(input.size());
+  for (const auto& sortableSpec : input)
+  {
+    output[bucketOffsets[bucketIndex(sortableSpec)]++] = sortableSpec.mSpec;
+  }
+
+  return numRegularSprites;
+}
+
+
 void advanceAnimation(Sprite& sprite, AnimationLoop& animated)
 {
   const auto numFrames = static_cast<int>(sprite.mpDrawData->mFrames.size());
@@ -68,8 +295,46 @@ void advanceAnimation(Sprite& sprite, AnimationLoop& animated)
 }
 
 
+bool comesBefore(const ex::Entity& lhs, const ex::Entity& rhs)
+{
+  return std::make_tuple(lhs.id().index(), lhs.id().version()) <
+    std::make_tuple(rhs.id().index(), rhs.id().version());
+}
+
+
+/** Bounding box of all of the sprite's frames, relative to its position */
+base::Rect<int> frameExtents(const SpriteDrawData& drawData)
+{
+  if (drawData.mFrames.empty())
+  {
+    return {};
+  }
+
+  using Limits = std::numeric_limits<int>;
+
+  auto topLeft = base::Vec2{Limits::max(), Limits::max()};
+  auto bottomRight = base::Vec2{Limits::min(), Limits::min()};
+
+  for (const auto& frame : drawData.mFrames)
+  {
+    // See drawPosition() in collectVisibleSprites()
+    const auto frameTopLeft =
+      frame.mDrawOffset - base::Vec2{0, frame.mDimensions.height - 1};
+    const auto frameBottomRight = frameTopLeft +
+      base::Vec2{frame.mDimensions.width, frame.mDimensions.height};
+
+    topLeft.x = std::min(topLeft.x, frameTopLeft.x);
+    topLeft.y = std::min(topLeft.y, frameTopLeft.y);
+    bottomRight.x = std::max(bottomRight.x, frameBottomRight.x);
+    bottomRight.y = std::max(bottomRight.y, frameBottomRight.y);
+  }
+
+  return base::makeRect(topLeft, bottomRight);
+}
+
+
 void collectVisibleSprites(
-  ex::EntityManager& es,
+  const std::vector<ex::Entity>& entities,
   const base::Vec2& cameraPosition,
   const base::Size& viewportSize,
   std::vector<SortableDrawSpec>& output,
@@ -122,7 +387,7 @@ void collectVisibleSprites(
   };
 
 
-  es.each<Sprite, WorldPosition>(
+  auto collect =
     [&](
       ex::Entity entity, const Sprite& sprite, const WorldPosition& position) {
       if (!sprite.mShow)
@@ -214,7 +479,24 @@ void collectVisibleSprites(
           SpriteDrawSpec{destRect, frame.mImageId, false, useCloakEffect};
         output.push_back({drawSpec, drawOrder, drawTopmost});
       }
-    });
+    };
+
+
+  for (auto entity : entities)
+  {
+    // Entities might have been destroyed since the index was last updated
+    if (
+      !entity.valid() || !entity.has_component<Sprite>() ||
+      !entity.has_component<WorldPosition>())
+    {
+      continue;
+    }
+
+    collect(
+      entity,
+      *entity.component<const Sprite>(),
+      *entity.component<const WorldPosition>());
+  }
 }
 
 } // namespace
@@ -309,43 +591,215 @@ void updateAnimatedSprites(ex::EntityManager& es)
 
 SpriteRenderingSystem::SpriteRenderingSystem(
   renderer::Renderer* pRenderer,
-  const renderer::TextureAtlas* pTextureAtlas)
+  const renderer::TextureAtlas* pTextureAtlas,
+  ex::EntityManager& entities,
+  ex::EventManager& eventManager)
   : mpRenderer(pRenderer)
   , mpTextureAtlas(pTextureAtlas)
 {
+  using components::ExtendedFrameList;
+  using components::SpriteStrip;
+
+  entities.each<Sprite, WorldPosition>(
+    [this](ex::Entity entity, const Sprite&, const WorldPosition&) {
+      markForReindexing(entity);
+    });
+
+  eventManager.subscribe<ex::ComponentAddedEvent<Sprite>>(*this);
+  eventManager.subscribe<ex::ComponentRemovedEvent<Sprite>>(*this);
+  eventManager.subscribe<ex::ComponentAddedEvent<WorldPosition>>(*this);
+  eventManager.subscribe<ex::ComponentRemovedEvent<WorldPosition>>(*this);
+  eventManager.subscribe<ex::ComponentAddedEvent<SpriteStrip>>(*this);
+  eventManager.subscribe<ex::ComponentRemovedEvent<SpriteStrip>>(*this);
+  eventManager.subscribe<ex::ComponentAddedEvent<ExtendedFrameList>>(*this);
+  eventManager.subscribe<ex::ComponentRemovedEvent<ExtendedFrameList>>(
+    *this);
+
+  // The system is also used without a renderer, e.g. in benchmarks
+  if (mpRenderer)
+  {
+    mSpriteShader.emplace(SPRITE_SHADER);
+
+    const auto& flashColor = data::GameTraits::INGAME_PALETTE[15];
+    const auto guard = renderer::useTemporarily(*mSpriteShader);
+    mSpriteShader->setUniform(
+      "flashColor",
+      glm::vec4{flashColor.r, flashColor.g, flashColor.b, flashColor.a} /
+        255.0f);
+  }
+}
+
+
+void SpriteRenderingSystem::markForReindexing(const ex::Entity entity)
+{
+  const auto index = entity.id().index();
+  if (index >= mIndexEntries.size())
+  {
+    mIndexEntries.resize(index + 1);
+  }
+
+  // Component removal events are emitted while the component is still
+  // assigned, so looking at the entity has to wait until the next update
+  auto& entry = mIndexEntries[index];
+  entry.mPendingEntity = entity;
+  if (!entry.mNeedsReindexing)
+  {
+    entry.mNeedsReindexing = true;
+    mSlotsToReindex.push_back(index);
+  }
+}
+
+
+void SpriteRenderingSystem::updateSpatialIndex()
+{
+  for (const auto index : mSlotsToReindex)
+  {
+    reindex(mIndexEntries[index]);
+  }
+
+  mSlotsToReindex.clear();
+
+  if (!mSpatialIndexIsStale)
+  {
+    return;
+  }
+
+  for (const auto index : mIndexedSlots)
+  {
+    updateBounds(mIndexEntries[index]);
+  }
+
+  mSpatialIndexIsStale = false;
+}
+
+
+void SpriteRenderingSystem::reindex(IndexEntry& entry)
+{
+  using components::ExtendedFrameList;
+  using components::SpriteStrip;
+
+  entry.mNeedsReindexing = false;
+  unindex(entry);
+
+  auto entity = entry.mPendingEntity;
+  entry.mEntity = entity;
+  entry.mpSprite = nullptr;
+  entry.mpPosition = nullptr;
+  entry.mpDrawData = nullptr;
+
+  if (
+    !entity.valid() || !entity.has_component<Sprite>() ||
+    !entity.has_component<WorldPosition>())
+  {
+    return;
+  }
+
+  if (
+    entity.has_component<ExtendedFrameList>() ||
+    entity.has_component<SpriteStrip>())
+  {
+    mUnindexedEntities.push_back(entity);
+    entry.mIsUnindexed = true;
+    return;
+  }
+
+  entry.mpSprite = entity.component<const Sprite>().get();
+  entry.mpPosition = entity.component<const WorldPosition>().get();
+
+  entry.mIndexedSlot = std::uint32_t(mIndexedSlots.size());
+  mIndexedSlots.push_back(entity.id().index());
+
+  updateBounds(entry);
+}
+
+
+void SpriteRenderingSystem::updateBounds(IndexEntry& entry)
+{
+  if (entry.mpDrawData != entry.mpSprite->mpDrawData)
+  {
+    entry.mpDrawData = entry.mpSprite->mpDrawData;
+    entry.mFrameExtents = frameExtents(*entry.mpDrawData);
+  }
+
+  const auto bounds = entry.mFrameExtents + *entry.mpPosition;
+
+  if (!entry.mIsIndexed)
+  {
+    mSpatialIndex.insert(entry.mEntity, bounds);
+    entry.mIsIndexed = true;
+  }
+  else if (bounds != entry.mBounds)
+  {
+    mSpatialIndex.move(entry.mEntity, entry.mBounds, bounds);
+  }
+
+  entry.mBounds = bounds;
+}
+
+
+void SpriteRenderingSystem::unindex(IndexEntry& entry)
+{
+  if (entry.mIsIndexed)
+  {
+    mSpatialIndex.remove(entry.mEntity, entry.mBounds);
+    entry.mIsIndexed = false;
+  }
+
+  if (entry.mpSprite)
+  {
+    // Order doesn't matter, so avoid shifting the remaining elements
+    const auto lastIndex = mIndexedSlots.back();
+    mIndexedSlots[entry.mIndexedSlot] = lastIndex;
+    mIndexEntries[lastIndex].mIndexedSlot = entry.mIndexedSlot;
+    mIndexedSlots.pop_back();
+  }
+
+  if (entry.mIsUnindexed)
+  {
+    const auto iEntity = std::find(
+      mUnindexedEntities.begin(), mUnindexedEntities.end(), entry.mEntity);
+    *iEntity = mUnindexedEntities.back();
+    mUnindexedEntities.pop_back();
+    entry.mIsUnindexed = false;
+  }
 }
 
 
 void SpriteRenderingSystem::update(
-  ex::EntityManager& es,
   const base::Size& viewportSize,
   const base::Vec2& cameraPosition,
   const float interpolationFactor)
 {
-  using std::back_inserter;
   using std::begin;
   using std::end;
 
-  mSortBuffer.clear();
-  collectVisibleSprites(
-    es, cameraPosition, viewportSize, mSortBuffer, interpolationFactor);
-  std::stable_sort(begin(mSortBuffer), end(mSortBuffer));
+  updateSpatialIndex();
 
-  mSprites.clear();
-  mSprites.reserve(mSortBuffer.size());
-  std::transform(
-    begin(mSortBuffer),
-    end(mSortBuffer),
-    back_inserter(mSprites),
-    [](const SortableDrawSpec& sortableSpec) { return sortableSpec.mSpec; });
+  mCandidates.clear();
+  mSpatialIndex.forEachCandidate(
+    {cameraPosition, viewportSize},
+    [this](const ex::Entity& entity) { mCandidates.push_back(entity); });
+  mCandidates.insert(
+    end(mCandidates), begin(mUnindexedEntities), end(mUnindexedEntities));
 
-  const auto iFirstTopMostSprite = std::find_if(
-    begin(mSortBuffer),
-    end(mSortBuffer),
-    std::mem_fn(&SortableDrawSpec::mDrawTopMost));
+  // Sprites with equal draw order are drawn in submission order, so we need
+  // to visit entities in the same order as iterating over the entity
+  // manager would.
+  std::sort(begin(mCandidates), end(mCandidates), comesBefore);
+  mCandidates.erase(
+    std::unique(begin(mCandidates), end(mCandidates)), end(mCandidates));
 
-  miForegroundSprites = std::next(
-    begin(mSprites), std::distance(begin(mSortBuffer), iFirstTopMostSprite));
+  mSortBuffer.clear();
+  collectVisibleSprites(
+    mCandidates,
+    cameraPosition,
+    viewportSize,
+    mSortBuffer,
+    interpolationFactor);
+
+  const auto numRegularSprites =
+    sortByDrawOrder(mSortBuffer, mSprites, mBucketOffsets);
+  miForegroundSprites = std::next(begin(mSprites), numRegularSprites);
 
   mCloakEffectSpritesVisible =
     std::any_of(begin(mSprites), end(mSprites), [](const SpriteDrawSpec& spec) {
@@ -357,44 +811,85 @@ void SpriteRenderingSystem::update(
 void SpriteRenderingSystem::renderRegularSprites(
   const SpecialEffectsRenderer& fx) const
 {
-  for (auto it = mSprites.begin(); it != miForegroundSprites; ++it)
-  {
-    renderSprite(*it, fx);
-  }
+  renderSprites(mSprites.begin(), miForegroundSprites, fx);
 }
 
 
 void SpriteRenderingSystem::renderForegroundSprites(
   const SpecialEffectsRenderer& fx) const
 {
-  for (auto it = miForegroundSprites; it != mSprites.end(); ++it)
-  {
-    renderSprite(*it, fx);
-  }
+  renderSprites(miForegroundSprites, mSprites.end(), fx);
 }
 
 
-void SpriteRenderingSystem::renderSprite(
-  const SpriteDrawSpec& spec,
+void SpriteRenderingSystem::renderSprites(
+  const std::vector<SpriteDrawSpec>::const_iterator first,
+  const std::vector<SpriteDrawSpec>::const_iterator last,
   const SpecialEffectsRenderer& fx) const
 {
-  // White flash takes priority over translucency
-  if (spec.mIsFlashingWhite)
-  {
-    const auto saved = renderer::saveState(mpRenderer);
-    mpRenderer->setOverlayColor(data::GameTraits::INGAME_PALETTE[15]);
-    mpTextureAtlas->draw(spec.mImageId, spec.mDestRect);
-  }
-  else if (spec.mUseCloakEffect)
+  for (auto it = first; it != last; ++it)
   {
+    const auto& spec = *it;
     const auto [textureId, texCoords] = mpTextureAtlas->drawData(spec.mImageId);
 
-    fx.drawCloakEffect(textureId, texCoords, spec.mDestRect);
+    // White flash takes priority over translucency. The cloak effect needs
+    // to read back what has been drawn so far, so it interrupts the current
+    // batch.
+    if (spec.mUseCloakEffect && !spec.mIsFlashingWhite)
+    {
+      submitBatch();
+      fx.drawCloakEffect(textureId, texCoords, spec.mDestRect);
+      continue;
+    }
+
+    if (
+      textureId != mBatchTexture ||
+      mBatchVertices.size() >= MAX_SPRITES_PER_BATCH * FLOATS_PER_SPRITE)
+    {
+      submitBatch();
+      mBatchTexture = textureId;
+    }
+
+    appendSpriteVertices(
+      mBatchVertices,
+      texCoords,
+      spec.mDestRect,
+      spec.mIsFlashingWhite ? 1.0f : 0.0f);
   }
-  else
+
+  submitBatch();
+}
+
+
+void SpriteRenderingSystem::submitBatch() const
+{
+  if (mBatchVertices.empty())
   {
-    mpTextureAtlas->draw(spec.mImageId, spec.mDestRect);
+    return;
   }
+
+  // Anything the renderer has batched up so far needs to be drawn with
+  // its own shader, before we switch to ours.
+  mpRenderer->submitBatch();
+
+  const auto toGlColor = [](const base::Color& color) {
+    return glm::vec4{color.r, color.g, color.b, color.a} / 255.0f;
+  };
+
+  mSpriteShader->use();
+  mSpriteShader->setUniform(
+    "transform", renderer::computeTransformationMatrix(mpRenderer));
+  mSpriteShader->setUniform(
+    "colorModulation", toGlColor(mpRenderer->colorModulation()));
+  mSpriteShader->setUniform(
+    "overlayColor", toGlColor(mpRenderer->overlayColor()));
+  mSpriteShader->setUniform(
+    "enableRepeat", mpRenderer->textureRepeatEnabled());
+
+  const auto textures = std::array{mBatchTexture};
+  mpRenderer->drawCustomQuadBatch({textures, mBatchVertices, &*mSpriteShader});
+
+  mBatchVertices.clear();
 }
 
 } // namespace rigel::engine
@@ -19,13 +19,17 @@
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 #include "engine/base_components.hpp"
+#include "engine/spatial_grid.hpp"
 #include "renderer/renderer.hpp"
+#include "renderer/shader.hpp"
 #include "renderer/texture.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstdint>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -40,6 +44,14 @@ namespace rigel::engine
 {
 
 class SpecialEffectsRenderer;
+struct SpriteDrawData;
+
+namespace components
+{
+struct ExtendedFrameList;
+struct Sprite;
+struct SpriteStrip;
+} // namespace components
 
 
 /** Animates sprites with an AnimationLoop component
@@ -75,34 +87,134 @@ struct SortableDrawSpec
 };
 
 
-class SpriteRenderingSystem
+class SpriteRenderingSystem : public entityx::Receiver<SpriteRenderingSystem>
 {
 public:
+  static constexpr auto SPATIAL_INDEX_CELL_SIZE = 8;
+
   SpriteRenderingSystem(
     renderer::Renderer* pRenderer,
-    const renderer::TextureAtlas* pTextureAtlas);
+    const renderer::TextureAtlas* pTextureAtlas,
+    entityx::EntityManager& entities,
+    entityx::EventManager& eventManager);
+
+  SpriteRenderingSystem(const SpriteRenderingSystem&) = delete;
+  SpriteRenderingSystem& operator=(const SpriteRenderingSystem&) = delete;
+
+  /** Mark sprite positions as possibly changed
+   *
+   * update() only looks at entities which are in or near the viewport
+   * according to an index of sprite positions. Sprites appearing and
+   * disappearing are picked up automatically via component events, but
+   * positions are written directly by all kinds of game logic. This
+   * needs to be called whenever sprites might have moved - i.e. after each
+   * game logic update and after restoring a saved state. The next update()
+   * then re-indexes any sprites whose bounds changed.
+   */
+  void invalidateSpatialIndex() { mSpatialIndexIsStale = true; }
 
   void update(
-    entityx::EntityManager& es,
     const base::Size& viewportSize,
     const base::Vec2& cameraPosition,
     float interpolationFactor);
 
   bool cloakEffectSpritesVisible() const { return mCloakEffectSpritesVisible; }
 
+  /** Number of entities looked at by the most recent update() */
+  std::size_t numVisitedEntities() const { return mCandidates.size(); }
+
+  /** Number of sprites collected by the most recent update() */
+  std::size_t numVisibleSprites() const { return mSprites.size(); }
+
   void renderRegularSprites(const SpecialEffectsRenderer& fx) const;
   void renderForegroundSprites(const SpecialEffectsRenderer& fx) const;
 
+  template <typename C>
+  void receive(const entityx::ComponentAddedEvent<C>& event)
+  {
+    markForReindexing(event.entity);
+  }
+
+  template <typename C>
+  void receive(const entityx::ComponentRemovedEvent<C>& event)
+  {
+    markForReindexing(event.entity);
+  }
+
 private:
-  void renderSprite(
-    const SpriteDrawSpec& spec,
+  struct IndexEntry;
+
+  void markForReindexing(entityx::Entity entity);
+  void updateSpatialIndex();
+  void reindex(IndexEntry& entry);
+  void updateBounds(IndexEntry& entry);
+  void unindex(IndexEntry& entry);
+
+  void renderSprites(
+    std::vector<SpriteDrawSpec>::const_iterator first,
+    std::vector<SpriteDrawSpec>::const_iterator last,
     const SpecialEffectsRenderer& fx) const;
+  void submitBatch() const;
+
+  /** Index state of the entity occupying a certain entity index
+   *
+   * Like in the collision checker, component addresses are cached, since
+   * entityx never relocates components while they are assigned. Any
+   * change to the set of relevant components marks the entry for
+   * reindexing, which re-reads them before they are used again.
+   */
+  struct IndexEntry
+  {
+    // The entity as of the most recent reindexing, and the one to look at
+    // during the next one
+    entityx::Entity mEntity;
+    entityx::Entity mPendingEntity;
+
+    const components::Sprite* mpSprite = nullptr;
+    const components::WorldPosition* mpPosition = nullptr;
+    const SpriteDrawData* mpDrawData = nullptr;
+
+    // Union of all of the sprite's frames, relative to its position
+    base::Rect<int> mFrameExtents;
+    base::Rect<int> mBounds;
+
+    // Position in mIndexedSlots, if mIsIndexed is set
+    std::uint32_t mIndexedSlot = 0;
+    bool mIsIndexed = false;
+    bool mIsUnindexed = false;
+    bool mNeedsReindexing = false;
+  };
+
+  // Sprite-bearing entities by screen cell. Entries are indexed by entity
+  // index. Sprites with additional parts (sprite strips and extended frame
+  // lists) are rare and harder to bound, so they are always visited instead
+  // of being indexed.
+  SpatialGrid<entityx::Entity> mSpatialIndex{SPATIAL_INDEX_CELL_SIZE};
+  std::vector<IndexEntry> mIndexEntries;
+  std::vector<entityx::Entity> mUnindexedEntities;
+
+  // Entity indices of all entries in the spatial index, and of all entries
+  // waiting to be reindexed. Kept separately so that keeping the index up
+  // to date doesn't need to look at every entity in the entity manager.
+  std::vector<std::uint32_t> mIndexedSlots;
+  std::vector<std::uint32_t> mSlotsToReindex;
+  bool mSpatialIndexIsStale = true;
+
+  // Entities looked at by update(), kept around to avoid allocations
+  std::vector<entityx::Entity> mCandidates;
 
   // Temporary storage used for sorting sprites by draw order during sprite
   // collection. Scope-wise, this is only needed during update(), but in order
   // to reduce the number of allocations happening each frame, we reuse the
-  // vector.
+  // vectors.
   std::vector<SortableDrawSpec> mSortBuffer;
+  std::vector<std::size_t> mBucketOffsets;
+
+  // Vertex data for consecutive sprites sharing the same texture, submitted
+  // as a single draw call. Like the sort buffer, only needed while rendering
+  // but kept around to avoid allocations.
+  mutable std::vector<float> mBatchVertices;
+  mutable renderer::TextureId mBatchTexture = 0;
 
   // Data needed to draw sprites that are currently visible. This is updated
   // by each call to update().
@@ -113,6 +225,7 @@ private:
   // Dependencies needed for drawing
   renderer::Renderer* mpRenderer;
   const renderer::TextureAtlas* mpTextureAtlas;
+  std::optional<renderer::Shader> mSpriteShader;
 };
 
 } // namespace rigel::engine
@@ -46,6 +46,7 @@ struct CommandLineOptions
   bool mDisableAudio = false;
   bool mPlayDemo = false;
   std::optional<base::Vec2> mPlayerPosition;
+  std::optional<int> mFramesToSimulate;
 };
 
 } // namespace rigel
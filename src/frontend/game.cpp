@@ -20,6 +20,7 @@
 #include "assets/png_image.hpp"
 #include "base/defer.hpp"
 #include "base/math_utils.hpp"
+#include "base/profiler.hpp"
 #include "data/duke_script.hpp"
 #include "data/game_traits.hpp"
 #include "engine/timing.hpp"
@@ -58,6 +59,13 @@ using namespace engine;
 namespace
 {
 
+// Subdirectory of the preferences dir where rendered sound effects are cached
+constexpr auto SOUND_CACHE_SUBDIR = "sound_cache";
+
+// Subdirectory of the preferences dir where decoded levels are cached
+constexpr auto ASSET_CACHE_SUBDIR = "asset_cache";
+
+
 auto wrapWithInitialFadeIn(std::unique_ptr<GameMode> mode)
 {
   class InitialFadeInWrapper : public GameMode
@@ -82,6 +90,20 @@ auto wrapWithInitialFadeIn(std::unique_ptr<GameMode> mode)
 }
 
 
+bool detectSharewareVersion(const assets::ResourceLoader& resources)
+{
+  // The registered version has 24 additional level files, and a
+  // "anti-piracy" image (LCR.MNI). But we don't check for the presence of
+  // all of these files, as that would be fairly tedious. Instead, we just
+  // check for the presence of one of the registered version's levels, and
+  // the anti-piracy screen, and assume that we're dealing with a
+  // registered version data set if these two are present.
+  const auto hasRegisteredVersionFiles =
+    resources.hasFile("LCR.MNI") && resources.hasFile("O1.MNI");
+  return !hasRegisteredVersionFiles;
+}
+
+
 auto loadScripts(const assets::ResourceLoader& resources)
 {
   auto allScripts = resources.loadScriptBundle("TEXT.MNI");
@@ -163,7 +185,7 @@ std::optional<renderer::FpsLimiter>
 }
 
 
-std::string makeScreenshotFilename()
+std::string makeTimestampedFilename(const char* extension)
 {
   using namespace std::literals;
 
@@ -180,7 +202,28 @@ std::string makeScreenshotFilename()
     "%Y-%m-%d_%H%M%S",
     pLocalTime);
 
-  return "RigelEngine_"s + dateTimeBuffer.data() + ".png";
+  return "RigelEngine_"s + dateTimeBuffer.data() + extension;
+}
+
+
+void writeProfilerTrace()
+{
+  const auto maybePrefsDir = createOrGetPreferencesPath();
+  if (!maybePrefsDir)
+  {
+    return;
+  }
+
+  const auto path = *maybePrefsDir / makeTimestampedFilename(".trace.json");
+  if (base::profiler::writeChromeTrace(path))
+  {
+    LOG_F(INFO, "Profiler trace written to %s", path.u8string().c_str());
+  }
+  else
+  {
+    LOG_F(
+      ERROR, "Failed to write profiler trace to %s", path.u8string().c_str());
+  }
 }
 
 } // namespace
@@ -201,6 +244,16 @@ std::filesystem::path effectiveGamePath(
 }
 
 
+CommandLineOptions optionsForRestart(const CommandLineOptions& options)
+{
+  auto result = CommandLineOptions{};
+  result.mSkipIntro = true;
+  result.mDebugModeEnabled = options.mDebugModeEnabled;
+  result.mDisableAudio = options.mDisableAudio;
+  return result;
+}
+
+
 Game::Game(
   const CommandLineOptions& commandLineOptions,
   UserProfile* pUserProfile,
@@ -211,7 +264,15 @@ Game::Game(
   , mResources(
       effectiveGamePath(commandLineOptions, *pUserProfile),
       pUserProfile->mOptions.mEnableTopLevelMods,
-      pUserProfile->mModLibrary.enabledModPaths())
+      pUserProfile->mModLibrary.enabledModPaths(),
+      [&]() -> std::optional<std::filesystem::path> {
+        if (const auto maybePrefsDir = createOrGetPreferencesPath())
+        {
+          return *maybePrefsDir / ASSET_CACHE_SUBDIR;
+        }
+
+        return std::nullopt;
+      }())
   , mpSoundSystem([&]() -> std::unique_ptr<audio::SoundSystem> {
     if (commandLineOptions.mDisableAudio)
     {
@@ -221,10 +282,13 @@ Game::Game(
     std::unique_ptr<audio::SoundSystem> pResult;
     try
     {
+      const auto maybePrefsDir = createOrGetPreferencesPath();
       pResult = std::make_unique<audio::SoundSystem>(
         &mResources,
         pUserProfile->mOptions.mSoundStyle,
-        pUserProfile->mOptions.mAdlibPlaybackType);
+        pUserProfile->mOptions.mAdlibPlaybackType,
+        maybePrefsDir ? std::make_optional(*maybePrefsDir / SOUND_CACHE_SUBDIR)
+                      : std::nullopt);
     }
     catch (const std::exception& ex)
     {
@@ -233,17 +297,7 @@ Game::Game(
 
     return pResult;
   }())
-  , mIsShareWareVersion([this]() {
-    // The registered version has 24 additional level files, and a
-    // "anti-piracy" image (LCR.MNI). But we don't check for the presence of
-    // all of these files, as that would be fairly tedious. Instead, we just
-    // check for the presence of one of the registered version's levels, and
-    // the anti-piracy screen, and assume that we're dealing with a
-    // registered version data set if these two are present.
-    const auto hasRegisteredVersionFiles =
-      mResources.hasFile("LCR.MNI") && mResources.hasFile("O1.MNI");
-    return !hasRegisteredVersionFiles;
-  }())
+  , mIsShareWareVersion(detectSharewareVersion(mResources))
   , mFpsLimiter(createLimiter(pUserProfile->mOptions))
   , mUpscalingBuffer(&mRenderer, pUserProfile->mOptions)
   , mIsRunning(true)
@@ -294,12 +348,19 @@ auto Game::runOneFrame() -> std::optional<StopReason>
   using namespace std::chrono;
   using base::defer;
 
+  RIGEL_PROFILE_BEGIN_FRAME();
+  RIGEL_PROFILE_ZONE("Frame");
+
   const auto startOfFrame = base::Clock::now();
   const auto elapsed =
     duration<entityx::TimeDelta>(startOfFrame - mLastTime).count();
   mLastTime = startOfFrame;
 
-  pumpEvents();
+  {
+    RIGEL_PROFILE_ZONE("Event handling");
+    pumpEvents();
+  }
+
   if (!mIsRunning)
   {
     stopMusic();
@@ -323,26 +384,106 @@ auto Game::runOneFrame() -> std::optional<StopReason>
 
   swapBuffers();
 
-  const auto changedOptionsRequireRestart = applyChangedOptions();
+  const auto changedOptionsRequireReload = applyChangedOptions();
+  const auto gamePathChanged = !mGamePathToSwitchTo.empty();
 
-  if (!mGamePathToSwitchTo.empty())
+  if (gamePathChanged)
   {
     mpUserProfile->mGamePath = mGamePathToSwitchTo;
     mpUserProfile->saveToDisk();
-    return StopReason::RestartNeeded;
+    mGamePathToSwitchTo.clear();
   }
 
-  if (
-    changedOptionsRequireRestart ||
-    mpUserProfile->mModLibrary.fetchAndClearSelectionChangedFlag())
+  const auto modSelectionChanged =
+    mpUserProfile->mModLibrary.fetchAndClearSelectionChangedFlag();
+
+  if (changedOptionsRequireReload || gamePathChanged || modSelectionChanged)
   {
-    return StopReason::RestartNeeded;
+    try
+    {
+      reloadResources(gamePathChanged);
+    }
+    catch (const std::exception& ex)
+    {
+      LOG_F(ERROR, "Failed to reload resources: %s", ex.what());
+
+      // Fall back to tearing everything down and starting from scratch
+      return StopReason::RestartNeeded;
+    }
   }
 
   return {};
 }
 
 
+void Game::reloadResources(const bool gamePathChanged)
+{
+  LOG_SCOPE_FUNCTION(INFO);
+
+  // The current game mode might hold on to resources or still have loads in
+  // progress, so it needs to go before anything is changed. Like on a
+  // restart, we continue with the main menu afterwards.
+  mpCurrentGameMode.reset();
+  stopMusic();
+  stopAllSounds();
+
+  mCommandLineOptions = optionsForRestart(mCommandLineOptions);
+
+  const auto gamePath = effectiveGamePath(mCommandLineOptions, *mpUserProfile);
+
+  auto& modLibrary = mpUserProfile->mModLibrary;
+  if (gamePathChanged)
+  {
+    modLibrary.updateGamePath(gamePath);
+    modLibrary.clearSelectionChangedFlag();
+  }
+
+  const auto changes = mResources.changeSources(
+    gamePath,
+    mpUserProfile->mOptions.mEnableTopLevelMods,
+    modLibrary.enabledModPaths());
+
+  mIsShareWareVersion = detectSharewareVersion(mResources);
+  mAllScripts = loadScripts(mResources);
+
+  if (mpSoundSystem)
+  {
+    mpSoundSystem->reloadResources(changes.mSounds);
+  }
+
+  if (changes.mUiSpriteSheet)
+  {
+    mUiSpriteSheet = engine::TiledTexture{
+      renderer::Texture{
+        &mRenderer,
+        mResources.loadUiSpriteSheet(data::GameTraits::INGAME_PALETTE)},
+      &mRenderer};
+  }
+
+  if (changes.mFont)
+  {
+    mTextRenderer = ui::MenuElementRenderer{
+      &mUiSpriteSheet, &mRenderer, mResources};
+  }
+
+  if (changes.mSprites)
+  {
+    mSpriteFactory = engine::SpriteFactory{&mRenderer, &mResources};
+  }
+
+  LOG_F(
+    INFO,
+    "Reloaded resources (sounds: %d, sprites: %d, UI: %d, font: %d)",
+    changes.mSounds,
+    changes.mSprites,
+    changes.mUiSpriteSheet,
+    changes.mFont);
+
+  mpCurrentGameMode = wrapWithInitialFadeIn(createInitialGameMode(
+    makeModeContext(), mCommandLineOptions, mIsShareWareVersion, false));
+}
+
+
 void Game::pumpEvents()
 {
   SDL_Event event;
@@ -369,6 +510,7 @@ void Game::updateAndRender(const entityx::TimeDelta elapsed)
   mCurrentFrameIsWidescreen = false;
 
   auto pMaybeNextMode = std::invoke([&]() {
+    RIGEL_PROFILE_ZONE("Game mode");
     auto saved = mUpscalingBuffer.bindAndClear(
       mpUserProfile->mOptions.mPerElementUpscalingEnabled);
     return mpCurrentGameMode->updateAndRender(elapsed, mEventQueue);
@@ -390,13 +532,16 @@ void Game::updateAndRender(const entityx::TimeDelta elapsed)
     fadeInScreen();
   }
 
-  mUpscalingBuffer.present(
-    mCurrentFrameIsWidescreen,
-    mpUserProfile->mOptions.mPerElementUpscalingEnabled);
+  {
+    RIGEL_PROFILE_ZONE("Upscaling");
+    mUpscalingBuffer.present(
+      mCurrentFrameIsWidescreen,
+      mpUserProfile->mOptions.mPerElementUpscalingEnabled);
+  }
 
   if (mpUserProfile->mOptions.mShowFpsCounter)
   {
-    mFpsDisplay.updateAndRender(elapsed);
+    mFpsDisplay.updateAndRender(elapsed, mRenderer.lastFrameStatistics());
   }
 }
 
@@ -427,6 +572,9 @@ bool Game::handleEvent(const SDL_Event& event)
   switch (event.type)
   {
     case SDL_KEYUP:
+      // F6 toggles the FPS counter, F12 takes a screenshot. In builds with
+      // the profiler enabled, F8 writes a trace of the recorded frames. F8
+      // isn't bound to anything by default, unlike F5/F7 (quick save/load).
       if (event.key.keysym.sym == SDLK_F6)
       {
         options.mShowFpsCounter = !options.mShowFpsCounter;
@@ -435,6 +583,13 @@ bool Game::handleEvent(const SDL_Event& event)
       {
         mScreenshotRequested = true;
       }
+      else if (event.key.keysym.sym == SDLK_F8)
+      {
+        if constexpr (base::profiler::ENABLED)
+        {
+          writeProfilerTrace();
+        }
+      }
       return false;
 
     case SDL_QUIT:
@@ -538,10 +693,14 @@ void Game::performScreenFadeBlocking(const FadeType type)
 
 void Game::swapBuffers()
 {
-  mRenderer.swapBuffers();
+  {
+    RIGEL_PROFILE_ZONE("Swap buffers");
+    mRenderer.swapBuffers();
+  }
 
   if (mFpsLimiter)
   {
+    RIGEL_PROFILE_ZONE("FPS limiter wait");
     mFpsLimiter->updateAndWait();
   }
 }
@@ -652,14 +811,14 @@ bool Game::applyChangedOptions()
     mUpscalingBuffer.updateConfiguration(currentOptions);
   }
 
-  const auto restartNeeded =
+  const auto reloadNeeded =
     currentOptions.mEnableTopLevelMods != mPreviousOptions.mEnableTopLevelMods;
 
   mPreviousOptions = mpUserProfile->mOptions;
   mWidescreenModeWasActive = widescreenModeActive;
   mPreviousWindowSize = mRenderer.windowSize();
 
-  return restartNeeded;
+  return reloadNeeded;
 }
 
 
@@ -720,7 +879,7 @@ void Game::takeScreenshot()
   constexpr auto SCREENSHOTS_SUBDIR = "screenshots";
 
   const auto shot = mRenderer.grabCurrentFramebuffer();
-  const auto filename = makeScreenshotFilename();
+  const auto filename = makeTimestampedFilename(".png");
 
   auto saveShot = [&](const fs::path& path) {
     std::error_code ec;
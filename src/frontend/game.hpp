@@ -58,6 +58,17 @@ std::filesystem::path effectiveGamePath(
   const UserProfile& profile);
 
 
+/** Returns command line options to use when restarting the game
+ *
+ * This applies both to a full restart and to reloading resources in place.
+ * The game continues from the main menu, so most of the original options
+ * are discarded. This includes the game path, so that a path chosen in the
+ * options menu takes effect even if the game was launched with a path
+ * argument.
+ */
+CommandLineOptions optionsForRestart(const CommandLineOptions& options);
+
+
 class Game : public IGameServiceProvider
 {
 public:
@@ -86,6 +97,10 @@ public:
    * RestartNeeded, the game would like a new Game to be started after
    * terminating the loop, otherwise, the game is done and the whole program
    * can be terminated.
+   *
+   * Changing the game path or mod selection is normally handled in place,
+   * by reloading the affected resources. A restart is only requested if
+   * that fails.
    */
   std::optional<StopReason> runOneFrame();
 
@@ -107,6 +122,7 @@ private:
 
   void swapBuffers();
   bool applyChangedOptions();
+  void reloadResources(bool gamePathChanged);
   void enumerateGameControllers();
   void takeScreenshot();
   void setPerElementUpscalingEnabled(bool enabled);
@@ -17,6 +17,7 @@
 #include "game_runner.hpp"
 
 #include "base/math_utils.hpp"
+#include "base/profiler.hpp"
 #include "frontend/game_service_provider.hpp"
 #include "frontend/user_profile.hpp"
 #include "game_logic/world_state.hpp"
@@ -33,14 +34,17 @@ GameRunner::GameRunner(
   const data::GameSessionId& sessionId,
   GameMode::Context context,
   const std::optional<base::Vec2> playerPositionOverride,
-  const bool showWelcomeMessage)
+  const bool showWelcomeMessage,
+  std::optional<data::map::LevelData> preloadedLevel)
   : mContext(context)
   , mWorld(
       pPlayerModel,
       sessionId,
       context,
       playerPositionOverride,
-      showWelcomeMessage)
+      showWelcomeMessage,
+      game_logic::PlayerInput{},
+      std::move(preloadedLevel))
   , mInputHandler(&context.mpUserProfile->mOptions)
   , mMenu(context, pPlayerModel, &mWorld, sessionId)
 {
@@ -98,15 +102,20 @@ void GameRunner::updateAndRender(engine::TimeDelta dt)
     return;
   }
 
-  if (updateMenu(dt))
   {
-    return;
+    RIGEL_PROFILE_ZONE("Ingame menu");
+    if (updateMenu(dt))
+    {
+      return;
+    }
   }
 
   updateWorld(dt);
   mWorld.render(interpolationFactor(dt));
 
   renderDebugText();
+
+  RIGEL_PROFILE_ZONE("End of frame actions");
   mWorld.processEndOfFrameActions();
 }
 
@@ -128,7 +137,19 @@ float GameRunner::interpolationFactor(const engine::TimeDelta dt) const
 void GameRunner::updateWorld(const engine::TimeDelta dt)
 {
   auto update = [this]() {
-    mWorld.updateGameLogic(mInputHandler.fetchInput());
+    const auto input = mInputHandler.fetchInput();
+    const auto rewindEnabled = mContext.mpUserProfile->mOptions.mRewindEnabled;
+
+    if (rewindEnabled && mInputHandler.rewindKeyHeld())
+    {
+      // Once we run out of history, the game stays paused until the key is
+      // released
+      mWorld.rewind();
+    }
+    else
+    {
+      mWorld.updateGameLogic(input);
+    }
   };
 
 
@@ -149,7 +170,7 @@ void GameRunner::updateWorld(const engine::TimeDelta dt)
       update();
     }
 
-    mWorld.mpState->mMapRenderer.updateBackdropAutoScrolling(dt);
+    mWorld.mpState->mMapRenderer->updateBackdropAutoScrolling(dt);
   }
 }
 
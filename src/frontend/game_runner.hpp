@@ -42,7 +42,8 @@ public:
     const data::GameSessionId& sessionId,
     GameMode::Context context,
     std::optional<base::Vec2> playerPositionOverride = std::nullopt,
-    bool showWelcomeMessage = false);
+    bool showWelcomeMessage = false,
+    std::optional<data::map::LevelData> preloadedLevel = std::nullopt);
 
   void handleEvent(const SDL_Event& event);
   void updateAndRender(engine::TimeDelta dt);
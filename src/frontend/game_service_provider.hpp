@@ -80,4 +80,39 @@ struct IGameServiceProvider
   virtual const GameControllerInfo& gameControllerInfo() const = 0;
 };
 
+
+/** Service provider for running the game logic without a frontend
+ *
+ * There is no screen to fade and no audio device, so all requests are
+ * ignored. Used for headless simulation and benchmarks.
+ */
+struct NullServiceProvider : public IGameServiceProvider
+{
+  void fadeOutScreen() override { }
+  void fadeInScreen() override { }
+
+  void playSound(data::SoundId) override { }
+  void stopSound(data::SoundId) override { }
+  void stopAllSounds() override { }
+  void playMusic(const std::string&) override { }
+  void stopMusic() override { }
+  void scheduleGameQuit() override { }
+  void switchGamePath(const std::filesystem::path&) override { }
+  void markCurrentFrameAsWidescreen() override { }
+  bool isSharewareVersion() const override { return false; }
+
+  const CommandLineOptions& commandLineOptions() const override
+  {
+    return mCommandLineOptions;
+  }
+
+  const GameControllerInfo& gameControllerInfo() const override
+  {
+    return mGameControllerInfo;
+  }
+
+  CommandLineOptions mCommandLineOptions;
+  GameControllerInfo mGameControllerInfo;
+};
+
 } // namespace rigel
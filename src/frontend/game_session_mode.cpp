@@ -23,6 +23,7 @@
 #include "data/saved_game.hpp"
 #include "frontend/game_service_provider.hpp"
 #include "frontend/user_profile.hpp"
+#include "game_logic/world_state.hpp"
 #include "ui/high_score_list.hpp"
 #include "ui/menu_navigation.hpp"
 
@@ -67,14 +68,16 @@ GameSessionMode::GameSessionMode(const data::SavedGame& save, Context context)
 GameSessionMode::GameSessionMode(
   const data::GameSessionId& sessionId,
   data::PlayerModel playerModel,
-  Context context)
+  Context context,
+  data::map::LevelData&& preloadedLevel)
   : mPlayerModel(std::move(playerModel))
   , mCurrentStage(std::make_unique<GameRunner>(
       &mPlayerModel,
       sessionId,
       context,
       std::nullopt,
-      false /* don't show welcome message */))
+      false /* don't show welcome message */,
+      std::move(preloadedLevel)))
   , mEpisode(sessionId.mEpisode)
   , mCurrentLevelNr(sessionId.mLevel)
   , mDifficulty(sessionId.mDifficulty)
@@ -170,6 +173,10 @@ std::unique_ptr<GameMode> GameSessionMode::updateAndRender(
         {
           mContext.mpServiceProvider->playMusic("OPNGATEA.IMF");
 
+          mNextLevel = game_logic::loadLevelAsync(
+            *mContext.mpResources,
+            data::GameSessionId{mEpisode, mCurrentLevelNr + 1, mDifficulty});
+
           auto bonusScreen =
             ui::BonusScreen{mContext, achievedBonuses, scoreWithoutBonuses};
 
@@ -204,7 +211,8 @@ std::unique_ptr<GameMode> GameSessionMode::updateAndRender(
         return std::unique_ptr<GameSessionMode>{new GameSessionMode{
           data::GameSessionId{mEpisode, ++mCurrentLevelNr, mDifficulty},
           mPlayerModel,
-          mContext}};
+          mContext,
+          mNextLevel.get()}};
       }
 
       return nullptr;
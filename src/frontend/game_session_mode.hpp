@@ -23,6 +23,7 @@
 
 #include "game_runner.hpp"
 
+#include <future>
 #include <variant>
 
 namespace rigel::data
@@ -54,7 +55,8 @@ private:
   GameSessionMode(
     const data::GameSessionId& sessionId,
     data::PlayerModel playerModel,
-    Context context);
+    Context context,
+    data::map::LevelData&& preloadedLevel);
 
   void handleEvent(const SDL_Event& event);
   template <typename StageT>
@@ -85,6 +87,10 @@ private:
   int mCurrentLevelNr;
   const data::Difficulty mDifficulty;
   Context mContext;
+
+  // The next level is loaded in the background while the bonus screen is
+  // shown
+  std::future<data::map::LevelData> mNextLevel;
 };
 
 } // namespace rigel
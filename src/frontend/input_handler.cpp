@@ -76,6 +76,7 @@ auto InputHandler::handleEvent(const SDL_Event& event, const bool playerInShip)
 void InputHandler::reset()
 {
   mPlayerInput = {};
+  mRewindKeyHeld = false;
 }
 
 
@@ -141,6 +142,10 @@ auto InputHandler::handleKeyboardInput(const SDL_Event& event) -> MenuCommand
       return MenuCommand::QuickLoad;
     }
   }
+  else if (keyCode == mpOptions->mRewindKeybinding)
+  {
+    mRewindKeyHeld = keyPressed;
+  }
 
   return MenuCommand::None;
 }
@@ -53,6 +53,8 @@ public:
 
   game_logic::PlayerInput fetchInput();
 
+  bool rewindKeyHeld() const { return mRewindKeyHeld; }
+
 private:
   MenuCommand handleKeyboardInput(const SDL_Event& event);
   MenuCommand handleControllerInput(const SDL_Event& event, bool playerInShip);
@@ -61,6 +63,7 @@ private:
   base::Vec2 mAnalogStickVector;
   const data::GameOptions* mpOptions;
   bool mQuickSaveModifierHeld = false;
+  bool mRewindKeyHeld = false;
 };
 
 } // namespace rigel
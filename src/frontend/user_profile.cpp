@@ -37,6 +37,7 @@ RIGEL_DISABLE_WARNINGS
 #include <nlohmann/json.hpp>
 RIGEL_RESTORE_WARNINGS
 
+#include <algorithm>
 #include <array>
 #include <fstream>
 #include <iomanip>
@@ -435,6 +436,7 @@ nlohmann::ordered_json serialize(const data::GameOptions& options)
     SDL_GetKeyName(options.mQuickSaveKeybinding);
   serialized["quickLoadKeybinding"] =
     SDL_GetKeyName(options.mQuickLoadKeybinding);
+  serialized["rewindKeybinding"] = SDL_GetKeyName(options.mRewindKeybinding);
   serialized["topLevelModsEnabled"] = options.mEnableTopLevelMods;
 
 #if 0
@@ -447,6 +449,8 @@ nlohmann::ordered_json serialize(const data::GameOptions& options)
   serialized["widescreenHudStyle"] = options.mWidescreenHudStyle;
   serialized["showRadarInModernHud"] = options.mShowRadarInModernHud;
   serialized["quickSavingEnabled"] = options.mQuickSavingEnabled;
+  serialized["rewindEnabled"] = options.mRewindEnabled;
+  serialized["rewindMemoryBudgetMb"] = options.mRewindMemoryBudgetMb;
   serialized["skipIntro"] = options.mSkipIntro;
   serialized["motionSmoothing"] = options.mMotionSmoothing;
   return serialized;
@@ -660,6 +664,7 @@ data::GameOptions deserialize<data::GameOptions>(const nlohmann::json& json)
     "quickSaveKeybinding", result.mQuickSaveKeybinding, json);
   extractKeyBindingIfExists(
     "quickLoadKeybinding", result.mQuickLoadKeybinding, json);
+  extractKeyBindingIfExists("rewindKeybinding", result.mRewindKeybinding, json);
   extractValueIfExists("topLevelModsEnabled", result.mEnableTopLevelMods, json);
   extractValueIfExists(
     "compatibilityModeOn", result.mCompatibilityModeOn, json);
@@ -668,6 +673,11 @@ data::GameOptions deserialize<data::GameOptions>(const nlohmann::json& json)
   extractValueIfExists(
     "showRadarInModernHud", result.mShowRadarInModernHud, json);
   extractValueIfExists("quickSavingEnabled", result.mQuickSavingEnabled, json);
+  extractValueIfExists("rewindEnabled", result.mRewindEnabled, json);
+  extractValueIfExists(
+    "rewindMemoryBudgetMb", result.mRewindMemoryBudgetMb, json);
+  result.mRewindMemoryBudgetMb = std::clamp(
+    result.mRewindMemoryBudgetMb, 1, data::MAX_REWIND_MEMORY_BUDGET_MB);
   extractValueIfExists("skipIntro", result.mSkipIntro, json);
   extractValueIfExists("motionSmoothing", result.mMotionSmoothing, json);
 
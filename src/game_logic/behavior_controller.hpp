@@ -16,13 +16,19 @@
 
 #pragma once
 
+#include "base/object_pool.hpp"
 #include "base/warnings.hpp"
+#include "engine/base_components.hpp"
 #include "game_logic/global_dependencies.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <type_traits>
 
@@ -161,14 +167,39 @@ std::enable_if_t<!detail::hasOnCollision<T>::value>
 class BehaviorController
 {
 public:
+  /** Entry for updateBatch(), see batchUpdateFunc() */
+  struct BatchItem
+  {
+    entityx::Entity mEntity;
+    std::uint64_t mControllerSerial;
+  };
+
+  /** Updates a number of controllers which all have the same type
+   *
+   * The controllers are updated in the given order, using static calls.
+   * Items whose entity is no longer active, or whose controller has been
+   * removed or replaced since creating the item, are skipped. This also
+   * holds if the replacement has the same type, since each controller
+   * instance has a unique serial number.
+   */
+  using BatchUpdateFunc = void (*)(
+    const BatchItem* pItems,
+    std::size_t count,
+    GlobalDependencies& dependencies,
+    GlobalState& state);
+
   template <typename T>
   explicit BehaviorController(T controller)
     : mpSelf(std::make_unique<Model<T>>(std::move(controller)))
+    , mpBatchUpdate(&Model<T>::updateBatch)
+    , mSerial(nextSerial())
   {
   }
 
   BehaviorController(const BehaviorController& other)
     : mpSelf(other.mpSelf->clone())
+    , mpBatchUpdate(other.mpBatchUpdate)
+    , mSerial(nextSerial())
   {
   }
 
@@ -176,6 +207,8 @@ public:
   {
     auto copy = other;
     std::swap(mpSelf, copy.mpSelf);
+    mpBatchUpdate = copy.mpBatchUpdate;
+    mSerial = copy.mSerial;
     return *this;
   }
 
@@ -225,12 +258,45 @@ public:
     return dynamic_cast<Model<T>*>(pSelf)->mData;
   }
 
+  /** Batch update function for this controller's type
+   *
+   * Can also be used to tell whether two controllers have the same type.
+   */
+  BatchUpdateFunc batchUpdateFunc() const { return mpBatchUpdate; }
+
+  /** Tell whether both controllers have the same type and state
+   *
+   * Only controllers with trivially copyable state can be compared. For all
+   * others, this conservatively returns false.
+   */
+  bool hasSameStateAs(const BehaviorController& other) const
+  {
+    return mpSelf->hasSameStateAs(*other.mpSelf);
+  }
+
+  /** Size of the controller's type-erased state, in bytes */
+  std::size_t stateSize() const { return mpSelf->size(); }
+
+  BatchItem makeBatchItem(entityx::Entity entity) const
+  {
+    return BatchItem{entity, mSerial};
+  }
+
 private:
+  // Only called on the game logic thread, like the pool allocation below
+  static std::uint64_t nextSerial()
+  {
+    static std::uint64_t counter = 0;
+    return ++counter;
+  }
+
   struct Concept
   {
     virtual ~Concept() = default;
 
     virtual std::unique_ptr<Concept> clone() const = 0;
+    virtual bool hasSameStateAs(const Concept& other) const = 0;
+    virtual std::size_t size() const = 0;
 
     virtual void update(
       GlobalDependencies& dependencies,
@@ -265,11 +331,80 @@ private:
     {
     }
 
+    // Controllers of the same type are allocated from a common pool, which
+    // keeps them close together in memory. Controllers are only created
+    // and destroyed on the game logic thread.
+    static void* operator new(const std::size_t size)
+    {
+      assert(size == sizeof(Model));
+      return pool().allocate();
+    }
+
+    static void operator delete(void* pMemory) { pool().deallocate(pMemory); }
+
+    static base::ObjectPool<Model>& pool()
+    {
+      static base::ObjectPool<Model> instance;
+      return instance;
+    }
+
+    static void updateBatch(
+      const BatchItem* pItems,
+      const std::size_t count,
+      GlobalDependencies& dependencies,
+      GlobalState& state)
+    {
+      using engine::components::Active;
+
+      for (auto i = std::size_t{0}; i < count; ++i)
+      {
+        auto entity = pItems[i].mEntity;
+        if (
+          !entity.valid() || !entity.has_component<Active>() ||
+          !entity.has_component<BehaviorController>())
+        {
+          continue;
+        }
+
+        // Serials are never reused, so if it still matches, this is the
+        // same controller instance, which is of type T.
+        auto& controller = *entity.component<BehaviorController>();
+        if (controller.mSerial != pItems[i].mControllerSerial)
+        {
+          continue;
+        }
+
+        auto& self = static_cast<Model&>(*controller.mpSelf);
+        updateBehaviorController(
+          self.mData,
+          dependencies,
+          state,
+          entity.component<const Active>()->mIsOnScreen,
+          entity);
+      }
+    }
+
     std::unique_ptr<Concept> clone() const override
     {
       return std::make_unique<Model>(mData);
     }
 
+    bool hasSameStateAs(const Concept& other) const override
+    {
+      if constexpr (std::is_trivially_copyable_v<T>)
+      {
+        const auto pOther = dynamic_cast<const Model*>(&other);
+        return pOther &&
+          std::memcmp(&mData, &pOther->mData, sizeof(T)) == 0;
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    std::size_t size() const override { return sizeof(Model); }
+
     void update(
       GlobalDependencies& dependencies,
       GlobalState& state,
@@ -312,6 +447,8 @@ private:
   };
 
   std::unique_ptr<Concept> mpSelf;
+  BatchUpdateFunc mpBatchUpdate;
+  std::uint64_t mSerial;
 };
 
 } // namespace rigel::game_logic::components
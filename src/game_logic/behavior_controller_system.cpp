@@ -21,6 +21,8 @@
 #include "game_logic/behavior_controller.hpp"
 #include "game_logic/global_dependencies.hpp"
 
+#include <algorithm>
+
 
 namespace rigel::game_logic
 {
@@ -48,6 +50,12 @@ void BehaviorControllerSystem::update(
 
   mPerFrameState = s;
 
+  if (mDispatchMode == DispatchMode::GroupedByType)
+  {
+    updateGroupedByType(es);
+    return;
+  }
+
   es.each<BehaviorController, Active>([this](
                                         entityx::Entity entity,
                                         BehaviorController& controller,
@@ -57,6 +65,52 @@ void BehaviorControllerSystem::update(
 }
 
 
+void BehaviorControllerSystem::updateGroupedByType(entityx::EntityManager& es)
+{
+  using engine::components::Active;
+  using game_logic::components::BehaviorController;
+
+  for (auto i = std::size_t{0}; i < mNumBatches; ++i)
+  {
+    mBatches[i].mItems.clear();
+  }
+  mNumBatches = 0;
+
+  es.each<BehaviorController, Active>(
+    [this](
+      entityx::Entity entity, BehaviorController& controller, const Active&) {
+      const auto pUpdate = controller.batchUpdateFunc();
+
+      // A level only uses a few dozen different controller types, so a
+      // linear search is good enough here.
+      auto iBatch = std::find_if(
+        mBatches.begin(),
+        mBatches.begin() + mNumBatches,
+        [&](const Batch& batch) { return batch.mpUpdate == pUpdate; });
+      if (iBatch == mBatches.begin() + mNumBatches)
+      {
+        if (mNumBatches == mBatches.size())
+        {
+          mBatches.emplace_back();
+        }
+
+        iBatch = mBatches.begin() + mNumBatches;
+        iBatch->mpUpdate = pUpdate;
+        ++mNumBatches;
+      }
+
+      iBatch->mItems.push_back(controller.makeBatchItem(entity));
+    });
+
+  for (auto i = std::size_t{0}; i < mNumBatches; ++i)
+  {
+    const auto& batch = mBatches[i];
+    batch.mpUpdate(
+      batch.mItems.data(), batch.mItems.size(), mDependencies, mGlobalState);
+  }
+}
+
+
 void BehaviorControllerSystem::receive(const events::ShootableDamaged& event)
 {
   using engine::components::Active;
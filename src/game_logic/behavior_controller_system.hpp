@@ -16,10 +16,14 @@
 
 #pragma once
 
+#include "game_logic/behavior_controller.hpp"
 #include "game_logic/damage_components.hpp"
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic/input.hpp"
 
+#include <cstddef>
+#include <vector>
+
 namespace rigel::engine::events
 {
 struct CollidedWithWorld;
@@ -33,6 +37,21 @@ class BehaviorControllerSystem
   : public entityx::Receiver<BehaviorControllerSystem>
 {
 public:
+  enum class DispatchMode
+  {
+    // Update controllers in entity order, like the original game.
+    // Controllers interact with each other and share the random number
+    // generator, so this is needed for faithful behavior.
+    EntityOrder,
+
+    // Update all controllers of one type, then all of the next type etc.,
+    // using static calls. Types are processed in the order in which they
+    // first appear in entity order, so the result is still deterministic.
+    // Entities spawned during the update are first updated on the next
+    // frame.
+    GroupedByType
+  };
+
   BehaviorControllerSystem(
     GlobalDependencies dependencies,
     Player* pPlayer,
@@ -41,14 +60,31 @@ public:
 
   void update(entityx::EntityManager& es, const PerFrameState& s);
 
+  void setDispatchMode(const DispatchMode mode) { mDispatchMode = mode; }
+  DispatchMode dispatchMode() const { return mDispatchMode; }
+
   void receive(const events::ShootableDamaged& event);
   void receive(const events::ShootableKilled& event);
   void receive(const engine::events::CollidedWithWorld& event);
 
 private:
+  struct Batch
+  {
+    components::BehaviorController::BatchUpdateFunc mpUpdate;
+    std::vector<components::BehaviorController::BatchItem> mItems;
+  };
+
+  void updateGroupedByType(entityx::EntityManager& es);
+
   GlobalDependencies mDependencies;
   PerFrameState mPerFrameState;
   GlobalState mGlobalState;
+  DispatchMode mDispatchMode = DispatchMode::EntityOrder;
+
+  // Only the first mNumBatches entries are in use, the remaining ones are
+  // kept around to avoid reallocating their item lists on each frame.
+  std::vector<Batch> mBatches;
+  std::size_t mNumBatches = 0;
 };
 
 } // namespace rigel::game_logic
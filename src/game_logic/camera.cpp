@@ -163,10 +163,16 @@ Camera::Camera(
 }
 
 
-void Camera::synchronizeTo(const Camera& other)
+Camera::SavedState Camera::saveState() const
 {
-  mPosition = other.mPosition;
-  mManualScrollCooldown = other.mManualScrollCooldown;
+  return {mPosition, mManualScrollCooldown};
+}
+
+
+void Camera::restoreState(const SavedState& state)
+{
+  mPosition = state.mPosition;
+  mManualScrollCooldown = state.mManualScrollCooldown;
 }
 
 
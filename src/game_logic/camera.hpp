@@ -50,7 +50,14 @@ public:
     const data::map::Map& map,
     entityx::EventManager& eventManager);
 
-  void synchronizeTo(const Camera& other);
+  struct SavedState
+  {
+    base::Vec2 mPosition;
+    int mManualScrollCooldown;
+  };
+
+  SavedState saveState() const;
+  void restoreState(const SavedState& state);
 
   void update(const PlayerInput& input, const base::Size& viewportSize);
   void recenter(const base::Size& viewportSize);
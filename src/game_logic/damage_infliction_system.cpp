@@ -22,6 +22,9 @@
 #include "engine/visual_components.hpp"
 #include "frontend/game_service_provider.hpp"
 
+#include <algorithm>
+#include <tuple>
+
 
 namespace rigel::game_logic
 {
@@ -49,6 +52,14 @@ auto extractVelocity(entityx::Entity entity)
     : base::Vec2f{};
 }
 
+
+/** Order in which entityx iterates over entities */
+bool comesBefore(const ex::Entity& lhs, const ex::Entity& rhs)
+{
+  return std::make_tuple(lhs.id().index(), lhs.id().version()) <
+    std::make_tuple(rhs.id().index(), rhs.id().version());
+}
+
 } // namespace
 
 
@@ -60,27 +71,48 @@ DamageInflictionSystem::DamageInflictionSystem(
   , mpServiceProvider(pServiceProvider)
   , mpEvents(pEvents)
 {
+  pEvents->subscribe<ex::ComponentAddedEvent<Shootable>>(*this);
 }
 
 
 void DamageInflictionSystem::update(ex::EntityManager& es)
 {
+  buildShootableIndex(es);
+
+  mShootablesSpawnedDuringUpdate.clear();
+  mIsUpdating = true;
+
   es.each<DamageInflicting, WorldPosition, BoundingBox>(
-    [this, &es](
+    [this](
       ex::Entity inflictorEntity,
       DamageInflicting& damage,
       const WorldPosition& inflictorPosition,
       const BoundingBox& bbox) {
       const auto inflictorBbox = engine::toWorldSpace(bbox, inflictorPosition);
 
-      ex::ComponentHandle<Shootable> shootable;
-      ex::ComponentHandle<WorldPosition> shootablePos;
-      ex::ComponentHandle<BoundingBox> shootableBboxLocal;
-      for (auto shootableEntity : es.entities_with_components(
-             shootable, shootablePos, shootableBboxLocal))
+      collectCandidates(inflictorBbox);
+
+      // Candidates are sorted in entity iteration order, so damage is
+      // applied in the same order as when testing against all shootables.
+      for (std::size_t i = 0; i < mCandidates.size(); ++i)
       {
-        const auto shootableBbox =
-          engine::toWorldSpace(*shootableBboxLocal, *shootablePos);
+        auto shootableEntity = mCandidates[i];
+
+        // clang-format off
+        if (
+          !shootableEntity.valid() ||
+          !shootableEntity.has_component<Shootable>() ||
+          !shootableEntity.has_component<WorldPosition>() ||
+          !shootableEntity.has_component<BoundingBox>())
+        // clang-format on
+        {
+          continue;
+        }
+
+        auto shootable = shootableEntity.component<Shootable>();
+        const auto shootableBbox = engine::toWorldSpace(
+          *shootableEntity.component<const BoundingBox>(),
+          *shootableEntity.component<const WorldPosition>());
 
         const auto shootableOnScreen =
           shootableEntity.has_component<Active>() &&
@@ -95,14 +127,89 @@ void DamageInflictionSystem::update(ex::EntityManager& es)
         {
           const auto destroyOnContact =
             damage.mDestroyOnContact || shootable->mAlwaysConsumeInflictor;
+          const auto numSpawnedBefore = mShootablesSpawnedDuringUpdate.size();
           inflictDamage(inflictorEntity, damage, shootableEntity, *shootable);
           if (destroyOnContact)
           {
             break;
           }
+
+          addShootablesSpawnedDuringUpdate(numSpawnedBefore, i);
         }
       }
     });
+
+  mIsUpdating = false;
+}
+
+
+void DamageInflictionSystem::receive(
+  const ex::ComponentAddedEvent<Shootable>& event)
+{
+  if (mIsUpdating)
+  {
+    mShootablesSpawnedDuringUpdate.push_back(event.entity);
+  }
+}
+
+
+void DamageInflictionSystem::buildShootableIndex(ex::EntityManager& es)
+{
+  mShootableIndex.clear();
+
+  es.each<Shootable, WorldPosition, BoundingBox>(
+    [this](
+      ex::Entity entity,
+      const Shootable&,
+      const WorldPosition& position,
+      const BoundingBox& bbox) {
+      mShootableIndex.insert(entity, engine::toWorldSpace(bbox, position));
+    });
+}
+
+
+void DamageInflictionSystem::collectCandidates(
+  const base::Rect<int>& inflictorBbox)
+{
+  mCandidates.clear();
+  mShootableIndex.forEachCandidate(
+    inflictorBbox,
+    [this](const ex::Entity& entity) { mCandidates.push_back(entity); });
+  mCandidates.insert(
+    mCandidates.end(),
+    mShootablesSpawnedDuringUpdate.begin(),
+    mShootablesSpawnedDuringUpdate.end());
+
+  std::sort(mCandidates.begin(), mCandidates.end(), comesBefore);
+  mCandidates.erase(
+    std::unique(mCandidates.begin(), mCandidates.end()), mCandidates.end());
+}
+
+
+void DamageInflictionSystem::addShootablesSpawnedDuringUpdate(
+  const std::size_t firstNewShootable,
+  const std::size_t currentCandidate)
+{
+  // When iterating over all entities, a newly spawned shootable is still
+  // visited if it's located after the current one. Mirror that by adding it
+  // to the remaining candidates. Earlier ones will be picked up by
+  // collectCandidates() for the next inflictor.
+  const auto currentIndex = mCandidates[currentCandidate].id().index();
+
+  for (auto i = firstNewShootable; i < mShootablesSpawnedDuringUpdate.size();
+       ++i)
+  {
+    const auto entity = mShootablesSpawnedDuringUpdate[i];
+    if (entity.id().index() > currentIndex)
+    {
+      const auto iInsertionPoint = std::upper_bound(
+        std::next(mCandidates.begin(), currentCandidate + 1),
+        mCandidates.end(),
+        entity,
+        comesBefore);
+      mCandidates.insert(iInsertionPoint, entity);
+    }
+  }
 }
 
 
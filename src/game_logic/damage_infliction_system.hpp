@@ -18,12 +18,16 @@
 
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
+#include "engine/spatial_grid.hpp"
 #include "game_logic/damage_components.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstddef>
+#include <vector>
+
 namespace rigel
 {
 struct IGameServiceProvider;
@@ -39,6 +43,7 @@ namespace rigel::game_logic
 {
 
 class DamageInflictionSystem
+  : public entityx::Receiver<DamageInflictionSystem>
 {
 public:
   DamageInflictionSystem(
@@ -48,7 +53,16 @@ public:
 
   void update(entityx::EntityManager& es);
 
+  void receive(
+    const entityx::ComponentAddedEvent<components::Shootable>& event);
+
 private:
+  void buildShootableIndex(entityx::EntityManager& es);
+  void collectCandidates(const base::Rect<int>& inflictorBbox);
+  void addShootablesSpawnedDuringUpdate(
+    std::size_t firstNewShootable,
+    std::size_t currentCandidate);
+
   void inflictDamage(
     entityx::Entity inflictorEntity,
     components::DamageInflicting& damage,
@@ -58,6 +72,17 @@ private:
   data::PlayerModel* mpPlayerModel;
   IGameServiceProvider* mpServiceProvider;
   entityx::EventManager* mpEvents;
+
+  // Rebuilt at the start of each update, since positions and bounding boxes
+  // are modified in place and don't generate any events.
+  engine::SpatialGrid<entityx::Entity> mShootableIndex;
+  std::vector<entityx::Entity> mCandidates;
+
+  // Shootables which appear while damage is being inflicted (e.g. spawned
+  // when another shootable is destroyed) are not in the index, so we keep
+  // track of them separately.
+  std::vector<entityx::Entity> mShootablesSpawnedDuringUpdate;
+  bool mIsUpdating = false;
 };
 
 } // namespace rigel::game_logic
@@ -62,7 +62,7 @@ std::vector<DemoInput> loadDemo(const assets::ResourceLoader& resources)
   PlayerInput previousInput;
   std::vector<DemoInput> result;
 
-  const auto demoData = resources.file("NUKEM2.MNI");
+  const auto demoData = resources.fileView("NUKEM2.MNI");
   for (const auto byte : demoData)
   {
     if (byte == END_OF_DEMO_MARKER)
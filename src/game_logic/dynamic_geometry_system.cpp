@@ -215,14 +215,19 @@ bool isOnSolidGround(
 
 
 // This function splits the map up into a static part, which we hand over
-// to the MapRenderer, and dynamic parts. The dynamic parts can change during
+// to the MapRenderer, and dynamic parts. The dynamic parts move during
 // gameplay and thus cannot be rendered as static VBOs, but rather have to
 // be rendered dynamically (see DynamicGeometrySystem::renderDynamicSections).
+//
+// Parts of the map which can only disappear, but never move (burnable tiles
+// and areas destroyed by missiles), remain in the static part. When they
+// change, the MapRenderer is informed so that it can update the affected
+// tile blocks.
 DynamicMapSectionData determineDynamicMapSections(
   const data::map::Map& originalMap,
   const std::vector<data::map::LevelData::Actor>& actorDescriptions)
 {
-  DynamicMapSectionData result{originalMap, {}, {}};
+  DynamicMapSectionData result{originalMap, {}};
   auto& map = result.mMapStaticParts;
 
   // We don't have entities yet, but the CollisionChecker needs them.
@@ -263,6 +268,10 @@ DynamicMapSectionData determineDynamicMapSections(
 
   std::vector<base::Rect<int>> dynamicSections;
 
+  // Sections are cleared while scanning the map, to avoid detecting them
+  // more than once. They are restored afterwards.
+  std::vector<base::Rect<int>> simpleSections;
+
   for (const auto& actor : actorDescriptions)
   {
     if (actor.mAssignedArea)
@@ -299,7 +308,7 @@ DynamicMapSectionData determineDynamicMapSections(
         if (y >= 2)
         {
           map.clearSection(x, y - 2, 3, 3);
-          result.mSimpleSections.push_back({{x, y - 2}, {3, 3}});
+          simpleSections.push_back({{x, y - 2}, {3, 3}});
         }
       }
     }
@@ -326,7 +335,7 @@ DynamicMapSectionData determineDynamicMapSections(
 
         const auto section = base::Rect<int>{{x, y}, {endX - x, endY - y}};
         map.clearSection(x, y, section.size.width, section.size.height);
-        result.mSimpleSections.push_back(section);
+        simpleSections.push_back(section);
       }
     }
   }
@@ -345,6 +354,18 @@ DynamicMapSectionData determineDynamicMapSections(
     ++index;
   }
 
+  for (const auto& section : simpleSections)
+  {
+    for (auto y = section.top(); y <= section.bottom(); ++y)
+    {
+      for (auto x = section.left(); x <= section.right(); ++x)
+      {
+        map.setTileAt(0, x, y, originalMap.tileAt(0, x, y));
+        map.setTileAt(1, x, y, originalMap.tileAt(1, x, y));
+      }
+    }
+  }
+
   for (const auto& section : dynamicSections)
   {
     map.clearSection(
@@ -368,8 +389,7 @@ DynamicGeometrySystem::DynamicGeometrySystem(
   data::map::Map* pMap,
   engine::RandomNumberGenerator* pRandomGenerator,
   entityx::EventManager* pEvents,
-  engine::MapRenderer* pMapRenderer,
-  std::vector<base::Rect<int>> simpleDynamicSections)
+  engine::MapRenderer* pMapRenderer)
   : mpRenderer(pRenderer)
   , mpServiceProvider(pServiceProvider)
   , mpEntityManager(pEntityManager)
@@ -377,7 +397,6 @@ DynamicGeometrySystem::DynamicGeometrySystem(
   , mpRandomGenerator(pRandomGenerator)
   , mpEvents(pEvents)
   , mpMapRenderer(pMapRenderer)
-  , mSimpleDynamicSections(std::move(simpleDynamicSections))
 {
   pEvents->subscribe<events::ShootableKilled>(*this);
   pEvents->subscribe<rigel::events::DoorOpened>(*this);
@@ -481,6 +500,7 @@ void DynamicGeometrySystem::receive(
   explodeMapSection(
     mapSection, *mpMap, *mpEntityManager, *mpEvents, *mpRandomGenerator);
   updateExtraSectionsIntersecting(mapSection);
+  updateStaticTiles(mapSection);
   mpEvents->emit(rigel::events::ScreenFlash{});
 }
 
@@ -492,6 +512,7 @@ void DynamicGeometrySystem::receive(const rigel::events::TileBurnedAway& event)
   mpMap->setTileAt(1, x, y, 0);
 
   updateExtraSectionsIntersecting({{x, y}, {1, 1}});
+  updateStaticTiles({{x, y}, {1, 1}});
 }
 
 
@@ -531,19 +552,6 @@ void DynamicGeometrySystem::renderDynamicSections(
 
   const auto screenRect = base::Rect<int>{sectionStart, sectionSize};
 
-  // Simple dynamic sections (burning tiles or destroyed by missile)
-  for (const auto& section : mSimpleDynamicSections)
-  {
-    if (!screenRect.intersects(section))
-    {
-      continue;
-    }
-
-    const auto pixelPos = data::tilesToPixels(section.topLeft - sectionStart);
-
-    mpMapRenderer->renderDynamicSection(*mpMap, section, pixelPos, drawMode);
-  }
-
   // Falling dynamic geometry
   mpEntityManager->each<DynamicGeometrySection, WorldPosition>(
     [&](
@@ -652,6 +660,15 @@ void DynamicGeometrySystem::renderDynamicSections(
 }
 
 
+void DynamicGeometrySystem::updateStaticTiles(const base::Rect<int>& section)
+{
+  if (mpMapRenderer)
+  {
+    mpMapRenderer->updateTiles(*mpMap, section);
+  }
+}
+
+
 void DynamicGeometrySystem::updateExtraSectionsIntersecting(
   const base::Rect<int>& section)
 {
@@ -64,7 +64,6 @@ struct DynamicMapSectionData
 {
   data::map::Map mMapStaticParts;
 
-  std::vector<base::Rect<int>> mSimpleSections;
   std::vector<FallingSectionInfo> mFallingSections;
 };
 
@@ -84,8 +83,7 @@ public:
     data::map::Map* pMap,
     engine::RandomNumberGenerator* pRandomGenerator,
     entityx::EventManager* pEvents,
-    engine::MapRenderer* pMapRenderer,
-    std::vector<base::Rect<int>> simpleDynamicSections);
+    engine::MapRenderer* pMapRenderer);
 
   void initializeDynamicGeometryEntities(
     const std::vector<FallingSectionInfo>& fallingSections);
@@ -111,6 +109,7 @@ private:
     float interpolationFactor,
     engine::MapRenderer::DrawMode drawMode);
   void updateExtraSectionsIntersecting(const base::Rect<int>& section);
+  void updateStaticTiles(const base::Rect<int>& section);
 
   renderer::Renderer* mpRenderer;
   IGameServiceProvider* mpServiceProvider;
@@ -119,7 +118,6 @@ private:
   engine::RandomNumberGenerator* mpRandomGenerator;
   entityx::EventManager* mpEvents;
   engine::MapRenderer* mpMapRenderer;
-  std::vector<base::Rect<int>> mSimpleDynamicSections;
 };
 
 } // namespace rigel::game_logic
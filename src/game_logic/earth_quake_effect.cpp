@@ -37,10 +37,16 @@ EarthQuakeEffect::EarthQuakeEffect(
 }
 
 
-void EarthQuakeEffect::synchronizeTo(const EarthQuakeEffect& other)
+EarthQuakeEffect::SavedState EarthQuakeEffect::saveState() const
 {
-  mCountdown = other.mCountdown;
-  mThreshold = other.mThreshold;
+  return {mCountdown, mThreshold};
+}
+
+
+void EarthQuakeEffect::restoreState(const SavedState& state)
+{
+  mCountdown = state.mCountdown;
+  mThreshold = state.mThreshold;
 }
 
 
@@ -44,7 +44,14 @@ public:
     engine::RandomNumberGenerator* pRandomGenerator,
     entityx::EventManager* pEvents);
 
-  void synchronizeTo(const EarthQuakeEffect& other);
+  struct SavedState
+  {
+    int mCountdown;
+    int mThreshold;
+  };
+
+  SavedState saveState() const;
+  void restoreState(const SavedState& state);
 
   void update();
   bool isQuaking() const;
@@ -0,0 +1,449 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "entity_snapshot.hpp"
+
+#include "engine/base_components.hpp"
+#include "engine/life_time_components.hpp"
+#include "engine/physical_components.hpp"
+#include "engine/visual_components.hpp"
+#include "game_logic/actor_tag.hpp"
+#include "game_logic/behavior_controller.hpp"
+#include "game_logic/collectable_components.hpp"
+#include "game_logic/damage_components.hpp"
+#include "game_logic/dynamic_geometry_components.hpp"
+#include "game_logic/effect_components.hpp"
+#include "game_logic/interactive/enemy_radar.hpp"
+#include "game_logic/interactive/item_container.hpp"
+#include "game_logic/player/components.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+namespace rigel::game_logic
+{
+
+using namespace engine::components;
+using namespace game_logic::components;
+
+
+namespace
+{
+
+/** Values of one component type, keyed by the owning entity's position in
+ * the snapshot, in ascending order
+ */
+template <typename T>
+using ComponentColumn = std::vector<std::pair<std::uint32_t, T>>;
+
+
+// All component types which are part of a snapshot. Entities are restored by
+// assigning their components in this order.
+using ComponentColumns = std::tuple<
+  ComponentColumn<ActivationSettings>,
+  ComponentColumn<Active>,
+  ComponentColumn<ActorTag>,
+  ComponentColumn<AnimationLoop>,
+  ComponentColumn<AnimationSequence>,
+  ComponentColumn<AppearsOnRadar>,
+  ComponentColumn<AutoDestroy>,
+  ComponentColumn<BehaviorController>,
+  ComponentColumn<BoundingBox>,
+  ComponentColumn<CollectableItem>,
+  ComponentColumn<CollectableItemForCheat>,
+  ComponentColumn<CollidedWithWorld>,
+  ComponentColumn<CustomDamageApplication>,
+  ComponentColumn<DamageInflicting>,
+  ComponentColumn<DestructionEffects>,
+  ComponentColumn<DrawTopMost>,
+  ComponentColumn<DynamicGeometrySection>,
+  ComponentColumn<ExtendedFrameList>,
+  ComponentColumn<Interactable>,
+  ComponentColumn<InterpolateMotion>,
+  ComponentColumn<ItemBounceEffect>,
+  ComponentColumn<ItemContainer>,
+  ComponentColumn<MovementSequence>,
+  ComponentColumn<MovingBody>,
+  ComponentColumn<Orientation>,
+  ComponentColumn<OverrideDrawOrder>,
+  ComponentColumn<PlayerDamaging>,
+  ComponentColumn<PlayerProjectile>,
+  ComponentColumn<RadarDish>,
+  ComponentColumn<Shootable>,
+  ComponentColumn<SolidBody>,
+  ComponentColumn<Sprite>,
+  ComponentColumn<SpriteCascadeSpawner>,
+  ComponentColumn<SpriteStrip>,
+  ComponentColumn<TileDebris>,
+  ComponentColumn<WorldPosition>>;
+
+constexpr auto NUM_COMPONENT_TYPES = std::tuple_size_v<ComponentColumns>;
+
+template <std::size_t Index>
+using ComponentType = typename std::
+  tuple_element_t<Index, ComponentColumns>::value_type::second_type;
+
+using ComponentMask = std::bitset<NUM_COMPONENT_TYPES>;
+
+constexpr auto NO_BASE_ENTITY = std::numeric_limits<std::uint32_t>::max();
+
+
+struct EntityRecord
+{
+  entityx::Entity::Id mSourceId;
+
+  // All components of the entity, and the subset of those which are stored
+  // in this snapshot. The remaining ones are taken from the base.
+  ComponentMask mComponents;
+  ComponentMask mStoredComponents;
+  std::uint32_t mBaseIndex = NO_BASE_ENTITY;
+};
+
+
+template <typename Func, std::size_t... Indices>
+void forEachComponentTypeImpl(Func&& func, std::index_sequence<Indices...>)
+{
+  (func(std::integral_constant<std::size_t, Indices>{}), ...);
+}
+
+
+/** Invokes func with std::integral_constant<std::size_t, I> for the index I
+ * of each component type in ComponentColumns
+ */
+template <typename Func>
+void forEachComponentType(Func&& func)
+{
+  forEachComponentTypeImpl(
+    func, std::make_index_sequence<NUM_COMPONENT_TYPES>{});
+}
+
+
+template <typename T>
+const T* findComponent(
+  const ComponentColumn<T>& column,
+  const std::uint32_t entityIndex)
+{
+  const auto iEntry = std::lower_bound(
+    column.begin(),
+    column.end(),
+    entityIndex,
+    [](const auto& entry, const std::uint32_t index) {
+      return entry.first < index;
+    });
+
+  return iEntry != column.end() && iEntry->first == entityIndex
+    ? &iEntry->second
+    : nullptr;
+}
+
+
+// Comparisons may report false negatives (e.g. due to padding bytes), which
+// only means that a component is stored even though it could be taken from
+// the base.
+template <typename T>
+bool isSameComponent(const T& lhs, const T& rhs)
+{
+  if constexpr (std::is_trivially_copyable_v<T>)
+  {
+    return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+  }
+  else
+  {
+    return false;
+  }
+}
+
+
+bool isSameComponent(
+  const BehaviorController& lhs,
+  const BehaviorController& rhs)
+{
+  return lhs.hasSameStateAs(rhs);
+}
+
+
+bool isSameComponent(const ExtendedFrameList& lhs, const ExtendedFrameList& rhs)
+{
+  using RenderSpec = ExtendedFrameList::RenderSpec;
+  static_assert(std::is_trivially_copyable_v<RenderSpec>);
+
+  return lhs.mFrames.size() == rhs.mFrames.size() &&
+    std::memcmp(
+      lhs.mFrames.data(),
+      rhs.mFrames.data(),
+      lhs.mFrames.size() * sizeof(RenderSpec)) == 0;
+}
+
+
+bool isSameComponent(const ItemContainer& lhs, const ItemContainer& rhs)
+{
+  return lhs.mStyle == rhs.mStyle &&
+    lhs.mFramesElapsed == rhs.mFramesElapsed &&
+    lhs.mHasBeenShot == rhs.mHasBeenShot &&
+    std::equal(
+      lhs.mContainedComponents.begin(),
+      lhs.mContainedComponents.end(),
+      rhs.mContainedComponents.begin(),
+      rhs.mContainedComponents.end(),
+      [](const ComponentHolder& lhsItem, const ComponentHolder& rhsItem) {
+        return lhsItem.hasSameStateAs(rhsItem);
+      });
+}
+
+
+/** Heap memory owned by a component, in bytes */
+template <typename T>
+std::size_t heapMemoryUsage(const T&)
+{
+  static_assert(
+    std::is_trivially_copyable_v<T>,
+    "Components owning memory need a heapMemoryUsage() overload");
+  return 0;
+}
+
+
+std::size_t heapMemoryUsage(const BehaviorController& controller)
+{
+  return controller.stateSize();
+}
+
+
+std::size_t heapMemoryUsage(const DynamicGeometrySection& section)
+{
+  auto result = section.mBottomRowCopy.capacity() *
+    sizeof(decltype(section.mBottomRowCopy)::value_type);
+
+  if (section.mExtraSection)
+  {
+    result +=
+      section.mExtraSection->mMapData.capacity() * sizeof(std::uint32_t);
+  }
+
+  return result;
+}
+
+
+std::size_t heapMemoryUsage(const ExtendedFrameList& frameList)
+{
+  return frameList.mFrames.capacity() *
+    sizeof(ExtendedFrameList::RenderSpec);
+}
+
+
+std::size_t heapMemoryUsage(const ItemContainer& container)
+{
+  auto result =
+    container.mContainedComponents.capacity() * sizeof(ComponentHolder);
+
+  for (const auto& item : container.mContainedComponents)
+  {
+    result += item.size();
+  }
+
+  return result;
+}
+
+} // namespace
+
+
+struct EntitySnapshot::Data
+{
+  std::vector<EntityRecord> mEntities;
+  ComponentColumns mColumns;
+};
+
+
+EntitySnapshot::EntitySnapshot(
+  const entityx::EntityManager& entities,
+  const EntitySnapshot* pBase)
+  : mpData(std::make_unique<Data>())
+  , mpBase(pBase)
+{
+  assert(!pBase || !pBase->mpBase);
+
+  mpData->mEntities.reserve(entities.size());
+
+  // entities_for_debugging() visits entities in ascending order of their
+  // index, which keeps the records sorted for indexOf().
+  // clang-format off
+  for (
+    const auto entity :
+      const_cast<entityx::EntityManager&>(entities).entities_for_debugging())
+  // clang-format on
+  {
+    const auto entityIndex = std::uint32_t(mpData->mEntities.size());
+    const auto baseIndex = pBase ? pBase->indexOf(entity) : std::nullopt;
+
+    EntityRecord record;
+    record.mSourceId = entity.id();
+    if (baseIndex)
+    {
+      record.mBaseIndex = std::uint32_t(*baseIndex);
+    }
+
+    forEachComponentType([&](auto typeIndex) {
+      constexpr auto I = decltype(typeIndex)::value;
+      using T = ComponentType<I>;
+
+      if (!entity.has_component<T>())
+      {
+        return;
+      }
+
+      const auto& component = *entity.component<const T>();
+      const auto pBaseComponent = baseIndex
+        ? findComponent(std::get<I>(pBase->mpData->mColumns), *baseIndex)
+        : nullptr;
+
+      record.mComponents.set(I);
+      if (!pBaseComponent || !isSameComponent(component, *pBaseComponent))
+      {
+        std::get<I>(mpData->mColumns).emplace_back(entityIndex, component);
+        record.mStoredComponents.set(I);
+      }
+    });
+
+    // Catch component types missing from ComponentColumns
+    assert(record.mComponents.count() == entity.component_mask().count());
+
+    mpData->mEntities.push_back(record);
+  }
+}
+
+
+EntitySnapshot::~EntitySnapshot() = default;
+EntitySnapshot::EntitySnapshot(EntitySnapshot&&) noexcept = default;
+EntitySnapshot& EntitySnapshot::operator=(EntitySnapshot&&) noexcept =
+  default;
+
+
+std::vector<entityx::Entity>
+  EntitySnapshot::restore(entityx::EntityManager& entities) const
+{
+  entities.reset();
+
+  std::vector<entityx::Entity> result;
+  result.reserve(mpData->mEntities.size());
+
+  // Stored components are in the same order as the entities, so we can walk
+  // each column in step with the entities
+  std::array<std::size_t, NUM_COMPONENT_TYPES> nextStoredComponent{};
+
+  for (auto i = std::size_t{0}; i < mpData->mEntities.size(); ++i)
+  {
+    const auto& record = mpData->mEntities[i];
+    auto entity = entities.create();
+
+    forEachComponentType([&](auto typeIndex) {
+      constexpr auto I = decltype(typeIndex)::value;
+      using T = ComponentType<I>;
+
+      if (!record.mComponents.test(I))
+      {
+        return;
+      }
+
+      if (record.mStoredComponents.test(I))
+      {
+        const auto& column = std::get<I>(mpData->mColumns);
+        auto& next = nextStoredComponent[I];
+        assert(next < column.size() && column[next].first == i);
+
+        entity.assign<T>(column[next].second);
+        ++next;
+      }
+      else
+      {
+        assert(mpBase && record.mBaseIndex != NO_BASE_ENTITY);
+
+        const auto pComponent = findComponent(
+          std::get<I>(mpBase->mpData->mColumns), record.mBaseIndex);
+        assert(pComponent);
+
+        entity.assign<T>(*pComponent);
+      }
+    });
+
+    result.push_back(entity);
+  }
+
+  return result;
+}
+
+
+std::optional<std::size_t>
+  EntitySnapshot::indexOf(const entityx::Entity entity) const
+{
+  const auto& records = mpData->mEntities;
+  const auto id = entity.id();
+
+  const auto iRecord = std::lower_bound(
+    records.begin(),
+    records.end(),
+    id.index(),
+    [](const EntityRecord& record, const std::uint32_t index) {
+      return record.mSourceId.index() < index;
+    });
+
+  if (iRecord != records.end() && iRecord->mSourceId == id)
+  {
+    return std::size_t(std::distance(records.begin(), iRecord));
+  }
+
+  return std::nullopt;
+}
+
+
+std::size_t EntitySnapshot::memoryUsage() const
+{
+  auto result =
+    sizeof(Data) + mpData->mEntities.capacity() * sizeof(EntityRecord);
+
+  forEachComponentType([&](auto typeIndex) {
+    constexpr auto I = decltype(typeIndex)::value;
+    using T = ComponentType<I>;
+
+    const auto& column = std::get<I>(mpData->mColumns);
+    result += column.capacity() * sizeof(std::pair<std::uint32_t, T>);
+
+    if constexpr (!std::is_trivially_copyable_v<T>)
+    {
+      for (const auto& entry : column)
+      {
+        result += heapMemoryUsage(entry.second);
+      }
+    }
+  });
+
+  return result;
+}
+
+
+std::size_t EntitySnapshot::size() const
+{
+  return mpData->mEntities.size();
+}
+
+} // namespace rigel::game_logic
@@ -0,0 +1,84 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/warnings.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+
+namespace rigel::game_logic
+{
+
+/** Copy of all entities in an entity manager
+ *
+ * Only the component data is stored, in one array per component type. No
+ * entity manager is needed to hold the copy, which avoids allocating
+ * component pools for each snapshot.
+ *
+ * A snapshot can be recorded relative to a base snapshot. Components which
+ * are identical to those of the same entity in the base are then not stored
+ * again, but taken from the base when restoring. Since most entities don't
+ * change much from one frame to the next, this makes a snapshot recorded
+ * shortly after its base much smaller. The base must outlive all snapshots
+ * which refer to it, and can't have a base itself.
+ */
+class EntitySnapshot
+{
+public:
+  explicit EntitySnapshot(
+    const entityx::EntityManager& entities,
+    const EntitySnapshot* pBase = nullptr);
+  ~EntitySnapshot();
+
+  EntitySnapshot(EntitySnapshot&&) noexcept;
+  EntitySnapshot& operator=(EntitySnapshot&&) noexcept;
+
+  /** Replace all entities in the given manager with the recorded ones
+   *
+   * Returns the newly created entities, in the same order as indexOf()
+   * reports them.
+   */
+  std::vector<entityx::Entity> restore(entityx::EntityManager& entities) const;
+
+  /** Position of the given entity's copy, if it was recorded */
+  std::optional<std::size_t> indexOf(entityx::Entity entity) const;
+
+  /** Heap memory held by the snapshot, in bytes
+   *
+   * Doesn't include memory held by the base snapshot.
+   */
+  std::size_t memoryUsage() const;
+
+  std::size_t size() const;
+  const EntitySnapshot* base() const { return mpBase; }
+
+private:
+  struct Data;
+
+  std::unique_ptr<Data> mpData;
+  const EntitySnapshot* mpBase;
+};
+
+} // namespace rigel::game_logic
@@ -18,6 +18,7 @@
 
 #include "assets/resource_loader.hpp"
 #include "base/match.hpp"
+#include "base/profiler.hpp"
 #include "data/game_options.hpp"
 #include "data/game_traits.hpp"
 #include "data/map.hpp"
@@ -74,6 +75,10 @@ namespace
 
 constexpr auto BOSS_LEVEL_INTRO_MUSIC = "CALM.IMF";
 
+// Map tile blocks which aren't visible yet are built incrementally, a few
+// per frame
+constexpr auto MAP_BLOCKS_TO_BUILD_PER_FRAME = 2;
+
 constexpr auto HEALTH_BAR_LABEL_START_X = 0;
 constexpr auto HEALTH_BAR_LABEL_START_Y = 0;
 constexpr auto HEALTH_BAR_TILE_INDEX = 4 * 40 + 1;
@@ -264,45 +269,62 @@ base::Size clampedSectionSize(
 } // namespace
 
 
+GameWorld::RenderResources::RenderResources(
+  renderer::Renderer* pRenderer,
+  const assets::ResourceLoader& resources,
+  const data::GameOptions* pOptions,
+  const engine::SpriteFactory* pSpriteFactory,
+  const int levelNumber)
+  : mUiSpriteSheet(
+      renderer::Texture{pRenderer, resources.loadUiSpriteSheet()},
+      data::GameTraits::viewportSize,
+      pRenderer)
+  , mTextRenderer(&mUiSpriteSheet, pRenderer, resources)
+  , mHudRenderer(
+      levelNumber,
+      pOptions,
+      pRenderer,
+      &mUiSpriteSheet,
+      renderer::Texture{pRenderer, resources.loadWideHudFrameImage()},
+      renderer::Texture{pRenderer, resources.loadUltrawideHudFrameImage()},
+      pSpriteFactory)
+  , mSpecialEffects(pRenderer, *pOptions)
+  , mLowResLayer(
+      pRenderer,
+      renderer::determineWidescreenViewport(pRenderer).mWidthPx,
+      data::GameTraits::viewportHeightPx)
+{
+}
+
+
 GameWorld::GameWorld(
   data::PlayerModel* pPlayerModel,
   const data::GameSessionId& sessionId,
   GameMode::Context context,
   std::optional<base::Vec2> playerPositionOverride,
   bool showWelcomeMessage,
-  const PlayerInput& initialInput)
+  const PlayerInput& initialInput,
+  std::optional<data::map::LevelData> preloadedLevel)
   : mpRenderer(context.mpRenderer)
   , mpServiceProvider(context.mpServiceProvider)
-  , mUiSpriteSheet(
-      renderer::Texture{mpRenderer, context.mpResources->loadUiSpriteSheet()},
-      data::GameTraits::viewportSize,
-      mpRenderer)
-  , mTextRenderer(&mUiSpriteSheet, mpRenderer, *context.mpResources)
   , mpPlayerModel(pPlayerModel)
   , mpOptions(&context.mpUserProfile->mOptions)
   , mpResources(context.mpResources)
   , mpSpriteFactory(context.mpSpriteFactory)
   , mSessionId(sessionId)
   , mPlayerModelAtLevelStart(*mpPlayerModel)
-  , mHudRenderer(
-      sessionId.mLevel + 1,
-      mpOptions,
-      mpRenderer,
-      &mUiSpriteSheet,
-      renderer::Texture{
-        mpRenderer,
-        context.mpResources->loadWideHudFrameImage()},
-      renderer::Texture{
-        mpRenderer,
-        context.mpResources->loadUltrawideHudFrameImage()},
-      mpSpriteFactory)
-  , mMessageDisplay(mpServiceProvider, &mTextRenderer)
-  , mSpecialEffects(mpRenderer, *mpOptions)
-  , mLowResLayer(
-      mpRenderer,
-      renderer::determineWidescreenViewport(mpRenderer).mWidthPx,
-      data::GameTraits::viewportHeightPx)
-  , mPreviousWindowSize(mpRenderer->windowSize())
+  , mpRenderResources(
+      mpRenderer ? std::make_unique<RenderResources>(
+                     mpRenderer,
+                     *context.mpResources,
+                     mpOptions,
+                     mpSpriteFactory,
+                     sessionId.mLevel + 1)
+                 : nullptr)
+  , mMessageDisplay(
+      mpServiceProvider,
+      mpRenderResources ? &mpRenderResources->mTextRenderer : nullptr)
+  , mPreviousWindowSize(mpRenderer ? mpRenderer->windowSize() : base::Size{})
   , mPreviousHudStyle(mpOptions->mWidescreenHudStyle)
   , mWidescreenModeWasOn(widescreenModeOn())
   , mPerElementUpscalingWasEnabled(mpOptions->mPerElementUpscalingEnabled)
@@ -310,7 +332,7 @@ GameWorld::GameWorld(
 {
   LOG_SCOPE_FUNCTION(INFO);
 
-  loadLevel(initialInput);
+  loadLevel(initialInput, std::move(preloadedLevel));
 
   if (playerPositionOverride)
   {
@@ -532,9 +554,11 @@ void GameWorld::receive(const rigel::events::CloakExpired&)
 }
 
 
-void GameWorld::loadLevel(const PlayerInput& initialInput)
+void GameWorld::loadLevel(
+  const PlayerInput& initialInput,
+  std::optional<data::map::LevelData> preloadedLevel)
 {
-  createNewState();
+  createNewState(std::move(preloadedLevel));
 
   mpState->mCamera.centerViewOnPlayer();
   updateGameLogic(initialInput);
@@ -551,21 +575,37 @@ void GameWorld::loadLevel(const PlayerInput& initialInput)
 }
 
 
-void GameWorld::createNewState()
+void GameWorld::createNewState(
+  std::optional<data::map::LevelData> preloadedLevel)
 {
   if (mpState)
   {
     unsubscribe(mpState->mEventManager);
   }
 
-  mpState = std::make_unique<WorldState>(
-    mpServiceProvider,
-    mpRenderer,
-    mpResources,
-    mpPlayerModel,
-    mpOptions,
-    mpSpriteFactory,
-    mSessionId);
+  if (preloadedLevel)
+  {
+    mpState = std::make_unique<WorldState>(
+      mpServiceProvider,
+      mpRenderer,
+      mpResources,
+      mpPlayerModel,
+      mpOptions,
+      mpSpriteFactory,
+      mSessionId,
+      std::move(*preloadedLevel));
+  }
+  else
+  {
+    mpState = std::make_unique<WorldState>(
+      mpServiceProvider,
+      mpRenderer,
+      mpResources,
+      mpPlayerModel,
+      mpOptions,
+      mpSpriteFactory,
+      mSessionId);
+  }
 
   subscribe(mpState->mEventManager);
 }
@@ -611,14 +651,33 @@ void GameWorld::unsubscribe(entityx::EventManager& eventManager)
 
 bool GameWorld::needsPerElementUpscaling() const
 {
+  if (isHeadless())
+  {
+    return false;
+  }
+
   return mpSpriteFactory->hasHighResReplacements() ||
-    mpState->mMapRenderer.hasHighResReplacements() ||
-    mUiSpriteSheet.isHighRes();
+    mpState->mMapRenderer->hasHighResReplacements() ||
+    mpRenderResources->mUiSpriteSheet.isHighRes();
 }
 
 
 void GameWorld::updateGameLogic(const PlayerInput& input)
 {
+  RIGEL_PROFILE_ZONE("Game logic");
+
+  if (mpOptions->mRewindEnabled)
+  {
+    RIGEL_PROFILE_ZONE("Record rewind history");
+    mRewindBuffer.setMemoryBudget(mpOptions->rewindMemoryBudgetInBytes());
+    mRewindBuffer.record(*mpState, *mpPlayerModel);
+  }
+  else if (!mRewindBuffer.empty())
+  {
+    // Give the memory back right away when rewinding is turned off
+    mRewindBuffer.clear();
+  }
+
   mpState->mBackdropFlashColor = std::nullopt;
   mpState->mScreenFlashColor = std::nullopt;
 
@@ -632,7 +691,11 @@ void GameWorld::updateGameLogic(const PlayerInput& input)
     mpState->mEarthQuakeEffect->update();
   }
 
-  mHudRenderer.updateAnimation();
+  if (mpRenderResources)
+  {
+    mpRenderResources->mHudRenderer.updateAnimation();
+  }
+
   mMessageDisplay.update();
 
   updateMotionSmoothingStates();
@@ -651,55 +714,108 @@ void GameWorld::updateGameLogic(const PlayerInput& input)
     ? viewportSizeWideScreen(mpRenderer, *mpOptions)
     : data::GameTraits::mapViewportSize;
 
-  mpState->mMapRenderer.updateAnimatedMapTiles();
-  engine::updateAnimatedSprites(mpState->mEntities);
-  ++mpState->mWaterAnimStep;
-  if (mpState->mWaterAnimStep >= 4)
   {
-    mpState->mWaterAnimStep = 0;
+    RIGEL_PROFILE_ZONE("Animation");
+
+    if (mpState->mMapRenderer)
+    {
+      mpState->mMapRenderer->updateAnimatedMapTiles();
+    }
+
+    engine::updateAnimatedSprites(mpState->mEntities);
+    ++mpState->mWaterAnimStep;
+    if (mpState->mWaterAnimStep >= 4)
+    {
+      mpState->mWaterAnimStep = 0;
+    }
   }
 
-  mpState->mPlayerInteractionSystem.updatePlayerInteraction(
-    input, mpState->mEntities);
-  mpState->mPlayer.update(input);
-  mpState->mPreviousCameraPosition = mpState->mCamera.position();
-  mpState->mCamera.update(input, viewportSize);
-
-  engine::markActiveEntities(
-    mpState->mEntities, mpState->mCamera.position(), viewportSize);
-  mpState->mBehaviorControllerSystem.update(
-    mpState->mEntities,
-    PerFrameState{
-      input,
-      viewportSize,
-      mpState->mRadarDishCounter.numRadarDishes(),
-      mpState->mIsOddFrame,
-      mpState->mEarthQuakeEffect && mpState->mEarthQuakeEffect->isQuaking()});
-
-  mpState->mPhysicsSystem.updatePhase1(mpState->mEntities);
-
-  // Collect items after physics, so that any collectible
-  // items are in their final positions for this frame.
-  mpState->mItemContainerSystem.updateItemBounce(mpState->mEntities);
-  mpState->mPlayerInteractionSystem.updateItemCollection(mpState->mEntities);
-  mpState->mPlayerDamageSystem.update(mpState->mEntities);
-  mpState->mDamageInflictionSystem.update(mpState->mEntities);
-  mpState->mItemContainerSystem.update(mpState->mEntities);
-  mpState->mPlayerProjectileSystem.update(mpState->mEntities);
-
-  mpState->mEffectsSystem.update(mpState->mEntities);
-  mpState->mLifeTimeSystem.update(
-    mpState->mEntities, mpState->mCamera.position(), viewportSize);
-
-  // Now process any MovingBody objects that have been spawned after phase 1
-  mpState->mPhysicsSystem.updatePhase2(mpState->mEntities);
-
-  mpState->mParticles.update();
+  {
+    RIGEL_PROFILE_ZONE("Player & camera");
+
+    mpState->mPlayerInteractionSystem.updatePlayerInteraction(
+      input, mpState->mEntities);
+    mpState->mPlayer.update(input);
+    mpState->mPreviousCameraPosition = mpState->mCamera.position();
+    mpState->mCamera.update(input, viewportSize);
+  }
+
+  {
+    RIGEL_PROFILE_ZONE("Entity activation");
+    mpState->mEntityActivationSystem.update(
+      mpState->mCamera.position(), viewportSize);
+  }
+
+  {
+    RIGEL_PROFILE_ZONE("Behavior controllers");
+    mpState->mBehaviorControllerSystem.update(
+      mpState->mEntities,
+      PerFrameState{
+        input,
+        viewportSize,
+        mpState->mRadarDishCounter.numRadarDishes(),
+        mpState->mIsOddFrame,
+        mpState->mEarthQuakeEffect && mpState->mEarthQuakeEffect->isQuaking()});
+  }
+
+  {
+    RIGEL_PROFILE_ZONE("Physics phase 1");
+    mpState->mPhysicsSystem.updatePhase1(mpState->mEntities);
+    mpState->mPhysicsSystem.flushCollisionEvents();
+  }
+
+  {
+    RIGEL_PROFILE_ZONE("Item collection");
+
+    // Collect items after physics, so that any collectible
+    // items are in their final positions for this frame.
+    mpState->mItemContainerSystem.updateItemBounce(mpState->mEntities);
+    mpState->mPlayerInteractionSystem.updateItemCollection(mpState->mEntities);
+  }
+
+  {
+    RIGEL_PROFILE_ZONE("Player damage");
+    mpState->mPlayerDamageSystem.update(mpState->mEntities);
+  }
+
+  {
+    RIGEL_PROFILE_ZONE("Damage infliction");
+    mpState->mDamageInflictionSystem.update(mpState->mEntities);
+  }
 
-  if (!mpOptions->mMotionSmoothing)
   {
+    RIGEL_PROFILE_ZONE("Item containers & projectiles");
+    mpState->mItemContainerSystem.update(mpState->mEntities);
+    mpState->mPlayerProjectileSystem.update(mpState->mEntities);
+  }
+
+  {
+    RIGEL_PROFILE_ZONE("Effects & life time");
+    mpState->mEffectsSystem.update(mpState->mEntities);
+    mpState->mLifeTimeSystem.update(
+      mpState->mEntities, mpState->mCamera.position(), viewportSize);
+  }
+
+  {
+    RIGEL_PROFILE_ZONE("Physics phase 2");
+
+    // Now process any MovingBody objects that have been spawned after phase 1
+    mpState->mPhysicsSystem.updatePhase2(mpState->mEntities);
+    mpState->mPhysicsSystem.flushCollisionEvents();
+  }
+
+  {
+    RIGEL_PROFILE_ZONE("Particles");
+    mpState->mParticles.update();
+  }
+
+  mpState->mSpriteRenderingSystem.invalidateSpatialIndex();
+
+  if (!isHeadless() && !mpOptions->mMotionSmoothing)
+  {
+    RIGEL_PROFILE_ZONE("Sprite list update");
     mpState->mSpriteRenderingSystem.update(
-      mpState->mEntities, viewportSize, mpState->mCamera.position(), 1.0f);
+      viewportSize, mpState->mCamera.position(), 1.0f);
   }
 
   mpState->mIsOddFrame = !mpState->mIsOddFrame;
@@ -708,12 +824,21 @@ void GameWorld::updateGameLogic(const PlayerInput& input)
 
 void GameWorld::render(const float interpolationFactor)
 {
+  if (isHeadless())
+  {
+    return;
+  }
+
+  RIGEL_PROFILE_ZONE("World rendering");
+
+  auto& resources = *mpRenderResources;
+
   if (
     widescreenModeOn() != mWidescreenModeWasOn ||
     mpOptions->mPerElementUpscalingEnabled != mPerElementUpscalingWasEnabled ||
     mPreviousWindowSize != mpRenderer->windowSize())
   {
-    mSpecialEffects.rebuildBackgroundBuffer(*mpOptions);
+    resources.mSpecialEffects.rebuildBackgroundBuffer(*mpOptions);
   }
 
   if (
@@ -748,6 +873,7 @@ void GameWorld::render(const float interpolationFactor)
 
   auto drawParticlesAndDebugOverlay =
     [&](const ViewportParams& viewportParams) {
+      RIGEL_PROFILE_ZONE("Particles & debug overlay");
       renderer::setLocalTranslation(mpRenderer, viewportParams.mCameraOffset);
       mpState->mParticles.render(
         viewportParams.mRenderStartPosition, interpolationFactor);
@@ -777,12 +903,12 @@ void GameWorld::render(const float interpolationFactor)
       drawMapAndSprites(viewportParams, interpolationFactor);
 
       {
-        const auto saved = mLowResLayer.bindAndReset();
+        const auto saved = resources.mLowResLayer.bindAndReset();
         mpRenderer->clear({0, 0, 0, 0});
         drawParticlesAndDebugOverlay(viewportParams);
       }
 
-      mLowResLayer.render(0, 0);
+      resources.mLowResLayer.render(0, 0);
     }
     else
     {
@@ -799,7 +925,8 @@ void GameWorld::render(const float interpolationFactor)
       const auto maxHealthBarSize = maxWidthPx - HEALTH_BAR_START_PX.x;
       if (mpState->mBossStartingHealth <= maxHealthBarSize)
       {
-        drawBossHealthBar(health, mTextRenderer, mUiSpriteSheet);
+        drawBossHealthBar(
+          health, resources.mTextRenderer, resources.mUiSpriteSheet);
       }
       else
       {
@@ -807,7 +934,10 @@ void GameWorld::render(const float interpolationFactor)
           float(health) / mpState->mBossStartingHealth;
         const auto healthPercentagePx =
           base::round(healthPercentage * maxHealthBarSize);
-        drawBossHealthBar(healthPercentagePx, mTextRenderer, mUiSpriteSheet);
+        drawBossHealthBar(
+          healthPercentagePx,
+          resources.mTextRenderer,
+          resources.mUiSpriteSheet);
       }
     }
     else
@@ -817,15 +947,17 @@ void GameWorld::render(const float interpolationFactor)
   };
 
   auto drawHud = [&, this]() {
+    RIGEL_PROFILE_ZONE("HUD");
     const auto radarDots =
       collectRadarDots(mpState->mEntities, mpState->mPlayer.orientedPosition());
-    mHudRenderer.renderClassicHud(*mpPlayerModel, radarDots);
+    resources.mHudRenderer.renderClassicHud(*mpPlayerModel, radarDots);
   };
 
   auto drawWidescreenHud = [&](const int viewportWidth) {
+    RIGEL_PROFILE_ZONE("HUD");
     const auto radarDots =
       collectRadarDots(mpState->mEntities, mpState->mPlayer.orientedPosition());
-    mHudRenderer.renderWidescreenHud(
+    resources.mHudRenderer.renderWidescreenHud(
       viewportWidth, mpOptions->mWidescreenHudStyle, *mpPlayerModel, radarDots);
   };
 
@@ -840,7 +972,7 @@ void GameWorld::render(const float interpolationFactor)
     if (!mWidescreenModeWasOn && !mpOptions->mMotionSmoothing)
     {
       mpState->mSpriteRenderingSystem.update(
-        mpState->mEntities, viewportSize, mpState->mCamera.position(), 1.0f);
+        viewportSize, mpState->mCamera.position(), 1.0f);
     }
 
     if (mpOptions->mPerElementUpscalingEnabled)
@@ -979,9 +1111,14 @@ void GameWorld::drawMapAndSprites(
 {
   using game_logic::components::TileDebris;
 
+  RIGEL_PROFILE_ZONE("Map & sprites");
+
   auto& state = *mpState;
+  auto& mapRenderer = *state.mMapRenderer;
+  auto& specialEffects = mpRenderResources->mSpecialEffects;
 
   auto renderBackdrop = [&]() {
+    RIGEL_PROFILE_ZONE("Backdrop");
     if (state.mBackdropFlashColor)
     {
       mpRenderer->drawFilledRectangle(
@@ -990,7 +1127,7 @@ void GameWorld::drawMapAndSprites(
     }
     else
     {
-      state.mMapRenderer.renderBackdrop(
+      mapRenderer.renderBackdrop(
         params.mInterpolatedCameraPosition, params.mViewportSize);
     }
   };
@@ -1001,26 +1138,28 @@ void GameWorld::drawMapAndSprites(
         entityx::Entity e, const TileDebris& debris, const WorldPosition& pos) {
         const auto pixelPosition =
           engine::interpolatedPixelPosition(e, interpolationFactor);
-        state.mMapRenderer.renderSingleTile(
+        mapRenderer.renderSingleTile(
           debris.mTileIndex,
           pixelPosition - data::tilesToPixels(params.mRenderStartPosition));
       });
   };
 
   auto renderBackgroundLayers = [&]() {
-    state.mMapRenderer.renderBackground(
+    RIGEL_PROFILE_ZONE("Background layers");
+    mapRenderer.renderBackground(
       params.mRenderStartPosition, params.mViewportSize);
     state.mDynamicGeometrySystem.renderDynamicBackgroundSections(
       params.mRenderStartPosition, params.mViewportSize, interpolationFactor);
-    state.mSpriteRenderingSystem.renderRegularSprites(mSpecialEffects);
+    state.mSpriteRenderingSystem.renderRegularSprites(specialEffects);
   };
 
   auto renderForegroundLayers = [&]() {
-    state.mMapRenderer.renderForeground(
+    RIGEL_PROFILE_ZONE("Foreground layers");
+    mapRenderer.renderForeground(
       params.mRenderStartPosition, params.mViewportSize);
     state.mDynamicGeometrySystem.renderDynamicForegroundSections(
       params.mRenderStartPosition, params.mViewportSize, interpolationFactor);
-    state.mSpriteRenderingSystem.renderForegroundSprites(mSpecialEffects);
+    state.mSpriteRenderingSystem.renderForegroundSprites(specialEffects);
     renderTileDebris();
   };
 
@@ -1029,8 +1168,8 @@ void GameWorld::drawMapAndSprites(
 
   if (mpOptions->mMotionSmoothing)
   {
+    RIGEL_PROFILE_ZONE("Sprite list update");
     mpState->mSpriteRenderingSystem.update(
-      mpState->mEntities,
       params.mViewportSize,
       params.mRenderStartPosition,
       interpolationFactor);
@@ -1051,26 +1190,28 @@ void GameWorld::drawMapAndSprites(
   else
   {
     {
-      auto saved = mSpecialEffects.bindBackgroundBuffer();
+      auto saved = specialEffects.bindBackgroundBuffer();
       renderBackdrop();
 
       renderer::setLocalTranslation(mpRenderer, params.mCameraOffset);
       renderBackgroundLayers();
     }
 
-    mSpecialEffects.drawBackgroundBuffer();
+    specialEffects.drawBackgroundBuffer();
 
     renderer::setLocalTranslation(mpRenderer, params.mCameraOffset);
 
-    mSpecialEffects.drawWaterEffect(waterEffectAreas, state.mWaterAnimStep);
+    specialEffects.drawWaterEffect(waterEffectAreas, state.mWaterAnimStep);
     renderForegroundLayers();
   }
+
+  mapRenderer.buildPendingBlocks(MAP_BLOCKS_TO_BUILD_PER_FRAME);
 }
 
 
 bool GameWorld::widescreenModeOn() const
 {
-  return mpOptions->mWidescreenModeOn &&
+  return !isHeadless() && mpOptions->mWidescreenModeOn &&
     renderer::canUseWidescreenMode(mpRenderer);
 }
 
@@ -1154,19 +1295,8 @@ void GameWorld::quickSave()
 
   LOG_F(INFO, "Creating quick save");
 
-  auto pStateCopy = std::make_unique<WorldState>(
-    mpServiceProvider,
-    mpRenderer,
-    mpResources,
-    mpPlayerModel,
-    mpOptions,
-    mpSpriteFactory,
-    mSessionId);
-  pStateCopy->synchronizeTo(
-    *mpState, mpServiceProvider, mpPlayerModel, mSessionId);
-
-  mpQuickSave = std::make_unique<QuickSaveData>(
-    QuickSaveData{*mpPlayerModel, std::move(pStateCopy)});
+  mpQuickSave = std::make_unique<QuickSaveData>(QuickSaveData{
+    *mpPlayerModel, std::make_unique<WorldSnapshot>(*mpState)});
 
   mMessageDisplay.setMessage("Quick saved.");
 
@@ -1184,20 +1314,11 @@ void GameWorld::quickLoad()
   LOG_F(INFO, "Loading quick save");
 
   *mpPlayerModel = mpQuickSave->mPlayerModel;
-  mpState->synchronizeTo(
-    *mpQuickSave->mpState, mpServiceProvider, mpPlayerModel, mSessionId);
-  mpState->mPreviousCameraPosition = mpState->mCamera.position();
+  mpState->restoreSnapshot(
+    *mpQuickSave->mpSnapshot, mpServiceProvider, mpPlayerModel, mSessionId);
+  onStateRestored();
   mMessageDisplay.setMessage("Quick save restored.");
 
-  if (!mpOptions->mMotionSmoothing)
-  {
-    const auto& viewportSize = widescreenModeOn()
-      ? viewportSizeWideScreen(mpRenderer, *mpOptions)
-      : data::GameTraits::mapViewportSize;
-    mpState->mSpriteRenderingSystem.update(
-      mpState->mEntities, viewportSize, mpState->mCamera.position(), 1.0f);
-  }
-
   LOG_F(INFO, "Quick save loaded");
 }
 
@@ -1208,6 +1329,45 @@ bool GameWorld::canQuickLoad() const
 }
 
 
+void GameWorld::rewind()
+{
+  if (!canRewind())
+  {
+    return;
+  }
+
+  mRewindBuffer.rewind(*mpState, *mpPlayerModel, mpServiceProvider, mSessionId);
+  onStateRestored();
+}
+
+
+bool GameWorld::canRewind() const
+{
+  return mpOptions->mRewindEnabled && !mRewindBuffer.empty();
+}
+
+
+void GameWorld::onStateRestored()
+{
+  mpState->mPreviousCameraPosition = mpState->mCamera.position();
+  mpState->mSpriteRenderingSystem.invalidateSpatialIndex();
+
+  if (isHeadless())
+  {
+    return;
+  }
+
+  if (!mpOptions->mMotionSmoothing)
+  {
+    const auto& viewportSize = widescreenModeOn()
+      ? viewportSizeWideScreen(mpRenderer, *mpOptions)
+      : data::GameTraits::mapViewportSize;
+    mpState->mSpriteRenderingSystem.update(
+      viewportSize, mpState->mCamera.position(), 1.0f);
+  }
+}
+
+
 void GameWorld::onReactorDestroyed(const base::Vec2& position)
 {
   flashScreen(data::GameTraits::INGAME_PALETTE[7]);
@@ -1225,7 +1385,11 @@ void GameWorld::onReactorDestroyed(const base::Vec2& position)
     data::map::BackdropSwitchCondition::OnReactorDestruction;
   if (!mpState->mReactorDestructionFramesElapsed && shouldDoSpecialEvent)
   {
-    mpState->mMapRenderer.switchBackdrops();
+    if (mpState->mMapRenderer)
+    {
+      mpState->mMapRenderer->switchBackdrops();
+    }
+
     mpState->mBackdropSwitched = true;
     mpState->mReactorDestructionFramesElapsed = 0;
   }
@@ -1303,7 +1467,11 @@ void GameWorld::restartFromCheckpoint()
     data::map::BackdropSwitchCondition::OnTeleportation;
   if (mpState->mBackdropSwitched && shouldSwitchBackAfterRespawn)
   {
-    mpState->mMapRenderer.switchBackdrops();
+    if (mpState->mMapRenderer)
+    {
+      mpState->mMapRenderer->switchBackdrops();
+    }
+
     mpState->mBackdropSwitched = false;
   }
 
@@ -1335,7 +1503,11 @@ void GameWorld::handleTeleporter()
     data::map::BackdropSwitchCondition::OnTeleportation;
   if (switchBackdrop)
   {
-    mpState->mMapRenderer.switchBackdrops();
+    if (mpState->mMapRenderer)
+    {
+      mpState->mMapRenderer->switchBackdrops();
+    }
+
     mpState->mBackdropSwitched = !mpState->mBackdropSwitched;
   }
 
@@ -1370,7 +1542,14 @@ void GameWorld::printDebugText(std::ostream& stream) const
 {
   stream << "Scroll: " << vec2String(mpState->mCamera.position(), 4) << '\n'
          << "Player: " << vec2String(mpState->mPlayer.position(), 4) << '\n'
-         << "Entities: " << mpState->mEntities.size() << '\n';
+         << "Entities: " << mpState->mEntities.size() << " ("
+         << mpState->mEntityActivationSystem.numActiveEntities() << " active, "
+         << mpState->mEntityActivationSystem.numVisitedEntities()
+         << " visited)\n"
+         << "Sprites: "
+         << mpState->mSpriteRenderingSystem.numVisibleSprites() << " visible, "
+         << mpState->mSpriteRenderingSystem.numVisitedEntities()
+         << " entities visited\n";
 
   if (mpOptions->mPerElementUpscalingEnabled)
   {
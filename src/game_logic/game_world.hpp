@@ -21,6 +21,7 @@
 #include "base/warnings.hpp"
 #include "data/bonus.hpp"
 #include "data/game_session_data.hpp"
+#include "data/map.hpp"
 #include "data/player_model.hpp"
 #include "data/tutorial_messages.hpp"
 #include "engine/graphical_effects.hpp"
@@ -29,6 +30,7 @@
 #include "game_logic/damage_components.hpp"
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic/input.hpp"
+#include "game_logic/rewind_buffer.hpp"
 #include "ui/hud_renderer.hpp"
 #include "ui/ingame_message_display.hpp"
 #include "ui/menu_element_renderer.hpp"
@@ -49,10 +51,6 @@ namespace rigel::data
 {
 struct GameOptions;
 }
-namespace rigel::data::map
-{
-struct LevelData;
-}
 
 
 namespace rigel::game_logic
@@ -69,18 +67,29 @@ namespace rigel::game_logic
 constexpr auto GAME_LOGIC_UPDATE_DELAY = 1.0 / 15.0;
 
 
+class HeadlessSimulation;
+struct WorldSnapshot;
 struct WorldState;
 
 class GameWorld : public entityx::Receiver<GameWorld>
 {
 public:
+  /** Load the given level and set up everything needed to play it
+   *
+   * If context.mpRenderer is nullptr, the world runs in headless mode:
+   * No textures, HUD or special effects resources are created, render()
+   * does nothing, and only the game logic is updated by updateGameLogic().
+   * This makes it possible to simulate levels on machines without a GPU.
+   * In headless mode, the world always behaves as if widescreen mode was off.
+   */
   GameWorld(
     data::PlayerModel* pPlayerModel,
     const data::GameSessionId& sessionId,
     GameMode::Context context,
     std::optional<base::Vec2> playerPositionOverride = std::nullopt,
     bool showWelcomeMessage = false,
-    const PlayerInput& initialInput = PlayerInput{});
+    const PlayerInput& initialInput = PlayerInput{},
+    std::optional<data::map::LevelData> preloadedLevel = std::nullopt);
   ~GameWorld(); // NOLINT
 
   bool levelFinished() const;
@@ -101,6 +110,7 @@ public:
   void receive(const rigel::events::CloakPickedUp& event);
   void receive(const rigel::events::CloakExpired& event);
 
+  bool isHeadless() const { return mpRenderer == nullptr; }
   bool needsPerElementUpscaling() const;
   void updateGameLogic(const PlayerInput& input);
   void render(float interpolationFactor = 0.0f);
@@ -113,7 +123,12 @@ public:
   void quickLoad();
   bool canQuickLoad() const;
 
+  /** Go back by one game logic frame, if there is recorded history left */
+  void rewind();
+  bool canRewind() const;
+
   friend class rigel::GameRunner;
+  friend class HeadlessSimulation;
 
 private:
   struct ViewportParams
@@ -125,8 +140,10 @@ private:
     base::Size mViewportSize;
   };
 
-  void loadLevel(const PlayerInput& initialInput);
-  void createNewState();
+  void loadLevel(
+    const PlayerInput& initialInput,
+    std::optional<data::map::LevelData> preloadedLevel = std::nullopt);
+  void createNewState(std::optional<data::map::LevelData> preloadedLevel);
   void subscribe(entityx::EventManager& eventManager);
   void unsubscribe(entityx::EventManager& eventManager);
 
@@ -141,6 +158,7 @@ private:
   void updateTemporaryItemExpiration();
   void showTutorialMessage(const data::TutorialMessageId id);
   void flashScreen(const base::Color& color);
+  void onStateRestored();
 
   void printDebugText(std::ostream& stream) const;
 
@@ -156,13 +174,29 @@ private:
   struct QuickSaveData
   {
     data::PlayerModel mPlayerModel;
-    std::unique_ptr<WorldState> mpState;
+    std::unique_ptr<WorldSnapshot> mpSnapshot;
+  };
+
+  // Everything that's only needed for rendering. Not created in headless
+  // mode.
+  struct RenderResources
+  {
+    RenderResources(
+      renderer::Renderer* pRenderer,
+      const assets::ResourceLoader& resources,
+      const data::GameOptions* pOptions,
+      const engine::SpriteFactory* pSpriteFactory,
+      int levelNumber);
+
+    engine::TiledTexture mUiSpriteSheet;
+    ui::MenuElementRenderer mTextRenderer;
+    ui::HudRenderer mHudRenderer;
+    engine::SpecialEffectsRenderer mSpecialEffects;
+    renderer::RenderTargetTexture mLowResLayer;
   };
 
   renderer::Renderer* mpRenderer;
   IGameServiceProvider* mpServiceProvider;
-  engine::TiledTexture mUiSpriteSheet;
-  ui::MenuElementRenderer mTextRenderer;
   data::PlayerModel* mpPlayerModel;
   const data::GameOptions* mpOptions;
   const assets::ResourceLoader* mpResources;
@@ -170,10 +204,8 @@ private:
   data::GameSessionId mSessionId;
 
   data::PlayerModel mPlayerModelAtLevelStart;
-  ui::HudRenderer mHudRenderer;
+  std::unique_ptr<RenderResources> mpRenderResources;
   ui::IngameMessageDisplay mMessageDisplay;
-  engine::SpecialEffectsRenderer mSpecialEffects;
-  renderer::RenderTargetTexture mLowResLayer;
   base::Size mPreviousWindowSize;
   data::WidescreenHudStyle mPreviousHudStyle;
   bool mWidescreenModeWasOn;
@@ -182,6 +214,7 @@ private:
 
   std::unique_ptr<WorldState> mpState;
   std::unique_ptr<QuickSaveData> mpQuickSave;
+  RewindBuffer mRewindBuffer{mpOptions->rewindMemoryBudgetInBytes()};
 };
 
 } // namespace rigel::game_logic
@@ -0,0 +1,125 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "headless_simulation.hpp"
+
+#include "assets/resource_loader.hpp"
+#include "frontend/game_service_provider.hpp"
+#include "frontend/user_profile.hpp"
+#include "game_logic/game_world.hpp"
+#include "game_logic/world_state.hpp"
+
+
+namespace rigel::game_logic
+{
+
+namespace
+{
+
+std::unique_ptr<UserProfile>
+  makeHeadlessProfile(const data::GameOptions& options)
+{
+  auto pProfile = std::make_unique<UserProfile>();
+  pProfile->mOptions = options;
+
+  // Motion smoothing only affects rendering, skip the extra bookkeeping
+  pProfile->mOptions.mMotionSmoothing = false;
+  return pProfile;
+}
+
+} // namespace
+
+
+HeadlessSimulation::HeadlessSimulation(
+  const assets::ResourceLoader* pResources,
+  const data::GameSessionId& sessionId,
+  const data::GameOptions& options,
+  const data::PlayerModel& playerModel)
+  : mpServiceProvider(std::make_unique<NullServiceProvider>())
+  , mpUserProfile(makeHeadlessProfile(options))
+  , mSpriteFactory(nullptr, pResources)
+  , mPlayerModel(playerModel)
+  , mpWorld(std::make_unique<GameWorld>(
+      &mPlayerModel,
+      sessionId,
+      GameMode::Context{
+        pResources,
+        nullptr,
+        mpServiceProvider.get(),
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr,
+        &mSpriteFactory,
+        mpUserProfile.get()}))
+{
+}
+
+
+HeadlessSimulation::~HeadlessSimulation() = default;
+
+
+bool HeadlessSimulation::step(const PlayerInput& input)
+{
+  if (levelFinished())
+  {
+    return true;
+  }
+
+  mpWorld->updateGameLogic(input);
+  mpWorld->processEndOfFrameActions();
+  ++mFramesSimulated;
+
+  return levelFinished();
+}
+
+
+SimulationResult
+  HeadlessSimulation::run(const base::ArrayView<PlayerInput> inputs)
+{
+  for (const auto& input : inputs)
+  {
+    if (step(input))
+    {
+      break;
+    }
+  }
+
+  return result();
+}
+
+
+bool HeadlessSimulation::levelFinished() const
+{
+  return mpWorld->levelFinished();
+}
+
+
+SimulationResult HeadlessSimulation::result() const
+{
+  const auto& state = *mpWorld->mpState;
+
+  return SimulationResult{
+    mFramesSimulated,
+    levelFinished(),
+    mpWorld->achievedBonuses(),
+    mPlayerModel,
+    state.mPlayer.position(),
+    state.mCamera.position(),
+    state.mEntities.size()};
+}
+
+} // namespace rigel::game_logic
@@ -0,0 +1,115 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/array_view.hpp"
+#include "base/spatial_types.hpp"
+#include "data/bonus.hpp"
+#include "data/game_options.hpp"
+#include "data/game_session_data.hpp"
+#include "data/player_model.hpp"
+#include "engine/sprite_factory.hpp"
+#include "game_logic/input.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <set>
+
+
+namespace rigel
+{
+struct IGameServiceProvider;
+class UserProfile;
+}
+namespace rigel::assets
+{
+class ResourceLoader;
+}
+
+
+namespace rigel::game_logic
+{
+
+class GameWorld;
+
+
+struct SimulationResult
+{
+  std::size_t mFramesSimulated = 0;
+  bool mLevelFinished = false;
+  std::set<data::Bonus> mAchievedBonuses;
+  data::PlayerModel mPlayerModel;
+
+  // Snapshot of the world at the end of the simulation, for comparing runs
+  base::Vec2 mPlayerPosition;
+  base::Vec2 mCameraPosition;
+  std::size_t mNumEntities = 0;
+};
+
+
+/** Runs a level's game logic without rendering or audio output
+ *
+ * Creates a GameWorld in headless mode, and feeds it player input one logic
+ * frame at a time. Unlike the regular game, there is no waiting for
+ * GAME_LOGIC_UPDATE_DELAY to elapse between updates, so levels are simulated
+ * as fast as the CPU allows. This does not require an OpenGL context, and is
+ * meant for replays, regression tests and balancing runs.
+ *
+ * Since all randomness in the game logic comes from the deterministic
+ * RandomNumberGenerator, simulating the same input sequence twice produces
+ * the same result.
+ */
+class HeadlessSimulation
+{
+public:
+  HeadlessSimulation(
+    const assets::ResourceLoader* pResources,
+    const data::GameSessionId& sessionId,
+    const data::GameOptions& options = {},
+    const data::PlayerModel& playerModel = {});
+  ~HeadlessSimulation();
+
+  /** Run a single logic frame using the given input
+   *
+   * Does nothing once the level has been finished. Returns true if the level
+   * was finished by this frame (or earlier).
+   */
+  bool step(const PlayerInput& input);
+
+  /** Run one logic frame per given input, back to back
+   *
+   * Stops early if the level is finished before all inputs have been
+   * consumed.
+   */
+  SimulationResult run(base::ArrayView<PlayerInput> inputs);
+
+  bool levelFinished() const;
+  std::size_t framesSimulated() const { return mFramesSimulated; }
+  SimulationResult result() const;
+
+  const GameWorld& world() const { return *mpWorld; }
+
+private:
+  std::unique_ptr<IGameServiceProvider> mpServiceProvider;
+  std::unique_ptr<UserProfile> mpUserProfile;
+  engine::SpriteFactory mSpriteFactory;
+  data::PlayerModel mPlayerModel;
+  std::unique_ptr<GameWorld> mpWorld;
+  std::size_t mFramesSimulated = 0;
+};
+
+} // namespace rigel::game_logic
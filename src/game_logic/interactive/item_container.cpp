@@ -19,6 +19,7 @@
 #include "data/sound_ids.hpp"
 #include "engine/base_components.hpp"
 #include "engine/collision_checker.hpp"
+#include "engine/entity_activation_system.hpp"
 #include "engine/life_time_components.hpp"
 #include "engine/motion_smoothing.hpp"
 #include "engine/sprite_tools.hpp"
@@ -53,9 +54,11 @@ constexpr int ITEM_BOUNCE_SEQUENCE[] = {-3, -2, -1, 0, 1, 2, 3, -1, 1};
 ItemContainerSystem::ItemContainerSystem(
   entityx::EntityManager* pEntityManager,
   const engine::CollisionChecker* pCollisionChecker,
+  engine::EntityActivationSystem* pEntityActivationSystem,
   entityx::EventManager& events)
   : mpEntityManager(pEntityManager)
   , mpCollisionChecker(pCollisionChecker)
+  , mpEntityActivationSystem(pEntityActivationSystem)
 {
   events.subscribe<events::ShootableKilled>(*this);
 }
@@ -157,6 +160,12 @@ void ItemContainerSystem::updateItemBounce(entityx::EntityManager& es)
       ItemBounceEffect& state) {
       position.y += ITEM_BOUNCE_SEQUENCE[state.mFramesElapsed];
 
+      // Bouncing continues even when the item is off screen
+      if (!entity.has_component<Active>())
+      {
+        mpEntityActivationSystem->markMoved(entity);
+      }
+
       ++state.mFramesElapsed;
 
       if (const auto hasLanded =
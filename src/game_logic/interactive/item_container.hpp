@@ -23,7 +23,10 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstddef>
+#include <cstring>
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace rigel
@@ -33,6 +36,7 @@ struct IGameServiceProvider;
 namespace rigel::engine
 {
 class CollisionChecker;
+class EntityActivationSystem;
 }
 namespace rigel::game_logic
 {
@@ -80,12 +84,27 @@ public:
     mpSelf->assignToEntity(entity);
   }
 
+  /** Tell whether both holders contain the same type and value
+   *
+   * Only trivially copyable components can be compared. For all others,
+   * this conservatively returns false.
+   */
+  bool hasSameStateAs(const ComponentHolder& other) const
+  {
+    return mpSelf->hasSameStateAs(*other.mpSelf);
+  }
+
+  /** Size of the held component including type erasure overhead, in bytes */
+  std::size_t size() const { return mpSelf->size(); }
+
 private:
   struct Concept
   {
     virtual ~Concept() = default;
     virtual std::unique_ptr<Concept> clone() const = 0;
     virtual void assignToEntity(entityx::Entity entity) const = 0;
+    virtual bool hasSameStateAs(const Concept& other) const = 0;
+    virtual std::size_t size() const = 0;
   };
 
   template <typename T>
@@ -106,6 +125,22 @@ private:
       entity.assign<T>(mData);
     }
 
+    bool hasSameStateAs(const Concept& other) const override
+    {
+      if constexpr (std::is_trivially_copyable_v<T>)
+      {
+        const auto pOther = dynamic_cast<const Model*>(&other);
+        return pOther &&
+          std::memcmp(&mData, &pOther->mData, sizeof(T)) == 0;
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    std::size_t size() const override { return sizeof(Model); }
+
     T mData;
   };
 
@@ -159,6 +194,7 @@ public:
   ItemContainerSystem(
     entityx::EntityManager* pEntityManager,
     const engine::CollisionChecker* pCollisionChecker,
+    engine::EntityActivationSystem* pEntityActivationSystem,
     entityx::EventManager& events);
 
   void update(entityx::EntityManager& es);
@@ -168,6 +204,7 @@ public:
 private:
   entityx::EntityManager* mpEntityManager;
   const engine::CollisionChecker* mpCollisionChecker;
+  engine::EntityActivationSystem* mpEntityActivationSystem;
 };
 
 
@@ -350,31 +350,50 @@ Player::Player(
 }
 
 
-void Player::synchronizeTo(const Player& other, entityx::EntityManager& es)
+Player::SavedState Player::saveState() const
+{
+  return {
+    mState,
+    mHitBox,
+    mStance,
+    mVisualState,
+    mMercyFramesPerHit,
+    mMercyFramesRemaining,
+    mFramesElapsedHavingRapidFire,
+    mFramesElapsedHavingCloak,
+    mAttachedSpiders,
+    mGodModeOn,
+    mRapidFiredLastFrame,
+    mIsOddFrame,
+    mRecoilAnimationActive,
+    mIsRidingElevator,
+    mJumpRequested,
+    bool(mAttachedElevator)};
+}
+
+
+void Player::restoreState(const SavedState& state, entityx::EntityManager& es)
 {
   using game_logic::components::ActorTag;
 
-  mGodModeOn = other.mGodModeOn;
-  mState = other.mState;
-  mHitBox = other.mHitBox;
-  mStance = other.mStance;
-  mVisualState = other.mVisualState;
-  mMercyFramesPerHit = other.mMercyFramesPerHit;
-  mMercyFramesRemaining = other.mMercyFramesRemaining;
-  mFramesElapsedHavingRapidFire = other.mFramesElapsedHavingRapidFire;
-  mFramesElapsedHavingCloak = other.mFramesElapsedHavingCloak;
-  mAttachedSpiders = other.mAttachedSpiders;
-  mRapidFiredLastFrame = other.mRapidFiredLastFrame;
-  mIsOddFrame = other.mIsOddFrame;
-  mRecoilAnimationActive = other.mRecoilAnimationActive;
-  mIsRidingElevator = other.mIsRidingElevator;
-  mJumpRequested = other.mJumpRequested;
-
-  *mEntity.component<c::Sprite>() = *other.mEntity.component<const c::Sprite>();
-  *mEntity.component<c::BoundingBox>() =
-    *other.mEntity.component<const c::BoundingBox>();
-
-  if (other.mAttachedElevator)
+  mGodModeOn = state.mGodModeOn;
+  mState = state.mState;
+  mHitBox = state.mHitBox;
+  mStance = state.mStance;
+  mVisualState = state.mVisualState;
+  mMercyFramesPerHit = state.mMercyFramesPerHit;
+  mMercyFramesRemaining = state.mMercyFramesRemaining;
+  mFramesElapsedHavingRapidFire = state.mFramesElapsedHavingRapidFire;
+  mFramesElapsedHavingCloak = state.mFramesElapsedHavingCloak;
+  mAttachedSpiders = state.mAttachedSpiders;
+  mRapidFiredLastFrame = state.mRapidFiredLastFrame;
+  mIsOddFrame = state.mIsOddFrame;
+  mRecoilAnimationActive = state.mRecoilAnimationActive;
+  mIsRidingElevator = state.mIsRidingElevator;
+  mJumpRequested = state.mJumpRequested;
+
+  mAttachedElevator = {};
+  if (state.mIsAttachedToElevator)
   {
     entityx::ComponentHandle<ActorTag> tag;
     for (auto entity : es.entities_with_components(tag))
@@ -258,7 +258,36 @@ public:
   Player& operator=(const Player&) = delete;
   Player& operator=(Player&&) = default;
 
-  void synchronizeTo(const Player& other, entityx::EntityManager& es);
+  /** Player state which isn't stored in the player entity's components */
+  struct SavedState
+  {
+    PlayerState mState;
+    engine::components::BoundingBox mHitBox;
+    WeaponStance mStance;
+    VisualState mVisualState;
+    int mMercyFramesPerHit;
+    int mMercyFramesRemaining;
+    int mFramesElapsedHavingRapidFire;
+    int mFramesElapsedHavingCloak;
+    std::bitset<3> mAttachedSpiders;
+    bool mGodModeOn;
+    bool mRapidFiredLastFrame;
+    bool mIsOddFrame;
+    bool mRecoilAnimationActive;
+    bool mIsRidingElevator;
+    bool mJumpRequested;
+    bool mIsAttachedToElevator;
+  };
+
+  SavedState saveState() const;
+
+  /** Restore state previously returned by saveState()
+   *
+   * The player's entity is expected to already be in the corresponding
+   * state. If the player was attached to an elevator, the elevator is looked
+   * up in the given entity manager.
+   */
+  void restoreState(const SavedState& state, entityx::EntityManager& es);
 
   void update(const PlayerInput& inputs);
 
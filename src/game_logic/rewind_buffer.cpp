@@ -0,0 +1,151 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rewind_buffer.hpp"
+
+#include "game_logic/world_state.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+
+namespace rigel::game_logic
+{
+
+namespace
+{
+
+// Two seconds at the game logic rate
+constexpr auto KEYFRAME_INTERVAL = 30;
+
+} // namespace
+
+
+RewindBuffer::RewindBuffer(const std::size_t memoryBudgetInBytes)
+  : mMemoryBudget(memoryBudgetInBytes)
+{
+}
+
+
+RewindBuffer::~RewindBuffer() = default;
+
+
+void RewindBuffer::record(
+  const WorldState& state,
+  const data::PlayerModel& playerModel)
+{
+  const auto isKeyframe =
+    mFrames.empty() || framesSinceLastKeyframe() >= KEYFRAME_INTERVAL;
+
+  Frame frame{
+    isKeyframe
+      ? std::make_unique<WorldSnapshot>(state)
+      : std::make_unique<WorldSnapshot>(state, *lastKeyframe().mpSnapshot),
+    playerModel};
+  frame.mIsKeyframe = isKeyframe;
+  frame.mMemoryUsage = sizeof(Frame) + frame.mpSnapshot->memoryUsage();
+
+  mMemoryUsage += frame.mMemoryUsage;
+  mFrames.push_back(std::move(frame));
+
+  discardOldFrames();
+}
+
+
+bool RewindBuffer::rewind(
+  WorldState& state,
+  data::PlayerModel& playerModel,
+  IGameServiceProvider* pServiceProvider,
+  const data::GameSessionId sessionId)
+{
+  if (mFrames.empty())
+  {
+    return false;
+  }
+
+  auto& frame = mFrames.back();
+
+  playerModel = frame.mPlayerModel;
+  state.restoreSnapshot(
+    *frame.mpSnapshot, pServiceProvider, &playerModel, sessionId);
+
+  mMemoryUsage -= frame.mMemoryUsage;
+  mFrames.pop_back();
+
+  return true;
+}
+
+
+void RewindBuffer::clear()
+{
+  mFrames.clear();
+  mMemoryUsage = 0;
+}
+
+
+void RewindBuffer::setMemoryBudget(const std::size_t memoryBudgetInBytes)
+{
+  mMemoryBudget = memoryBudgetInBytes;
+  discardOldFrames();
+}
+
+
+auto RewindBuffer::lastKeyframe() const -> const Frame&
+{
+  assert(!mFrames.empty());
+  return *(mFrames.rbegin() + framesSinceLastKeyframe());
+}
+
+
+int RewindBuffer::framesSinceLastKeyframe() const
+{
+  const auto iKeyframe = std::find_if(
+    mFrames.rbegin(), mFrames.rend(), [](const Frame& frame) {
+      return frame.mIsKeyframe;
+    });
+  assert(iKeyframe != mFrames.rend());
+
+  return int(std::distance(mFrames.rbegin(), iKeyframe));
+}
+
+
+void RewindBuffer::discardOldFrames()
+{
+  auto isKeyframe = [](const Frame& frame) { return frame.mIsKeyframe; };
+
+  // The first frame is always a keyframe. Frames can only be discarded
+  // together with the keyframe they depend on, and we always keep the most
+  // recent keyframe around.
+  while (mMemoryUsage > mMemoryBudget)
+  {
+    const auto iNextKeyframe =
+      std::find_if(std::next(mFrames.begin()), mFrames.end(), isKeyframe);
+    if (iNextKeyframe == mFrames.end())
+    {
+      break;
+    }
+
+    for (auto iFrame = mFrames.begin(); iFrame != iNextKeyframe; ++iFrame)
+    {
+      mMemoryUsage -= iFrame->mMemoryUsage;
+    }
+
+    mFrames.erase(mFrames.begin(), iNextKeyframe);
+  }
+}
+
+} // namespace rigel::game_logic
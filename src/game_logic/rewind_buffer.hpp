@@ -0,0 +1,95 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "data/game_session_data.hpp"
+#include "data/player_model.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+
+
+namespace rigel
+{
+struct IGameServiceProvider;
+}
+
+
+namespace rigel::game_logic
+{
+
+struct WorldSnapshot;
+struct WorldState;
+
+
+/** Keeps a history of world snapshots, for stepping backwards in time
+ *
+ * A snapshot is recorded for each game logic frame. Complete snapshots are
+ * only made every couple of frames (keyframes). All other frames only store
+ * the map tiles and entity components which differ from the most recent
+ * keyframe. Once the memory held by the recorded frames exceeds the given
+ * budget, the oldest frames are discarded.
+ */
+class RewindBuffer
+{
+public:
+  explicit RewindBuffer(std::size_t memoryBudgetInBytes);
+  ~RewindBuffer(); // NOLINT
+
+  void record(const WorldState& state, const data::PlayerModel& playerModel);
+
+  /** Restore the most recently recorded frame and remove it from the buffer
+   *
+   * Returns false if there was nothing to restore.
+   */
+  bool rewind(
+    WorldState& state,
+    data::PlayerModel& playerModel,
+    IGameServiceProvider* pServiceProvider,
+    data::GameSessionId sessionId);
+
+  void clear();
+
+  /** Change the budget, discarding old frames if it's now exceeded */
+  void setMemoryBudget(std::size_t memoryBudgetInBytes);
+
+  bool empty() const { return mFrames.empty(); }
+  std::size_t size() const { return mFrames.size(); }
+  std::size_t memoryUsage() const { return mMemoryUsage; }
+
+private:
+  struct Frame
+  {
+    // Snapshots of non-keyframes refer to the keyframe's snapshot, which
+    // is why snapshots are kept on the heap
+    std::unique_ptr<WorldSnapshot> mpSnapshot;
+    data::PlayerModel mPlayerModel;
+    std::size_t mMemoryUsage = 0;
+    bool mIsKeyframe = false;
+  };
+
+  const Frame& lastKeyframe() const;
+  int framesSinceLastKeyframe() const;
+  void discardOldFrames();
+
+  std::deque<Frame> mFrames;
+  std::size_t mMemoryBudget;
+  std::size_t mMemoryUsage = 0;
+};
+
+} // namespace rigel::game_logic
@@ -16,20 +16,14 @@
 
 #include "world_state.hpp"
 
+#include "assets/level_loader.hpp"
 #include "assets/resource_loader.hpp"
 #include "engine/base_components.hpp"
-#include "engine/life_time_components.hpp"
-#include "engine/physical_components.hpp"
+#include "engine/entity_tools.hpp"
 #include "engine/sprite_factory.hpp"
 #include "engine/visual_components.hpp"
 #include "frontend/game_service_provider.hpp"
 #include "game_logic/actor_tag.hpp"
-#include "game_logic/behavior_controller.hpp"
-#include "game_logic/collectable_components.hpp"
-#include "game_logic/damage_components.hpp"
-#include "game_logic/dynamic_geometry_components.hpp"
-#include "game_logic/effect_components.hpp"
-#include "game_logic/interactive/item_container.hpp"
 #include "renderer/renderer.hpp"
 
 
@@ -41,6 +35,11 @@ namespace
 
 char EPISODE_PREFIXES[] = {'L', 'M', 'N', 'O'};
 
+// Number of entity slots reserved for short-lived entities like debris,
+// explosions and projectiles. Large enough to cover the reactor destruction
+// sequence and boss explosions.
+constexpr auto NUM_RESERVED_TRANSIENT_ENTITIES = std::size_t{1024};
+
 
 std::string levelFileName(const int episode, const int level)
 {
@@ -55,59 +54,65 @@ std::string levelFileName(const int episode, const int level)
 }
 
 
-template <typename T>
-void copyComponentIfPresent(entityx::Entity from, entityx::Entity to)
+WorldSnapshot::MapDelta
+  diffMaps(const data::map::Map& base, const data::map::Map& map)
+{
+  assert(base.width() == map.width() && base.height() == map.height());
+
+  WorldSnapshot::MapDelta delta;
+
+  for (auto layer = 0; layer < 2; ++layer)
+  {
+    for (auto y = 0; y < map.height(); ++y)
+    {
+      for (auto x = 0; x < map.width(); ++x)
+      {
+        const auto index = map.tileAt(layer, x, y);
+        if (index != base.tileAt(layer, x, y))
+        {
+          delta.push_back(
+            {std::uint16_t(x), std::uint16_t(y), std::uint8_t(layer), index});
+        }
+      }
+    }
+  }
+
+  return delta;
+}
+
+
+void applyDelta(data::map::Map& map, const WorldSnapshot::MapDelta& delta)
 {
-  if (from.has_component<T>())
+  for (const auto& change : delta)
   {
-    to.assign<T>(*from.component<const T>());
+    map.setTileAt(change.mLayer, change.mX, change.mY, change.mIndex);
   }
 }
 
 
-void copyAllComponents(entityx::Entity from, entityx::Entity to)
+/** Copies the members which WorldState and WorldSnapshot have in common,
+ * and which are plain values
+ */
+template <typename Source, typename Target>
+void copyPlainState(const Source& source, Target& target)
 {
-  using namespace engine::components;
-  using namespace game_logic::components;
-
-  copyComponentIfPresent<ActivationSettings>(from, to);
-  copyComponentIfPresent<Active>(from, to);
-  copyComponentIfPresent<ActorTag>(from, to);
-  copyComponentIfPresent<AnimationLoop>(from, to);
-  copyComponentIfPresent<AnimationSequence>(from, to);
-  copyComponentIfPresent<AppearsOnRadar>(from, to);
-  copyComponentIfPresent<AutoDestroy>(from, to);
-  copyComponentIfPresent<BehaviorController>(from, to);
-  copyComponentIfPresent<BoundingBox>(from, to);
-  copyComponentIfPresent<CollectableItem>(from, to);
-  copyComponentIfPresent<CollectableItemForCheat>(from, to);
-  copyComponentIfPresent<CollidedWithWorld>(from, to);
-  copyComponentIfPresent<CustomDamageApplication>(from, to);
-  copyComponentIfPresent<DamageInflicting>(from, to);
-  copyComponentIfPresent<DestructionEffects>(from, to);
-  copyComponentIfPresent<DrawTopMost>(from, to);
-  copyComponentIfPresent<DynamicGeometrySection>(from, to);
-  copyComponentIfPresent<ExtendedFrameList>(from, to);
-  copyComponentIfPresent<Interactable>(from, to);
-  copyComponentIfPresent<InterpolateMotion>(from, to);
-  copyComponentIfPresent<ItemBounceEffect>(from, to);
-  copyComponentIfPresent<ItemContainer>(from, to);
-  copyComponentIfPresent<MovementSequence>(from, to);
-  copyComponentIfPresent<MovingBody>(from, to);
-  copyComponentIfPresent<Orientation>(from, to);
-  copyComponentIfPresent<OverrideDrawOrder>(from, to);
-  copyComponentIfPresent<PlayerDamaging>(from, to);
-  copyComponentIfPresent<PlayerProjectile>(from, to);
-  copyComponentIfPresent<RadarDish>(from, to);
-  copyComponentIfPresent<Shootable>(from, to);
-  copyComponentIfPresent<SolidBody>(from, to);
-  copyComponentIfPresent<Sprite>(from, to);
-  copyComponentIfPresent<SpriteCascadeSpawner>(from, to);
-  copyComponentIfPresent<SpriteStrip>(from, to);
-  copyComponentIfPresent<TileDebris>(from, to);
-  copyComponentIfPresent<WorldPosition>(from, to);
-
-  assert(from.component_mask() == to.component_mask());
+  target.mBonusInfo = source.mBonusInfo;
+  target.mLevelMusicFile = source.mLevelMusicFile;
+  target.mActivatedCheckpoint = source.mActivatedCheckpoint;
+  target.mScreenFlashColor = source.mScreenFlashColor;
+  target.mBackdropFlashColor = source.mBackdropFlashColor;
+  target.mTeleportTargetPosition = source.mTeleportTargetPosition;
+  target.mCloakPickupPosition = source.mCloakPickupPosition;
+  target.mBossStartingHealth = source.mBossStartingHealth;
+  target.mReactorDestructionFramesElapsed =
+    source.mReactorDestructionFramesElapsed;
+  target.mScreenShakeOffsetX = source.mScreenShakeOffsetX;
+  target.mBossDeathAnimationStartPending =
+    source.mBossDeathAnimationStartPending;
+  target.mBackdropSwitched = source.mBackdropSwitched;
+  target.mLevelFinished = source.mLevelFinished;
+  target.mPlayerDied = source.mPlayerDied;
+  target.mIsOddFrame = source.mIsOddFrame;
 }
 
 } // namespace
@@ -140,6 +145,17 @@ BonusRelatedItemCounts countBonusRelatedItems(entityx::EntityManager& es)
 }
 
 
+std::future<data::map::LevelData> loadLevelAsync(
+  const assets::ResourceLoader& resources,
+  const data::GameSessionId& sessionId)
+{
+  return assets::loadLevelAsync(
+    levelFileName(sessionId.mEpisode, sessionId.mLevel),
+    resources,
+    sessionId.mDifficulty);
+}
+
+
 WorldState::WorldState(
   IGameServiceProvider* pServiceProvider,
   renderer::Renderer* pRenderer,
@@ -208,6 +224,7 @@ WorldState::WorldState(
       sessionId.mDifficulty)
   , mRadarDishCounter(mEntities, mEventManager)
   , mCollisionChecker(&mMap, mEntities, mEventManager)
+  , mEntityActivationSystem(mEntities, mEventManager)
   , mpOptions(pOptions)
   , mPlayer(
       [&]() {
@@ -231,16 +248,27 @@ WorldState::WorldState(
       &mRandomGenerator)
   , mCamera(&mPlayer, mMap, mEventManager)
   , mParticles(&mRandomGenerator, pRenderer)
-  , mSpriteRenderingSystem(pRenderer, &pSpriteFactory->textureAtlas())
-  , mMapRenderer(
+  , mSpriteRenderingSystem(
       pRenderer,
-      std::move(dynamicMapSections.mMapStaticParts),
-      &mMap.attributeDict(),
-      engine::MapRenderer::MapRenderData{
-        std::move(loadedLevel.mTileSetImage),
-        std::move(loadedLevel.mBackdropImage),
-        std::move(loadedLevel.mSecondaryBackdropImage),
-        loadedLevel.mBackdropScrollMode})
+      pRenderer ? &pSpriteFactory->textureAtlas() : nullptr,
+      mEntities,
+      mEventManager)
+  , mMapRenderer([&]() -> std::optional<engine::MapRenderer> {
+      if (!pRenderer)
+      {
+        return std::nullopt;
+      }
+
+      return std::make_optional<engine::MapRenderer>(
+        pRenderer,
+        std::move(dynamicMapSections.mMapStaticParts),
+        &mMap.attributeDict(),
+        engine::MapRenderer::MapRenderData{
+          std::move(loadedLevel.mTileSetImage),
+          std::move(loadedLevel.mBackdropImage),
+          std::move(loadedLevel.mSecondaryBackdropImage),
+          loadedLevel.mBackdropScrollMode});
+    }())
   , mPhysicsSystem(&mCollisionChecker, &mMap, &mEventManager)
   , mDebuggingSystem(pRenderer, &mMap)
   , mPlayerInteractionSystem(
@@ -265,8 +293,7 @@ WorldState::WorldState(
       &mMap,
       &mRandomGenerator,
       &mEventManager,
-      &mMapRenderer,
-      std::move(dynamicMapSections.mSimpleSections))
+      mMapRenderer ? &*mMapRenderer : nullptr)
   , mEffectsSystem(
       pServiceProvider,
       &mRandomGenerator,
@@ -274,7 +301,11 @@ WorldState::WorldState(
       &mEntityFactory,
       &mParticles,
       mEventManager)
-  , mItemContainerSystem(&mEntities, &mCollisionChecker, mEventManager)
+  , mItemContainerSystem(
+      &mEntities,
+      &mCollisionChecker,
+      &mEntityActivationSystem,
+      mEventManager)
   , mBehaviorControllerSystem(
       GlobalDependencies{
         &mCollisionChecker,
@@ -293,6 +324,7 @@ WorldState::WorldState(
   mEntityFactory.createEntitiesForLevel(loadedLevel.mActors);
   mDynamicGeometrySystem.initializeDynamicGeometryEntities(
     dynamicMapSections.mFallingSections);
+  engine::reserveEntities(mEntities, NUM_RESERVED_TRANSIENT_ENTITIES);
 
   const auto counts = countBonusRelatedItems(mEntities);
   mBonusInfo.mInitialCameraCount = counts.mCameraCount;
@@ -309,90 +341,169 @@ WorldState::WorldState(
 }
 
 
-void WorldState::synchronizeTo(
-  const WorldState& other,
+void WorldState::restoreSnapshot(
+  const WorldSnapshot& snapshot,
   IGameServiceProvider* pServiceProvider,
   data::PlayerModel* pPlayerModel,
   const data::GameSessionId sessionId)
 {
-  if (mBackdropSwitched != other.mBackdropSwitched)
+  if (mMapRenderer && mBackdropSwitched != snapshot.mBackdropSwitched)
+  {
+    mMapRenderer->switchBackdrops();
+  }
+
+  copyPlainState(snapshot, *this);
+
+  if (snapshot.mpBase)
+  {
+    mMap = snapshot.mpBase->mMap;
+    applyDelta(mMap, snapshot.mMapDelta);
+  }
+  else
+  {
+    mMap = snapshot.mMap;
+  }
+
+  mRandomGenerator = snapshot.mRandomGenerator;
+  mCamera.restoreState(snapshot.mCameraState);
+  mParticles.restoreState(snapshot.mParticlesState);
+
+  if (mMapRenderer && snapshot.mMapRendererState)
   {
-    mMapRenderer.switchBackdrops();
+    if (snapshot.mpBase)
+    {
+      auto map = snapshot.mpBase->mMapRendererMap;
+      applyDelta(map, snapshot.mMapRendererDelta);
+      mMapRenderer->restoreState(*snapshot.mMapRendererState, map);
+    }
+    else
+    {
+      mMapRenderer->restoreState(
+        *snapshot.mMapRendererState, snapshot.mMapRendererMap);
+    }
   }
 
-  mBonusInfo = other.mBonusInfo;
-  mLevelMusicFile = other.mLevelMusicFile;
-  mActivatedCheckpoint = other.mActivatedCheckpoint;
-  mScreenFlashColor = other.mScreenFlashColor;
-  mBackdropFlashColor = other.mBackdropFlashColor;
-  mTeleportTargetPosition = other.mTeleportTargetPosition;
-  mCloakPickupPosition = other.mCloakPickupPosition;
-  mBossStartingHealth = other.mBossStartingHealth;
-  mReactorDestructionFramesElapsed = other.mReactorDestructionFramesElapsed;
-  mScreenShakeOffsetX = other.mScreenShakeOffsetX;
-  mBossDeathAnimationStartPending = other.mBossDeathAnimationStartPending;
-  mBackdropSwitched = other.mBackdropSwitched;
-  mLevelFinished = other.mLevelFinished;
-  mPlayerDied = other.mPlayerDied;
-  mIsOddFrame = other.mIsOddFrame;
-
-  mMap = other.mMap;
-  mRandomGenerator = other.mRandomGenerator;
-  mCamera.synchronizeTo(other.mCamera);
-  mParticles.synchronizeTo(other.mParticles);
-  mMapRenderer.synchronizeTo(other.mMapRenderer);
-
-  if (other.mEarthQuakeEffect)
+  if (snapshot.mEarthQuakeState)
   {
     mEarthQuakeEffect =
       EarthQuakeEffect{pServiceProvider, &mRandomGenerator, &mEventManager};
-    mEarthQuakeEffect->synchronizeTo(*other.mEarthQuakeEffect);
+    mEarthQuakeEffect->restoreState(*snapshot.mEarthQuakeState);
   }
   else
   {
     mEarthQuakeEffect.reset();
   }
 
-  mEntities.reset();
+  const auto restoredEntities = snapshot.mEntities.restore(mEntities);
+  auto playerEntity = restoredEntities[snapshot.mPlayerEntityIndex];
+  mActiveBossEntity = snapshot.mActiveBossEntityIndex
+    ? restoredEntities[*snapshot.mActiveBossEntityIndex]
+    : entityx::Entity{};
+
+  // Restoring the entities started over with empty storage
+  engine::reserveEntities(mEntities, NUM_RESERVED_TRANSIENT_ENTITIES);
+
+  // Constructing the player resets its animation frames, which are part of
+  // the restored sprite
+  const auto playerSprite =
+    *playerEntity.component<const engine::components::Sprite>();
+
+  mPlayer = Player{
+    playerEntity,
+    sessionId.mDifficulty,
+    pPlayerModel,
+    pServiceProvider,
+    mpOptions,
+    &mCollisionChecker,
+    &mMap,
+    &mEntityFactory,
+    &mEventManager,
+    &mRandomGenerator};
+
+  *playerEntity.component<engine::components::Sprite>() = playerSprite;
+  mPlayer.restoreState(snapshot.mPlayerState, mEntities);
+}
 
-  entityx::Entity playerEntity;
 
-  // clang-format off
-  for (
-    const auto entity :
-      const_cast<entityx::EntityManager&>(other.mEntities)
-        .entities_for_debugging())
-  // clang-format on
+WorldSnapshot::WorldSnapshot(const WorldState& state)
+  : WorldSnapshot(state, nullptr)
+{
+}
+
+
+WorldSnapshot::WorldSnapshot(const WorldState& state, const WorldSnapshot& base)
+  : WorldSnapshot(state, &base)
+{
+}
+
+
+WorldSnapshot::WorldSnapshot(
+  const WorldState& state,
+  const WorldSnapshot* pBase)
+  : mpBase(pBase)
+  , mEntities(state.mEntities, pBase ? &pBase->mEntities : nullptr)
+  , mRandomGenerator(state.mRandomGenerator)
+  , mPlayerState(state.mPlayer.saveState())
+  , mCameraState(state.mCamera.saveState())
+  , mParticlesState(state.mParticles.saveState())
+{
+  assert(!pBase || !pBase->mpBase);
+
+  copyPlainState(state, *this);
+
+  if (pBase)
   {
-    auto clone = mEntities.create();
+    mMapDelta = diffMaps(pBase->mMap, state.mMap);
+  }
+  else
+  {
+    mMap = state.mMap;
+  }
 
-    copyAllComponents(entity, clone);
+  if (state.mMapRenderer)
+  {
+    mMapRendererState = state.mMapRenderer->saveState();
 
-    if (entity == other.mPlayer.entity())
+    if (pBase)
     {
-      playerEntity = clone;
+      mMapRendererDelta =
+        diffMaps(pBase->mMapRendererMap, state.mMapRenderer->map());
     }
-
-    if (entity == other.mActiveBossEntity)
+    else
     {
-      mActiveBossEntity = clone;
+      mMapRendererMap = state.mMapRenderer->map();
     }
   }
 
+  if (state.mEarthQuakeEffect)
   {
-    mPlayer = Player{
-      playerEntity,
-      sessionId.mDifficulty,
-      pPlayerModel,
-      pServiceProvider,
-      mpOptions,
-      &mCollisionChecker,
-      &mMap,
-      &mEntityFactory,
-      &mEventManager,
-      &mRandomGenerator};
-    mPlayer.synchronizeTo(other.mPlayer, mEntities);
+    mEarthQuakeState = state.mEarthQuakeEffect->saveState();
   }
+
+  const auto playerIndex = mEntities.indexOf(state.mPlayer.entity());
+  assert(playerIndex);
+  mPlayerEntityIndex = *playerIndex;
+
+  if (state.mActiveBossEntity)
+  {
+    mActiveBossEntityIndex = mEntities.indexOf(state.mActiveBossEntity);
+  }
+}
+
+
+std::size_t WorldSnapshot::memoryUsage() const
+{
+  const auto& particleGroups = mParticlesState.mParticleGroups;
+
+  return sizeof(WorldSnapshot) + mMap.memoryUsage() +
+    mMapRendererMap.memoryUsage() +
+    (mMapDelta.capacity() + mMapRendererDelta.capacity()) *
+    sizeof(TileChange) +
+    mEntities.memoryUsage() + mLevelMusicFile.capacity() +
+    particleGroups.capacity() * sizeof(particleGroups[0]) +
+    (mParticlesState.mVelocitiesX.capacity() +
+     mParticlesState.mInitialOffsetIndicesY.capacity()) *
+    sizeof(std::int16_t);
 }
 
 } // namespace rigel::game_logic
@@ -37,6 +37,7 @@
 #include "game_logic/earth_quake_effect.hpp"
 #include "game_logic/effects_system.hpp"
 #include "game_logic/entity_factory.hpp"
+#include "game_logic/entity_snapshot.hpp"
 #include "game_logic/interactive/enemy_radar.hpp"
 #include "game_logic/interactive/item_container.hpp"
 #include "game_logic/player.hpp"
@@ -49,7 +50,12 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <optional>
 #include <string>
+#include <vector>
 
 
 namespace rigel
@@ -109,6 +115,94 @@ struct CheckpointData
 };
 
 
+struct WorldState;
+
+
+/** Copy of the simulation state of a running level
+ *
+ * Contains everything needed to bring a WorldState back to the point in time
+ * at which the snapshot was taken: map, entities, random number generator,
+ * camera, player and particles, plus the CPU-side copy of the map renderer's
+ * tiles. Unlike a WorldState, a snapshot doesn't own any renderer resources
+ * or entity manager, and creating one doesn't require loading the level.
+ * This makes it cheap enough to keep several snapshots around.
+ *
+ * A snapshot can be taken relative to a base snapshot of the same level, in
+ * which case it only stores the map tiles and entity components which differ
+ * from the base. The base must outlive the snapshot, and can't have a base
+ * itself.
+ */
+struct WorldSnapshot
+{
+  struct TileChange
+  {
+    std::uint16_t mX;
+    std::uint16_t mY;
+    std::uint8_t mLayer;
+    data::map::TileIndex mIndex;
+  };
+
+  using MapDelta = std::vector<TileChange>;
+
+  explicit WorldSnapshot(const WorldState& state);
+  WorldSnapshot(const WorldState& state, const WorldSnapshot& base);
+
+  WorldSnapshot(const WorldSnapshot&) = delete;
+  WorldSnapshot& operator=(const WorldSnapshot&) = delete;
+
+  /** Memory held by the snapshot, in bytes
+   *
+   * Doesn't include memory held by the base snapshot.
+   */
+  std::size_t memoryUsage() const;
+
+  const WorldSnapshot* mpBase = nullptr;
+
+  // With a base, the maps are left empty, and the deltas list the tiles
+  // which differ from the base's maps instead.
+  data::map::Map mMap;
+  data::map::Map mMapRendererMap;
+  MapDelta mMapDelta;
+  MapDelta mMapRendererDelta;
+
+  EntitySnapshot mEntities;
+  std::size_t mPlayerEntityIndex = 0;
+  std::optional<std::size_t> mActiveBossEntityIndex;
+  engine::RandomNumberGenerator mRandomGenerator;
+
+  Player::SavedState mPlayerState;
+  Camera::SavedState mCameraState;
+  engine::ParticleSystem::SavedState mParticlesState;
+  std::optional<EarthQuakeEffect::SavedState> mEarthQuakeState;
+  std::optional<engine::MapRenderer::SavedState> mMapRendererState;
+
+  LevelBonusInfo mBonusInfo;
+  std::string mLevelMusicFile;
+  std::optional<CheckpointData> mActivatedCheckpoint;
+  std::optional<base::Color> mScreenFlashColor;
+  std::optional<base::Color> mBackdropFlashColor;
+  std::optional<base::Vec2> mTeleportTargetPosition;
+  std::optional<base::Vec2> mCloakPickupPosition;
+  int mBossStartingHealth = 0;
+  std::optional<int> mReactorDestructionFramesElapsed;
+  int mScreenShakeOffsetX = 0;
+  bool mBossDeathAnimationStartPending = false;
+  bool mBackdropSwitched = false;
+  bool mLevelFinished = false;
+  bool mPlayerDied = false;
+  bool mIsOddFrame = true;
+
+private:
+  WorldSnapshot(const WorldState& state, const WorldSnapshot* pBase);
+};
+
+
+/** All state making up a running level
+ *
+ * When constructed with a nullptr renderer, the map renderer is not created
+ * and the remaining render-related systems are set up without access to the
+ * GPU. Game logic can then be updated as usual, but nothing can be rendered.
+ */
 struct WorldState
 {
   WorldState(
@@ -139,8 +233,8 @@ struct WorldState
     DynamicMapSectionData&& dynamicMapSections,
     data::map::LevelData&& loadedLevel);
 
-  void synchronizeTo(
-    const WorldState& other,
+  void restoreSnapshot(
+    const WorldSnapshot& snapshot,
     IGameServiceProvider* pServiceProvider,
     data::PlayerModel* pPlayerModel,
     data::GameSessionId sessionId);
@@ -153,6 +247,7 @@ struct WorldState
   EntityFactory mEntityFactory;
   RadarDishCounter mRadarDishCounter;
   engine::CollisionChecker mCollisionChecker;
+  engine::EntityActivationSystem mEntityActivationSystem;
   const data::GameOptions* mpOptions;
 
   Player mPlayer;
@@ -160,7 +255,7 @@ struct WorldState
   base::Vec2 mPreviousCameraPosition;
   engine::ParticleSystem mParticles;
   engine::SpriteRenderingSystem mSpriteRenderingSystem;
-  engine::MapRenderer mMapRenderer;
+  std::optional<engine::MapRenderer> mMapRenderer;
   engine::PhysicsSystem mPhysicsSystem;
   engine::LifeTimeSystem mLifeTimeSystem;
   game_logic::DebuggingSystem mDebuggingSystem;
@@ -194,4 +289,15 @@ struct WorldState
   bool mIsOddFrame = true;
 };
 
+
+/** Start loading the level for the given session on a worker thread
+ *
+ * The result can be passed on to GameWorld, which allows preloading a level
+ * while something else is shown on screen. The ResourceLoader must outlive
+ * the returned future.
+ */
+std::future<data::map::LevelData> loadLevelAsync(
+  const assets::ResourceLoader& resources,
+  const data::GameSessionId& sessionId);
+
 } // namespace rigel::game_logic
@@ -283,11 +283,7 @@ void initAndRunGame(
   {
     LOG_F(INFO, "Game requested restart");
 
-    auto optionsForRestartedGame = CommandLineOptions{};
-    optionsForRestartedGame.mSkipIntro = true;
-    optionsForRestartedGame.mDebugModeEnabled =
-      commandLineOptions.mDebugModeEnabled;
-    optionsForRestartedGame.mDisableAudio = commandLineOptions.mDisableAudio;
+    const auto optionsForRestartedGame = optionsForRestart(commandLineOptions);
 
     while (result == Game::StopReason::RestartNeeded)
     {
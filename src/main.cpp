@@ -26,8 +26,10 @@
 #include "base/defer.hpp"
 #include "base/match.hpp"
 #include "base/string_utils.hpp"
+#include "assets/resource_loader.hpp"
 #include "base/warnings.hpp"
 #include "frontend/user_profile.hpp"
+#include "game_logic/headless_simulation.hpp"
 
 #include "game_main.hpp"
 
@@ -38,6 +40,7 @@
 #include <stdexcept>
 #include <string>
 #include <variant>
+#include <vector>
 
 #include <SDL_main.h>
 #include <SDL_messagebox.h>
@@ -228,6 +231,19 @@ std::variant<CommandLineOptions, int> parseArgs(int argc, char** argv)
           std::regex positionRegex{"([0-9]+),([0-9]+)"};
           return std::regex_match(positionSpec, positionRegex);
         }))
+      .add_argument(lyra::opt([&](const std::string& framesSpec) {
+          if (!config.mLevelToJumpTo) { return; }
+
+          config.mFramesToSimulate = std::stoi(framesSpec);
+        }, "frames")
+        ["--simulate"]
+        .help(
+          "Run the level for the given number of game logic frames without "
+          "graphics or audio, print the results and exit")
+        .choices([](const std::string& framesSpec) {
+          std::regex framesRegex{"[0-9]{1,7}"};
+          return std::regex_match(framesSpec, framesRegex);
+        }))
     | lyra::arg(config.mGamePath, "game path")
       .help(
         "Path to original game's installation. If not provided here, "
@@ -275,6 +291,50 @@ void initializeLogging(int argc, char** argv)
 }
 
 
+/** Simulate a level headless, without any player input
+ *
+ * Useful for checking that the game logic runs deterministically, e.g. by
+ * comparing the output of different builds.
+ */
+int runHeadlessSimulation(const CommandLineOptions& config)
+{
+  if (config.mGamePath.empty())
+  {
+    std::cerr << "ERROR: Simulating a level requires a game path\n";
+    return -1;
+  }
+
+  try
+  {
+    const auto resources = assets::ResourceLoader{
+      std::filesystem::u8path(config.mGamePath), false, {}};
+    auto simulation =
+      game_logic::HeadlessSimulation{&resources, *config.mLevelToJumpTo};
+
+    const auto inputs =
+      std::vector<game_logic::PlayerInput>(*config.mFramesToSimulate);
+    const auto result = simulation.run(inputs);
+
+    std::cout << "Frames simulated: " << result.mFramesSimulated << '\n'
+              << "Level finished: " << (result.mLevelFinished ? "yes" : "no")
+              << '\n'
+              << "Player position: " << result.mPlayerPosition.x << ','
+              << result.mPlayerPosition.y << '\n'
+              << "Camera position: " << result.mCameraPosition.x << ','
+              << result.mCameraPosition.y << '\n'
+              << "Entities: " << result.mNumEntities << '\n'
+              << "Score: " << result.mPlayerModel.score() << '\n'
+              << "Health: " << result.mPlayerModel.health() << '\n';
+    return 0;
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << "ERROR: " << ex.what() << '\n';
+    return -2;
+  }
+}
+
+
 int runGame(const CommandLineOptions& config)
 {
   enableDpiAwareness();
@@ -324,6 +384,12 @@ int main(int argc, char** argv)
   return base::match(
     configOrExitCode,
     [&](const CommandLineOptions& config) {
+      if (config.mFramesToSimulate)
+      {
+        initializeLogging(argc, argv);
+        return runHeadlessSimulation(config);
+      }
+
       // Once we're ready to run, detach from the console. See comment above
       // for why we're doing this.
       win32IoGuard.reset();
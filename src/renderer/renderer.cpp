@@ -17,6 +17,7 @@
 #include "renderer.hpp"
 
 #include "assets/palette.hpp"
+#include "base/profiler.hpp"
 #include "data/game_options.hpp"
 #include "data/game_traits.hpp"
 #include "renderer/opengl.hpp"
@@ -32,6 +33,7 @@ RIGEL_RESTORE_WARNINGS
 
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include <iterator>
 
 
@@ -53,9 +55,14 @@ constexpr std::array<GLenum, MAX_MULTI_TEXTURES> TEXTURE_UNIT_IDS{
   GL_TEXTURE6,
   GL_TEXTURE7};
 
-constexpr auto MAX_QUADS_PER_BATCH = 1280u;
+// The largest number of quads we can address using 16-bit indices
+constexpr auto MAX_QUADS_PER_BATCH = 16384u;
 constexpr auto MAX_BATCH_SIZE = MAX_QUADS_PER_BATCH * std::size(QUAD_INDICES);
 
+// Enough for several frames worth of vertex data in typical scenes. The
+// buffer grows if a single upload exceeds this size.
+constexpr auto STREAM_BUFFER_INITIAL_SIZE = std::size_t{4 * 1024 * 1024};
+
 
 #ifdef RIGEL_USE_GL_ES
 constexpr GLint MONO_TEXTURE_INTERNAL_FORMAT = GL_LUMINANCE;
@@ -87,6 +94,94 @@ private:
 };
 
 
+/** Vertex buffer for streaming per-frame vertex data to the GPU
+ *
+ * On desktop GL, uploads are appended to a large buffer using unsynchronized
+ * mapping, so that the driver doesn't need to wait for pending draw calls
+ * that read from the same buffer. Once the buffer is full, it's orphaned by
+ * re-specifying it via glBufferData. This gives us fresh storage, while the
+ * driver keeps the old storage alive until the GPU is done with it - the
+ * driver effectively manages a ring of buffers for us.
+ *
+ * GL ES 2.0 doesn't offer buffer mapping, so there, each upload re-specifies
+ * the whole buffer instead.
+ *
+ * The buffer must be bound to GL_ARRAY_BUFFER when calling upload().
+ */
+class StreamingVertexBuffer
+{
+public:
+  StreamingVertexBuffer()
+  {
+    glGenBuffers(1, &mVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+
+#ifndef RIGEL_USE_GL_ES
+    glBufferData(
+      GL_ARRAY_BUFFER, GLsizeiptr(mCapacity), nullptr, GL_STREAM_DRAW);
+#endif
+  }
+
+  ~StreamingVertexBuffer() { glDeleteBuffers(1, &mVbo); }
+
+  StreamingVertexBuffer(const StreamingVertexBuffer&) = delete;
+  StreamingVertexBuffer& operator=(const StreamingVertexBuffer&) = delete;
+
+  GLuint handle() const { return mVbo; }
+
+  /** Copy data into the buffer
+   *
+   * Returns the offset in bytes at which the data is located in the buffer.
+   */
+  std::uintptr_t upload(const void* pData, const std::size_t size)
+  {
+#ifdef RIGEL_USE_GL_ES
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(size), pData, GL_STREAM_DRAW);
+    return 0;
+#else
+    if (mWriteOffset + size > mCapacity)
+    {
+      mCapacity = std::max(mCapacity, size);
+      mWriteOffset = 0;
+      glBufferData(
+        GL_ARRAY_BUFFER, GLsizeiptr(mCapacity), nullptr, GL_STREAM_DRAW);
+    }
+
+    const auto offset = mWriteOffset;
+
+    const auto pDestination = glMapBufferRange(
+      GL_ARRAY_BUFFER,
+      GLintptr(offset),
+      GLsizeiptr(size),
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+        GL_MAP_UNSYNCHRONIZED_BIT);
+    if (pDestination)
+    {
+      std::memcpy(pDestination, pData, size);
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+    else
+    {
+      glBufferSubData(
+        GL_ARRAY_BUFFER, GLintptr(offset), GLsizeiptr(size), pData);
+    }
+
+    // All our vertex formats consist of floats only, so the next upload
+    // will still be suitably aligned.
+    mWriteOffset += size;
+    return offset;
+#endif
+  }
+
+private:
+  GLuint mVbo = 0;
+#ifndef RIGEL_USE_GL_ES
+  std::size_t mCapacity = STREAM_BUFFER_INITIAL_SIZE;
+  std::size_t mWriteOffset = 0;
+#endif
+};
+
+
 VertexBufferId packVertexBuffer(const GLuint vbo, const uint16_t size)
 {
   static_assert(sizeof(GLuint) == sizeof(uint32_t));
@@ -142,36 +237,92 @@ void setScissorBox(
 }
 
 
-void setVertexLayout(const VertexLayout layout)
+void setVertexLayout(
+  const VertexLayout layout,
+  const std::uintptr_t baseOffset = 0)
 {
   switch (layout)
   {
     case VertexLayout::PositionAndTexCoords:
       glVertexAttribPointer(
-        0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 4, toAttribOffset(0));
+        0,
+        2,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(float) * 4,
+        toAttribOffset(baseOffset));
       glVertexAttribPointer(
         1,
         2,
         GL_FLOAT,
         GL_FALSE,
         sizeof(float) * 4,
-        toAttribOffset(sizeof(float) * 2));
+        toAttribOffset(baseOffset + sizeof(float) * 2));
       break;
 
     case VertexLayout::PositionAndColor:
       glVertexAttribPointer(
-        0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 6, toAttribOffset(0));
+        0,
+        2,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(float) * 6,
+        toAttribOffset(baseOffset));
       glVertexAttribPointer(
         1,
         4,
         GL_FLOAT,
         GL_FALSE,
         sizeof(float) * 6,
-        toAttribOffset(sizeof(float) * 2));
+        toAttribOffset(baseOffset + sizeof(float) * 2));
+      break;
+
+    case VertexLayout::PositionTexCoordsAndOverlay:
+      glVertexAttribPointer(
+        0,
+        2,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(float) * 5,
+        toAttribOffset(baseOffset));
+      glVertexAttribPointer(
+        1,
+        2,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(float) * 5,
+        toAttribOffset(baseOffset + sizeof(float) * 2));
+      glVertexAttribPointer(
+        2,
+        1,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(float) * 5,
+        toAttribOffset(baseOffset + sizeof(float) * 4));
+      break;
   }
 }
 
 
+std::size_t floatsPerVertex(const VertexLayout layout)
+{
+  switch (layout)
+  {
+    case VertexLayout::PositionAndTexCoords:
+      return 4;
+
+    case VertexLayout::PositionAndColor:
+      return 6;
+
+    case VertexLayout::PositionTexCoordsAndOverlay:
+      return 5;
+  }
+
+  assert(false);
+  return 4;
+}
+
+
 auto getSize(SDL_Window* pWindow)
 {
   int windowWidth = 0;
@@ -270,7 +421,7 @@ struct Renderer::Impl
   std::vector<State> mStateStack{State{}};
   GLuint mLastUsedTexture = 0;
   GLuint mQuadIndicesEbo = 0;
-  std::uint16_t mBatchSize = 0;
+  std::uint32_t mBatchSize = 0;
   RenderMode mRenderMode = RenderMode::SpriteBatch;
   bool mStateChanged = true;
 
@@ -284,12 +435,17 @@ struct Renderer::Impl
   base::Size mLastKnownWindowSize;
   SDL_Window* mpWindow;
   RenderMode mLastKnownRenderMode = RenderMode::SpriteBatch;
+  bool mOverlayAttributeEnabled = false;
 
   // cold
+  RenderStatistics mCurrentFrameStatistics;
+  RenderStatistics mLastFrameStatistics;
   int mNumTextures = 0;
   int mNumVbos = 0;
   DummyVao mDummyVao;
-  GLuint mStreamVbo = 0;
+
+  // Stays bound to GL_ARRAY_BUFFER all the time
+  StreamingVertexBuffer mStreamVbo;
 
 
   explicit Impl(SDL_Window* pWindow)
@@ -305,10 +461,6 @@ struct Renderer::Impl
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    // Set up a VBO for streaming data to the GPU, stays bound all the time
-    glGenBuffers(1, &mStreamVbo);
-    glBindBuffer(GL_ARRAY_BUFFER, mStreamVbo);
-
     // Set up an index buffer with enough indices to handle the largest
     // possible batch size. This is only sent to the GPU once, reducing the
     // amount of data we need to send for each batch.
@@ -335,7 +487,8 @@ struct Renderer::Impl
       glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
-    // All shaders have exactly two vertex attributes
+    // All shaders have at least two vertex attributes, a 3rd one is enabled
+    // on demand by applyVertexLayout()
     glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
 
@@ -353,7 +506,6 @@ struct Renderer::Impl
     assert(mNumTextures == 0);
     assert(mNumVbos == 0);
 
-    glDeleteBuffers(1, &mStreamVbo);
     glDeleteBuffers(1, &mQuadIndicesEbo);
   }
 
@@ -381,12 +533,57 @@ struct Renderer::Impl
     const auto vertices = createTexturedQuadVertices(sourceRect, destRect);
     mBatchData.insert(
       mBatchData.end(), std::begin(vertices), std::end(vertices));
-    mBatchSize += std::uint16_t(std::size(QUAD_INDICES));
+    mBatchSize += std::uint32_t(std::size(QUAD_INDICES));
+  }
+
+
+  void applyVertexLayout(
+    const VertexLayout layout,
+    const std::uintptr_t baseOffset = 0)
+  {
+    // Only one of our vertex layouts uses a 3rd attribute. It must be
+    // disabled for all others, since it would otherwise be read from
+    // whatever buffer it was last pointed at.
+    const auto needsOverlayAttribute =
+      layout == VertexLayout::PositionTexCoordsAndOverlay;
+    if (needsOverlayAttribute != mOverlayAttributeEnabled)
+    {
+      if (needsOverlayAttribute)
+      {
+        glEnableVertexAttribArray(2);
+      }
+      else
+      {
+        glDisableVertexAttribArray(2);
+      }
+
+      mOverlayAttributeEnabled = needsOverlayAttribute;
+    }
+
+    setVertexLayout(layout, baseOffset);
+  }
+
+
+  /** Upload vertex data to the stream VBO and point the vertex attributes
+   * at it, in preparation for a draw call
+   */
+  void streamVertices(
+    const float* pVertices,
+    const std::size_t numFloats,
+    const VertexLayout layout)
+  {
+    const auto size = sizeof(float) * numFloats;
+    const auto offset = mStreamVbo.upload(pVertices, size);
+    applyVertexLayout(layout, offset);
+
+    mCurrentFrameStatistics.mBytesUploaded += size;
   }
 
 
   void submitBatch()
   {
+    RIGEL_PROFILE_ZONE("Renderer::submitBatch");
+
     commitChangedState();
 
     if (mBatchData.empty())
@@ -394,26 +591,21 @@ struct Renderer::Impl
       return;
     }
 
+    const auto layout = shaderToUse(mStateStack.back()).vertexLayout();
+
     switch (mRenderMode)
     {
       case RenderMode::SpriteBatch:
-        glBufferData(
-          GL_ARRAY_BUFFER,
-          sizeof(float) * mBatchData.size(),
-          mBatchData.data(),
-          GL_STREAM_DRAW);
+        streamVertices(mBatchData.data(), mBatchData.size(), layout);
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mQuadIndicesEbo);
-        glDrawElements(GL_TRIANGLES, mBatchSize, GL_UNSIGNED_SHORT, nullptr);
+        glDrawElements(
+          GL_TRIANGLES, GLsizei(mBatchSize), GL_UNSIGNED_SHORT, nullptr);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         break;
 
       case RenderMode::Points:
-        glBufferData(
-          GL_ARRAY_BUFFER,
-          sizeof(float) * mBatchData.size(),
-          mBatchData.data(),
-          GL_STREAM_DRAW);
+        streamVertices(mBatchData.data(), mBatchData.size(), layout);
         glDrawArrays(GL_POINTS, 0, GLsizei(mBatchData.size() / 6));
         break;
 
@@ -427,6 +619,9 @@ struct Renderer::Impl
 
     mBatchData.clear();
     mBatchSize = 0;
+
+    ++mCurrentFrameStatistics.mNumBatches;
+    ++mCurrentFrameStatistics.mNumDrawCalls;
   }
 
 
@@ -450,8 +645,10 @@ struct Renderer::Impl
       right, top,    colorVec.r, colorVec.g, colorVec.b, colorVec.a,
     };
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STREAM_DRAW);
+    streamVertices(
+      vertices, std::size(vertices), VertexLayout::PositionAndColor);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    ++mCurrentFrameStatistics.mNumDrawCalls;
   }
 
 
@@ -475,8 +672,10 @@ struct Renderer::Impl
       right, top,    colorVec.r, colorVec.g, colorVec.b, colorVec.a,
       left,  top,    colorVec.r, colorVec.g, colorVec.b, colorVec.a};
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STREAM_DRAW);
+    streamVertices(
+      vertices, std::size(vertices), VertexLayout::PositionAndColor);
     glDrawArrays(GL_LINE_STRIP, 0, 5);
+    ++mCurrentFrameStatistics.mNumDrawCalls;
   }
 
 
@@ -501,8 +700,10 @@ struct Renderer::Impl
     };
     // clang-format on
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STREAM_DRAW);
+    streamVertices(
+      vertices, std::size(vertices), VertexLayout::PositionAndColor);
     glDrawArrays(GL_LINE_STRIP, 0, 2);
+    ++mCurrentFrameStatistics.mNumDrawCalls;
   }
 
 
@@ -522,6 +723,16 @@ struct Renderer::Impl
   }
 
 
+  void drawPoints(base::ArrayView<float> vertices)
+  {
+    assert(vertices.size() % 6 == 0);
+
+    updateState(mRenderMode, RenderMode::Points);
+    mBatchData.insert(
+      std::end(mBatchData), std::begin(vertices), std::end(vertices));
+  }
+
+
   void drawCustomQuadBatch(const CustomQuadBatchData& batch)
   {
     submitBatch();
@@ -547,22 +758,21 @@ struct Renderer::Impl
 
 
     // Submit vertex buffer
-    setVertexLayout(batch.mpShader->vertexLayout());
-
-    const auto numQuads =
-      batch.mVertexBuffer.size() / std::tuple_size<QuadVertices>::value;
-    const auto numIndices = GLsizei(numQuads * std::size(QUAD_INDICES));
+    const auto numVertices = batch.mVertexBuffer.size() /
+      floatsPerVertex(batch.mpShader->vertexLayout());
+    const auto numIndices = GLsizei(numVertices / 4 * std::size(QUAD_INDICES));
     assert(numIndices < GLsizei(MAX_BATCH_SIZE));
 
-    glBufferData(
-      GL_ARRAY_BUFFER,
-      sizeof(float) * batch.mVertexBuffer.size(),
+    streamVertices(
       batch.mVertexBuffer.data(),
-      GL_STREAM_DRAW);
+      batch.mVertexBuffer.size(),
+      batch.mpShader->vertexLayout());
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mQuadIndicesEbo);
     glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_SHORT, nullptr);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    ++mCurrentFrameStatistics.mNumDrawCalls;
   }
 
 
@@ -591,14 +801,17 @@ struct Renderer::Impl
       const auto [vbo, size] = unpackVertexBuffer(buffer);
 
       glBindBuffer(GL_ARRAY_BUFFER, vbo);
-      setVertexLayout(layout);
+      applyVertexLayout(layout);
       glDrawElements(GL_TRIANGLES, size, GL_UNSIGNED_SHORT, nullptr);
     }
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, mStreamVbo);
-    setVertexLayout(layout);
+    glBindBuffer(GL_ARRAY_BUFFER, mStreamVbo.handle());
+    applyVertexLayout(layout);
+
+    mCurrentFrameStatistics.mNumDrawCalls +=
+      static_cast<std::uint32_t>(buffers.size());
   }
 
 
@@ -708,6 +921,9 @@ struct Renderer::Impl
     submitBatch();
     SDL_GL_SwapWindow(mpWindow);
 
+    mLastFrameStatistics = mCurrentFrameStatistics;
+    mCurrentFrameStatistics = {};
+
     const auto actualWindowSize = getSize(mpWindow);
     if (mWindowSize != actualWindowSize)
     {
@@ -865,7 +1081,7 @@ struct Renderer::Impl
 
   void commitVertexAttributeFormat(const State& state)
   {
-    setVertexLayout(shaderToUse(state).vertexLayout());
+    applyVertexLayout(shaderToUse(state).vertexLayout());
   }
 
 
@@ -873,7 +1089,7 @@ struct Renderer::Impl
   {
     auto& shader = shaderToUse(state);
     shader.use();
-    setVertexLayout(shader.vertexLayout());
+    applyVertexLayout(shader.vertexLayout());
 
     if (shader.handle() == mTexturedQuadShader.handle())
     {
@@ -908,7 +1124,7 @@ struct Renderer::Impl
       sizeof(float) * vertices.size(),
       vertices.data(),
       GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, mStreamVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, mStreamVbo.handle());
 
     const auto size = uint16_t(
       vertices.size() / std::tuple_size<renderer::QuadVertices>::value *
@@ -1139,6 +1355,12 @@ void Renderer::drawPoint(const base::Vec2& position, const base::Color& color)
 }
 
 
+void Renderer::drawPoints(base::ArrayView<float> vertices)
+{
+  mpImpl->drawPoints(vertices);
+}
+
+
 void Renderer::drawCustomQuadBatch(const CustomQuadBatchData& batch)
 {
   mpImpl->drawCustomQuadBatch(batch);
@@ -1211,12 +1433,36 @@ std::optional<base::Rect<int>> Renderer::clipRect() const
 }
 
 
+base::Color Renderer::overlayColor() const
+{
+  return mpImpl->mStateStack.back().mOverlayColor;
+}
+
+
+base::Color Renderer::colorModulation() const
+{
+  return mpImpl->mStateStack.back().mColorModulation;
+}
+
+
+bool Renderer::textureRepeatEnabled() const
+{
+  return mpImpl->mStateStack.back().mTextureRepeatEnabled;
+}
+
+
 base::Size Renderer::currentRenderTargetSize() const
 {
   return mpImpl->currentRenderTargetSize();
 }
 
 
+const RenderStatistics& Renderer::lastFrameStatistics() const
+{
+  return mpImpl->mLastFrameStatistics;
+}
+
+
 base::Size Renderer::windowSize() const
 {
   return mpImpl->mWindowSize;
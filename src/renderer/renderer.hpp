@@ -27,6 +27,7 @@ RIGEL_DISABLE_WARNINGS
 #include <SDL_video.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -40,6 +41,23 @@ using VertexBufferId = std::uint64_t;
 constexpr auto INVALID_VERTEX_BUFFER_ID = VertexBufferId(0);
 
 
+/** Counters describing the rendering workload of a frame
+ *
+ * See Renderer::lastFrameStatistics().
+ */
+struct RenderStatistics
+{
+  /** Number of implicit batches submitted (see submitBatch()) */
+  std::uint32_t mNumBatches = 0;
+
+  /** Total number of OpenGL draw calls */
+  std::uint32_t mNumDrawCalls = 0;
+
+  /** Amount of vertex data streamed to the GPU */
+  std::size_t mBytesUploaded = 0;
+};
+
+
 /** OpenGL-based 2D rendering API
  *
  * This class provides hardware-accelerated 2D rendering capabilities
@@ -100,6 +118,14 @@ public:
    */
   void drawPoint(const base::Vec2& position, const base::Color& color);
 
+  /** Draw many single pixels at once
+   *
+   * Same as calling drawPoint() for each point, but appends all of them to
+   * the current batch in one go. Vertices are given as a flat array of
+   * x, y, r, g, b, a per point, with color components in the range [0, 1].
+   */
+  void drawPoints(base::ArrayView<float> vertices);
+
   void drawCustomQuadBatch(const CustomQuadBatchData& batch);
 
   void submitVertexBuffers(
@@ -368,9 +394,18 @@ public:
   base::Size currentRenderTargetSize() const;
   base::Size windowSize() const;
 
+  /** Rendering statistics for the most recently completed frame
+   *
+   * Updated on each call to swapBuffers().
+   */
+  const RenderStatistics& lastFrameStatistics() const;
+
   base::Vec2 globalTranslation() const;
   base::Vec2f globalScale() const;
   std::optional<base::Rect<int>> clipRect() const;
+  base::Color overlayColor() const;
+  base::Color colorModulation() const;
+  bool textureRepeatEnabled() const;
 
 private:
   struct Impl;
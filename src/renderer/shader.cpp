@@ -172,6 +172,12 @@ Shader::Shader(const ShaderSpec& spec)
       glBindAttribLocation(mProgram.mHandle, 0, "position");
       glBindAttribLocation(mProgram.mHandle, 1, "color");
       break;
+
+    case VertexLayout::PositionTexCoordsAndOverlay:
+      glBindAttribLocation(mProgram.mHandle, 0, "position");
+      glBindAttribLocation(mProgram.mHandle, 1, "texCoord");
+      glBindAttribLocation(mProgram.mHandle, 2, "overlayAmount");
+      break;
   }
 
   glLinkProgram(mProgram.mHandle);
@@ -72,7 +72,11 @@ private:
 enum class VertexLayout
 {
   PositionAndTexCoords,
-  PositionAndColor
+  PositionAndColor,
+
+  // Like PositionAndTexCoords, plus a per-vertex overlay color strength
+  // (0.0 to 1.0)
+  PositionTexCoordsAndOverlay
 };
 
 
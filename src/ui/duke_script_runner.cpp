@@ -449,8 +449,8 @@ void DukeScriptRunner::interpretNextAction()
     },
 
     [this](const SetPalette& action) {
-      updatePalette(
-        assets::load6bitPalette16(mpResourceBundle->file(action.paletteFile)));
+      updatePalette(assets::load6bitPalette16(
+        mpResourceBundle->fileView(action.paletteFile)));
     },
 
     [this](const SetupCheckBoxes& action) {
@@ -17,6 +17,8 @@
 #include "fps_display.hpp"
 
 #include "base/math_utils.hpp"
+#include "base/profiler.hpp"
+#include "renderer/renderer.hpp"
 
 #include "utils.hpp"
 
@@ -34,10 +36,30 @@ namespace
 const auto PRE_FILTER_WEIGHT = 0.7f;
 const auto FILTER_WEIGHT = 0.9f;
 
+
+void drawProfilerBreakdown()
+{
+  std::stringstream report;
+  report << std::fixed << std::setprecision(2);
+
+  for (const auto& zone : base::profiler::frameBreakdown())
+  {
+    // clang-format off
+    report
+      << std::string(std::size_t(zone.mDepth) * 2, ' ')
+      << zone.mpName << ": " << zone.mMilliseconds << " ms\n";
+    // clang-format on
+  }
+
+  drawText(report.str(), 0, 16, {255, 255, 255, 255});
+}
+
 } // namespace
 
 
-void FpsDisplay::updateAndRender(const engine::TimeDelta totalElapsed)
+void FpsDisplay::updateAndRender(
+  const engine::TimeDelta totalElapsed,
+  const renderer::RenderStatistics& renderStatistics)
 {
   mPreFilteredFrameTime = base::lerp(
     static_cast<float>(totalElapsed), mPreFilteredFrameTime, PRE_FILTER_WEIGHT);
@@ -51,11 +73,19 @@ void FpsDisplay::updateAndRender(const engine::TimeDelta totalElapsed)
   statsReport
     << smoothedFps << " FPS, "
     << std::setw(4) << std::fixed << std::setprecision(2)
-    << totalElapsed * 1000.0 << " ms";
+    << totalElapsed * 1000.0 << " ms, "
+    << renderStatistics.mNumDrawCalls << " draw calls, "
+    << renderStatistics.mNumBatches << " batches, "
+    << renderStatistics.mBytesUploaded / 1024 << " KiB uploaded";
   // clang-format on
 
   const auto reportString = statsReport.str();
   drawText(reportString, 0, 0, {255, 255, 255, 255});
+
+  if constexpr (base::profiler::ENABLED)
+  {
+    drawProfilerBreakdown();
+  }
 }
 
 } // namespace rigel::ui
@@ -19,13 +19,21 @@
 #include "engine/timing.hpp"
 
 
+namespace rigel::renderer
+{
+struct RenderStatistics;
+}
+
+
 namespace rigel::ui
 {
 
 class FpsDisplay
 {
 public:
-  void updateAndRender(engine::TimeDelta elapsed);
+  void updateAndRender(
+    engine::TimeDelta elapsed,
+    const renderer::RenderStatistics& renderStatistics);
 
 
 private:
@@ -62,6 +62,9 @@ constexpr auto MAX_OPTIONS_MENU_ASPECT_RATIO = 16.0f / 9.0f;
 constexpr auto STANDARD_FPS_LIMITS =
   std::array{30, 60, 70, 72, 75, 90, 120, 144, 240};
 
+constexpr auto STANDARD_REWIND_MEMORY_BUDGETS_MB =
+  std::array{16, 32, 64, 128, 256, 512};
+
 
 struct SoundIdWithDescription
 {
@@ -192,6 +195,41 @@ void fpsLimitUi(data::GameOptions* pOptions)
 }
 
 
+void rewindUi(data::GameOptions* pOptions)
+{
+  ImGui::Checkbox("Rewind", &pOptions->mRewindEnabled);
+  ImGui::SameLine();
+
+  withEnabledState(pOptions->mRewindEnabled, [=]() {
+    const auto toLabel = [](const int budgetMb) {
+      return std::to_string(budgetMb) + " MB";
+    };
+
+    ImGui::SetNextItemWidth(ImGui::GetFontSize() * 5.0f);
+    if (ImGui::BeginCombo(
+          "Rewind memory", toLabel(pOptions->mRewindMemoryBudgetMb).c_str()))
+    {
+      for (const auto item : STANDARD_REWIND_MEMORY_BUDGETS_MB)
+      {
+        const auto isSelected = item == pOptions->mRewindMemoryBudgetMb;
+
+        if (ImGui::Selectable(toLabel(item).c_str(), isSelected))
+        {
+          pOptions->mRewindMemoryBudgetMb = item;
+        }
+
+        if (isSelected)
+        {
+          ImGui::SetItemDefaultFocus();
+        }
+      }
+
+      ImGui::EndCombo();
+    }
+  });
+}
+
+
 std::string normalizedKeyName(const SDL_Keycode keyCode)
 {
   using namespace std::literals;
@@ -532,6 +570,7 @@ void OptionsMenu::updateAndRender(engine::TimeDelta dt)
       keyBindingRow("Fire", &mpOptions->mFireKeybinding);
       keyBindingRow("Quick save", &mpOptions->mQuickSaveKeybinding);
       keyBindingRow("Quick load", &mpOptions->mQuickLoadKeybinding);
+      keyBindingRow("Rewind (hold)", &mpOptions->mRewindKeybinding);
       ImGui::Columns(1);
 
       ImGui::EndTabItem();
@@ -842,6 +881,7 @@ void OptionsMenu::updateAndRender(engine::TimeDelta dt)
       }
 
       ImGui::Checkbox("Quick saving", &mpOptions->mQuickSavingEnabled);
+      rewindUi(mpOptions);
       ImGui::Checkbox("Skip intro sequence", &mpOptions->mSkipIntro);
       ImGui::Checkbox(
         "Smooth scrolling & movement", &mpOptions->mMotionSmoothing);
@@ -0,0 +1,193 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+
+#include <engine/base_components.hpp>
+#include <game_logic/behavior_controller.hpp>
+#include <game_logic/behavior_controller_system.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <string>
+#include <vector>
+
+
+using namespace rigel;
+using namespace game_logic;
+
+using engine::components::Active;
+using game_logic::components::BehaviorController;
+
+
+namespace ex = entityx;
+
+
+namespace
+{
+
+struct UpdateLog
+{
+  std::vector<std::string> mEntries;
+};
+
+
+template <char Tag>
+struct LoggingBehavior
+{
+  void update(GlobalDependencies&, GlobalState&, bool, ex::Entity entity)
+  {
+    mpLog->mEntries.push_back(
+      std::string(1, Tag) + std::to_string(entity.id().index()));
+
+    if (mDestroyOther)
+    {
+      mDestroyOther.destroy();
+    }
+
+    if (mReplaceOther)
+    {
+      mReplaceOther.replace<BehaviorController>(LoggingBehavior<'c'>{mpLog});
+    }
+
+    if (mRecreateOther)
+    {
+      // Freed controllers are reused by the next allocation of the same
+      // type, so the new controller ends up at the old one's address
+      mRecreateOther.remove<BehaviorController>();
+      mRecreateOther.assign<BehaviorController>(LoggingBehavior<'b'>{mpLog});
+    }
+  }
+
+  UpdateLog* mpLog;
+  ex::Entity mDestroyOther;
+  ex::Entity mReplaceOther;
+  ex::Entity mRecreateOther;
+};
+
+} // namespace
+
+
+TEST_CASE("Behavior controller dispatch")
+{
+  ex::EntityX entityx;
+  auto& entities = entityx.entities;
+
+  UpdateLog log;
+
+  auto spawn = [&](auto behavior) {
+    auto entity = entities.create();
+    entity.assign<BehaviorController>(behavior);
+    entity.assign<Active>();
+    return entity;
+  };
+
+  auto firstEntity = spawn(LoggingBehavior<'a'>{&log});
+  spawn(LoggingBehavior<'b'>{&log});
+  auto thirdEntity = spawn(LoggingBehavior<'a'>{&log});
+  spawn(LoggingBehavior<'c'>{&log});
+  auto fifthEntity = spawn(LoggingBehavior<'b'>{&log});
+
+  base::Vec2 cameraPosition;
+  BehaviorControllerSystem behaviorControllerSystem{
+    GlobalDependencies{
+      nullptr,
+      nullptr,
+      nullptr,
+      nullptr,
+      nullptr,
+      &entities,
+      &entityx.events},
+    nullptr,
+    &cameraPosition,
+    nullptr};
+
+  PerFrameState perFrameState;
+
+
+  SECTION("Entity order is the default")
+  {
+    behaviorControllerSystem.update(entities, perFrameState);
+
+    const auto expected =
+      std::vector<std::string>{"a0", "b1", "a2", "c3", "b4"};
+    CHECK(log.mEntries == expected);
+  }
+
+  SECTION("Controllers can be grouped by type")
+  {
+    behaviorControllerSystem.setDispatchMode(
+      BehaviorControllerSystem::DispatchMode::GroupedByType);
+    behaviorControllerSystem.update(entities, perFrameState);
+
+    const auto expected =
+      std::vector<std::string>{"a0", "a2", "b1", "b4", "c3"};
+    CHECK(log.mEntries == expected);
+
+    SECTION("Inactive entities are skipped")
+    {
+      log.mEntries.clear();
+      thirdEntity.remove<Active>();
+      behaviorControllerSystem.update(entities, perFrameState);
+
+      const auto expectedWithoutThird =
+        std::vector<std::string>{"a0", "b1", "b4", "c3"};
+      CHECK(log.mEntries == expectedWithoutThird);
+    }
+
+    SECTION("Entities destroyed during the update are skipped")
+    {
+      log.mEntries.clear();
+      firstEntity.component<BehaviorController>()
+        ->get<LoggingBehavior<'a'>>()
+        .mDestroyOther = fifthEntity;
+      behaviorControllerSystem.update(entities, perFrameState);
+
+      const auto expectedWithoutFifth =
+        std::vector<std::string>{"a0", "a2", "b1", "c3"};
+      CHECK(log.mEntries == expectedWithoutFifth);
+    }
+
+    SECTION("Controllers replaced during the update are skipped")
+    {
+      log.mEntries.clear();
+      firstEntity.component<BehaviorController>()
+        ->get<LoggingBehavior<'a'>>()
+        .mReplaceOther = fifthEntity;
+      behaviorControllerSystem.update(entities, perFrameState);
+
+      const auto expectedWithoutFifth =
+        std::vector<std::string>{"a0", "a2", "b1", "c3"};
+      CHECK(log.mEntries == expectedWithoutFifth);
+    }
+
+    SECTION("Controllers replaced by the same type are skipped")
+    {
+      log.mEntries.clear();
+      firstEntity.component<BehaviorController>()
+        ->get<LoggingBehavior<'a'>>()
+        .mRecreateOther = fifthEntity;
+      behaviorControllerSystem.update(entities, perFrameState);
+
+      const auto expectedWithoutFifth =
+        std::vector<std::string>{"a0", "a2", "b1", "c3"};
+      CHECK(log.mEntries == expectedWithoutFifth);
+    }
+  }
+}
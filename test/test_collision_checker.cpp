@@ -0,0 +1,135 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+
+#include <data/map.hpp>
+#include <engine/collision_checker.hpp>
+#include <engine/physical_components.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+
+namespace ex = entityx;
+
+
+TEST_CASE("Collision checker keeps track of solid bodies")
+{
+  ex::EntityX entityx;
+  auto& entities = entityx.entities;
+
+  data::map::Map map{20, 20, data::map::TileAttributeDict{{0x0, 0xF}}};
+
+  // Solid body which already exists when creating the collision checker
+  auto existingBody = entities.create();
+  existingBody.assign<WorldPosition>(WorldPosition{10, 10});
+  existingBody.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 1}});
+  existingBody.assign<SolidBody>();
+
+  CollisionChecker collisionChecker{&map, entities, entityx.events};
+
+  // 2x2 box located on top of the existing body
+  const auto bboxAbove = BoundingBox{{10, 8}, {2, 2}};
+
+  // 2x2 box located on top of a body at {4, 5}, with a height of 1
+  const auto bboxAboveNewBody = BoundingBox{{4, 3}, {2, 2}};
+
+
+  SECTION("Existing bodies are detected")
+  {
+    CHECK(collisionChecker.isOnSolidGround(bboxAbove));
+    CHECK(!collisionChecker.isOnSolidGround(bboxAboveNewBody));
+  }
+
+  SECTION("Moving a body in place is picked up")
+  {
+    auto& position = *existingBody.component<WorldPosition>();
+    position = WorldPosition{4, 5};
+
+    CHECK(!collisionChecker.isOnSolidGround(bboxAbove));
+    CHECK(collisionChecker.isOnSolidGround(bboxAboveNewBody));
+  }
+
+  SECTION("Resizing a body in place is picked up")
+  {
+    auto& bbox = *existingBody.component<BoundingBox>();
+    bbox.topLeft.x = 5;
+    bbox.size.width = 1;
+
+    CHECK(!collisionChecker.isOnSolidGround(bboxAbove));
+  }
+
+  SECTION("Removing the SolidBody component is picked up")
+  {
+    existingBody.remove<SolidBody>();
+
+    CHECK(!collisionChecker.isOnSolidGround(bboxAbove));
+
+    existingBody.assign<SolidBody>();
+
+    CHECK(collisionChecker.isOnSolidGround(bboxAbove));
+  }
+
+  SECTION("Destroying a body is picked up")
+  {
+    existingBody.destroy();
+
+    CHECK(!collisionChecker.isOnSolidGround(bboxAbove));
+  }
+
+  SECTION("Position and bounding box can be assigned after SolidBody")
+  {
+    auto newBody = entities.create();
+    newBody.assign<SolidBody>();
+
+    CHECK(!collisionChecker.isOnSolidGround(bboxAboveNewBody));
+
+    newBody.assign<WorldPosition>(WorldPosition{4, 5});
+
+    CHECK(!collisionChecker.isOnSolidGround(bboxAboveNewBody));
+
+    newBody.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 1}});
+
+    CHECK(collisionChecker.isOnSolidGround(bboxAboveNewBody));
+  }
+
+  SECTION("Bodies without bounding box are ignored")
+  {
+    existingBody.remove<BoundingBox>();
+
+    CHECK(!collisionChecker.isOnSolidGround(bboxAbove));
+
+    existingBody.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 1}});
+
+    CHECK(collisionChecker.isOnSolidGround(bboxAbove));
+  }
+
+  SECTION("Non-solid entities are ignored")
+  {
+    auto entity = entities.create();
+    entity.assign<WorldPosition>(WorldPosition{4, 5});
+    entity.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 1}});
+
+    CHECK(!collisionChecker.isOnSolidGround(bboxAboveNewBody));
+  }
+}
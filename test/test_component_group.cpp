@@ -0,0 +1,173 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+
+#include <engine/base_components.hpp>
+#include <engine/component_group.hpp>
+#include <engine/physical_components.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+
+namespace ex = entityx;
+
+
+namespace
+{
+
+struct Marker
+{
+  int mValue = 0;
+};
+
+
+template <typename Group>
+std::vector<int> visitAll(Group& group)
+{
+  std::vector<int> values;
+  group.each([&](ex::Entity, WorldPosition&, Marker& marker) {
+    values.push_back(marker.mValue);
+  });
+  return values;
+}
+
+
+std::vector<int> visitAllViaEntityManager(ex::EntityManager& entities)
+{
+  std::vector<int> values;
+  entities.each<WorldPosition, Marker>(
+    [&](ex::Entity, WorldPosition&, Marker& marker) {
+      values.push_back(marker.mValue);
+    });
+  return values;
+}
+
+} // namespace
+
+
+TEST_CASE("Component group")
+{
+  ex::EntityX entityx;
+  auto& entities = entityx.entities;
+
+  auto spawn = [&](const int value) {
+    auto entity = entities.create();
+    entity.assign<WorldPosition>();
+    entity.assign<Marker>(Marker{value});
+    return entity;
+  };
+
+  // Entities which already exist when creating the group
+  auto first = spawn(1);
+  auto incomplete = entities.create();
+  incomplete.assign<Marker>(Marker{2});
+  auto third = spawn(3);
+
+  ComponentGroup<WorldPosition, Marker> group{entities, entityx.events};
+
+
+  SECTION("Existing entities are picked up")
+  {
+    CHECK(group.size() == 2);
+    CHECK(visitAll(group) == visitAllViaEntityManager(entities));
+  }
+
+  SECTION("Entities are added when completing the combination")
+  {
+    incomplete.assign<WorldPosition>();
+
+    const auto expected = std::vector<int>{1, 2, 3};
+    CHECK(visitAll(group) == expected);
+  }
+
+  SECTION("Entities are removed when losing a component")
+  {
+    first.remove<Marker>();
+
+    const auto expected = std::vector<int>{3};
+    CHECK(visitAll(group) == expected);
+  }
+
+  SECTION("Destroyed entities are removed")
+  {
+    third.destroy();
+
+    const auto expected = std::vector<int>{1};
+    CHECK(visitAll(group) == expected);
+  }
+
+  SECTION("Components are accessed in place")
+  {
+    group.each([](ex::Entity, WorldPosition& position, Marker&) {
+      position.x = 42;
+    });
+
+    CHECK(first.component<WorldPosition>()->x == 42);
+  }
+
+  SECTION("Changes during iteration match EntityManager::each()")
+  {
+    auto fourth = spawn(4);
+
+    auto runIteration = [&](auto&& iterate) {
+      std::vector<int> values;
+      iterate([&](ex::Entity entity, WorldPosition&, Marker& marker) {
+        values.push_back(marker.mValue);
+
+        if (marker.mValue == 1)
+        {
+          // Higher index than the current entity, will be visited
+          incomplete.assign<WorldPosition>();
+
+          // Already visited entity losing a component
+          entity.remove<Marker>();
+
+          // Not yet visited entity losing a component
+          fourth.remove<Marker>();
+        }
+      });
+      return values;
+    };
+
+    const auto expected = std::vector<int>{1, 2, 3};
+
+    SECTION("Component group")
+    {
+      CHECK(
+        runIteration([&](auto&& callback) { group.each(callback); }) ==
+        expected);
+    }
+
+    SECTION("Entity manager")
+    {
+      CHECK(
+        runIteration([&](auto&& callback) {
+          entities.each<WorldPosition, Marker>(callback);
+        }) == expected);
+    }
+  }
+}
@@ -0,0 +1,245 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assets/ega_image_decoder.hpp>
+#include <assets/ega_pixel_decoder.hpp>
+#include <base/warnings.hpp>
+#include <data/unit_conversions.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <random>
+
+
+using namespace rigel;
+using data::GameTraits;
+
+
+namespace
+{
+
+// Every color has a different alpha value, to make sure that masking only
+// affects the masked pixels
+constexpr data::Palette16 TEST_PALETTE{
+  data::Pixel{0, 1, 2, 255},
+  data::Pixel{10, 11, 12, 254},
+  data::Pixel{20, 21, 22, 253},
+  data::Pixel{30, 31, 32, 252},
+  data::Pixel{40, 41, 42, 251},
+  data::Pixel{50, 51, 52, 250},
+  data::Pixel{60, 61, 62, 249},
+  data::Pixel{70, 71, 72, 248},
+  data::Pixel{80, 81, 82, 247},
+  data::Pixel{90, 91, 92, 246},
+  data::Pixel{100, 101, 102, 245},
+  data::Pixel{110, 111, 112, 244},
+  data::Pixel{120, 121, 122, 243},
+  data::Pixel{130, 131, 132, 242},
+  data::Pixel{140, 141, 142, 241},
+  data::Pixel{150, 151, 152, 240},
+};
+
+
+assets::ByteBuffer createRandomBytes(const std::size_t count)
+{
+  std::mt19937 randomGenerator{1234};
+  std::uniform_int_distribution<int> distribution{0, 255};
+
+  assets::ByteBuffer result(count);
+  for (auto& byte : result)
+  {
+    byte = std::uint8_t(distribution(randomGenerator));
+  }
+
+  return result;
+}
+
+
+bool bitAt(const std::uint8_t byte, const std::size_t pixel)
+{
+  return (byte & (0x80 >> pixel)) != 0;
+}
+
+
+/** Straightforward bit-by-bit decoding of a single pixel
+ *
+ * pPlanes points to the first plane byte of the group containing the pixel.
+ */
+data::Pixel decodeReferencePixel(
+  const std::uint8_t* pPlanes,
+  const std::size_t planeStride,
+  const bool hasMask,
+  const std::size_t pixel)
+{
+  const auto isMasked = hasMask && bitAt(*pPlanes, pixel);
+  if (hasMask)
+  {
+    pPlanes += planeStride;
+  }
+
+  auto colorIndex = 0;
+  for (auto plane = 0u; plane < GameTraits::egaPlanes; ++plane)
+  {
+    colorIndex |= bitAt(pPlanes[plane * planeStride], pixel) << plane;
+  }
+
+  auto color = TEST_PALETTE[colorIndex];
+  if (isMasked)
+  {
+    color.a = 0;
+  }
+
+  return color;
+}
+
+
+data::PixelBuffer decodeReferenceTiledImage(
+  const assets::ByteBuffer& data,
+  const std::size_t widthInTiles,
+  const std::size_t heightInTiles,
+  const data::TileImageType type)
+{
+  const auto numPlanes = GameTraits::numPlanes(type);
+  const auto hasMask = type == data::TileImageType::Masked;
+  const auto widthInPixels = data::tilesToPixels(widthInTiles);
+
+  data::PixelBuffer result(
+    widthInTiles * heightInTiles * GameTraits::tileSizeSquared);
+
+  for (auto tile = 0u; tile < widthInTiles * heightInTiles; ++tile)
+  {
+    const auto tileX = data::tilesToPixels(tile % widthInTiles);
+    const auto tileY = data::tilesToPixels(tile / widthInTiles);
+
+    for (auto row = 0u; row < GameTraits::tileSize; ++row)
+    {
+      const auto pPlanes =
+        data.data() + tile * GameTraits::bytesPerTile(type) + row * numPlanes;
+
+      for (auto pixel = 0u; pixel < GameTraits::tileSize; ++pixel)
+      {
+        result[tileX + pixel + (tileY + row) * widthInPixels] =
+          decodeReferencePixel(pPlanes, 1, hasMask, pixel);
+      }
+    }
+  }
+
+  return result;
+}
+
+} // namespace
+
+
+namespace
+{
+
+void checkTiledImageDecoding(const data::TileImageType type)
+{
+  const auto widthInTiles = std::size_t{5};
+  const auto heightInTiles = std::size_t{3};
+  const auto data = createRandomBytes(
+    widthInTiles * heightInTiles * GameTraits::bytesPerTile(type));
+
+  const auto image =
+    assets::loadTiledImage(data, widthInTiles, TEST_PALETTE, type);
+
+  REQUIRE(image.width() == data::tilesToPixels(widthInTiles));
+  REQUIRE(image.height() == data::tilesToPixels(heightInTiles));
+  CHECK(
+    image.pixelData() ==
+    decodeReferenceTiledImage(data, widthInTiles, heightInTiles, type));
+}
+
+} // namespace
+
+
+TEST_CASE("Tiled EGA images are decoded correctly")
+{
+  SECTION("Unmasked")
+  {
+    checkTiledImageDecoding(data::TileImageType::Unmasked);
+  }
+
+  SECTION("Masked")
+  {
+    checkTiledImageDecoding(data::TileImageType::Masked);
+  }
+}
+
+
+TEST_CASE("Simple planar EGA images are decoded correctly")
+{
+  const auto numPixels = std::size_t{320 * 8};
+  const auto bytesPerPlane = numPixels / GameTraits::pixelsPerEgaByte;
+  const auto data = createRandomBytes(bytesPerPlane * GameTraits::egaPlanes);
+
+  const auto pixels = assets::decodeSimplePlanarEgaBuffer(
+    data.data(), data.data() + data.size(), TEST_PALETTE);
+
+  data::PixelBuffer expected;
+  for (auto i = 0u; i < numPixels; ++i)
+  {
+    const auto pPlanes = data.data() + i / GameTraits::pixelsPerEgaByte;
+    expected.push_back(decodeReferencePixel(
+      pPlanes, bytesPerPlane, false, i % GameTraits::pixelsPerEgaByte));
+  }
+
+  CHECK(pixels == expected);
+}
+
+
+TEST_CASE("Scalar and SIMD EGA decoding give identical results")
+{
+  using assets::EgaDecoderBackend;
+
+  // An odd number of groups, to also cover the scalar tail of the SIMD
+  // implementation
+  const auto numGroups = std::size_t{17};
+
+  const auto decode = [&](
+                        const assets::EgaPlaneLayout& layout,
+                        const EgaDecoderBackend backend) {
+    const auto data = createRandomBytes(numGroups * layout.mGroupStride);
+
+    data::PixelBuffer result(numGroups * GameTraits::pixelsPerEgaByte);
+    const auto decoder = assets::EgaPixelDecoder{TEST_PALETTE, backend};
+    decoder.decode(
+      data.data(),
+      numGroups,
+      layout,
+      result.data(),
+      GameTraits::pixelsPerEgaByte);
+    return result;
+  };
+
+  SECTION("Unmasked")
+  {
+    const auto layout = assets::EgaPlaneLayout{4, 1, false};
+    CHECK(
+      decode(layout, EgaDecoderBackend::Scalar) ==
+      decode(layout, EgaDecoderBackend::Simd));
+  }
+
+  SECTION("Masked")
+  {
+    const auto layout = assets::EgaPlaneLayout{5, 1, true};
+    CHECK(
+      decode(layout, EgaDecoderBackend::Scalar) ==
+      decode(layout, EgaDecoderBackend::Simd));
+  }
+}
@@ -0,0 +1,237 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+
+#include <engine/base_components.hpp>
+#include <engine/entity_activation_system.hpp>
+#include <engine/entity_tools.hpp>
+#include <engine/physical_components.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+
+namespace ex = entityx;
+
+
+namespace
+{
+
+const auto VIEWPORT_SIZE = base::Size{32, 20};
+
+
+ex::Entity createEntity(ex::EntityManager& entities, const base::Vec2& position)
+{
+  auto entity = entities.create();
+  entity.assign<WorldPosition>(position);
+  entity.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 2}});
+  return entity;
+}
+
+
+bool isActive(ex::Entity entity)
+{
+  return entity.has_component<Active>();
+}
+
+} // namespace
+
+
+TEST_CASE("Entity activation system")
+{
+  ex::EntityX entityx;
+  auto& entities = entityx.entities;
+
+  // Entity which already exists when creating the system
+  auto existingEntity = createEntity(entities, {10, 10});
+
+  EntityActivationSystem activationSystem{entities, entityx.events};
+
+  auto farAwayEntity = createEntity(entities, {200, 10});
+
+  activationSystem.update({0, 0}, VIEWPORT_SIZE);
+
+
+  SECTION("Entities are activated when on screen")
+  {
+    CHECK(isActive(existingEntity));
+    CHECK(existingEntity.component<Active>()->mIsOnScreen);
+    CHECK(!isActive(farAwayEntity));
+  }
+
+  SECTION("Moving the camera changes activation")
+  {
+    activationSystem.update({190, 0}, VIEWPORT_SIZE);
+
+    CHECK(!isActive(existingEntity));
+    CHECK(isActive(farAwayEntity));
+  }
+
+  SECTION("Active entities leaving the screen are deactivated")
+  {
+    existingEntity.component<WorldPosition>()->x = 100;
+    activationSystem.update({0, 0}, VIEWPORT_SIZE);
+
+    CHECK(!isActive(existingEntity));
+
+    SECTION("They are found at their new location")
+    {
+      activationSystem.update({90, 0}, VIEWPORT_SIZE);
+      CHECK(isActive(existingEntity));
+    }
+  }
+
+  SECTION("Inactive entities moved onto the screen need to be reported")
+  {
+    farAwayEntity.component<WorldPosition>()->x = 10;
+    activationSystem.update({0, 0}, VIEWPORT_SIZE);
+
+    CHECK(!isActive(farAwayEntity));
+
+    activationSystem.markMoved(farAwayEntity);
+    activationSystem.update({0, 0}, VIEWPORT_SIZE);
+
+    CHECK(isActive(farAwayEntity));
+  }
+
+  SECTION("Entities positioned after being created are picked up")
+  {
+    auto entity = createEntity(entities, {0, 0});
+    *entity.component<WorldPosition>() = WorldPosition{300, 10};
+
+    activationSystem.update({0, 0}, VIEWPORT_SIZE);
+    CHECK(!isActive(entity));
+
+    activationSystem.update({290, 0}, VIEWPORT_SIZE);
+    CHECK(isActive(entity));
+  }
+
+  SECTION("Always active entities remain active off screen")
+  {
+    farAwayEntity.assign<ActivationSettings>(
+      ActivationSettings::Policy::Always);
+    activationSystem.update({0, 0}, VIEWPORT_SIZE);
+
+    REQUIRE(isActive(farAwayEntity));
+    CHECK(!farAwayEntity.component<Active>()->mIsOnScreen);
+  }
+
+  SECTION("Entities activated once remain active off screen")
+  {
+    existingEntity.assign<ActivationSettings>(
+      ActivationSettings::Policy::AlwaysAfterFirstActivation);
+    activationSystem.update({0, 0}, VIEWPORT_SIZE);
+    activationSystem.update({190, 0}, VIEWPORT_SIZE);
+
+    REQUIRE(isActive(existingEntity));
+    CHECK(!existingEntity.component<Active>()->mIsOnScreen);
+
+    SECTION("Resetting activation makes them inactive again")
+    {
+      resetActivation(existingEntity);
+      activationSystem.update({190, 0}, VIEWPORT_SIZE);
+
+      CHECK(!isActive(existingEntity));
+    }
+  }
+
+  SECTION("Destroyed entities are forgotten")
+  {
+    existingEntity.destroy();
+    activationSystem.update({0, 0}, VIEWPORT_SIZE);
+
+    // Likely to reuse the destroyed entity's slot
+    auto newEntity = createEntity(entities, {200, 10});
+    activationSystem.update({0, 0}, VIEWPORT_SIZE);
+
+    CHECK(!isActive(newEntity));
+    CHECK(activationSystem.numActiveEntities() == 0);
+  }
+
+  SECTION("Only entities near the screen are visited")
+  {
+    for (auto i = 0; i < 100; ++i)
+    {
+      createEntity(entities, {1000 + i * 4, 10});
+    }
+
+    activationSystem.update({0, 0}, VIEWPORT_SIZE);
+    activationSystem.update({0, 0}, VIEWPORT_SIZE);
+
+    CHECK(activationSystem.numVisitedEntities() == 1);
+  }
+}
+
+
+TEST_CASE("Entity activation system matches full sweep")
+{
+  ex::EntityX entityx;
+  auto& entities = entityx.entities;
+  EntityActivationSystem activationSystem{entities, entityx.events};
+
+  ex::EntityX referenceEntityx;
+  auto& referenceEntities = referenceEntityx.entities;
+
+  std::vector<ex::Entity> tracked;
+  std::vector<ex::Entity> reference;
+
+  for (auto y = 0; y < 10; ++y)
+  {
+    for (auto x = 0; x < 20; ++x)
+    {
+      const auto position = base::Vec2{x * 7, y * 5};
+      tracked.push_back(createEntity(entities, position));
+      reference.push_back(createEntity(referenceEntities, position));
+
+      if ((x + y) % 5 == 0)
+      {
+        tracked.back().assign<ActivationSettings>(
+          ActivationSettings::Policy::AlwaysAfterFirstActivation);
+        reference.back().assign<ActivationSettings>(
+          ActivationSettings::Policy::AlwaysAfterFirstActivation);
+      }
+    }
+  }
+
+  for (auto step = 0; step < 40; ++step)
+  {
+    const auto cameraPosition = base::Vec2{step * 3, step % 7};
+
+    activationSystem.update(cameraPosition, VIEWPORT_SIZE);
+    markActiveEntities(referenceEntities, cameraPosition, VIEWPORT_SIZE);
+
+    for (auto i = 0u; i < tracked.size(); ++i)
+    {
+      REQUIRE(isActive(tracked[i]) == isActive(reference[i]));
+      if (isActive(tracked[i]))
+      {
+        CHECK(
+          tracked[i].component<Active>()->mIsOnScreen ==
+          reference[i].component<Active>()->mIsOnScreen);
+      }
+    }
+  }
+}
@@ -0,0 +1,158 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/spatial_types_printing.hpp>
+#include <base/warnings.hpp>
+#include <engine/base_components.hpp>
+#include <game_logic/behavior_controller.hpp>
+#include <game_logic/entity_snapshot.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+using namespace rigel;
+using namespace game_logic;
+
+using engine::components::BoundingBox;
+using engine::components::WorldPosition;
+using game_logic::components::BehaviorController;
+
+
+namespace
+{
+
+struct CountingBehavior
+{
+  void update(GlobalDependencies&, GlobalState&, bool, entityx::Entity)
+  {
+    ++mCount;
+  }
+
+  int mCount = 0;
+};
+
+
+int countOf(entityx::Entity entity)
+{
+  return entity.component<BehaviorController>()->get<CountingBehavior>().mCount;
+}
+
+} // namespace
+
+
+TEST_CASE("Entity snapshots")
+{
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+
+  auto first = entities.create();
+  first.assign<WorldPosition>(1, 2);
+  first.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 3}});
+
+  auto second = entities.create();
+  second.assign<WorldPosition>(5, 6);
+  second.assign<BehaviorController>(CountingBehavior{3});
+
+  auto third = entities.create();
+  third.assign<WorldPosition>(7, 8);
+
+  const auto keyframe = EntitySnapshot{entities};
+
+  SECTION("Snapshot restores all entities and components")
+  {
+    entityx::EntityManager target{events};
+    target.create().assign<WorldPosition>(10, 10);
+
+    auto restored = keyframe.restore(target);
+
+    REQUIRE(restored.size() == 3);
+    CHECK(target.size() == 3);
+    CHECK(*restored[0].component<WorldPosition>() == WorldPosition(1, 2));
+    CHECK(
+      *restored[0].component<BoundingBox>() == (BoundingBox{{0, 0}, {2, 3}}));
+    CHECK(!restored[0].has_component<BehaviorController>());
+    CHECK(*restored[1].component<WorldPosition>() == WorldPosition(5, 6));
+    CHECK(countOf(restored[1]) == 3);
+    CHECK(*restored[2].component<WorldPosition>() == WorldPosition(7, 8));
+    CHECK(!restored[2].has_component<BoundingBox>());
+  }
+
+  SECTION("Entities can be found by their original handle")
+  {
+    CHECK(keyframe.indexOf(first) == 0u);
+    CHECK(keyframe.indexOf(third) == 2u);
+
+    third.destroy();
+    auto recycled = entities.create();
+
+    CHECK(!keyframe.indexOf(recycled));
+  }
+
+  SECTION("Snapshot relative to a base")
+  {
+    SECTION("Unchanged components are not stored again")
+    {
+      const auto unchanged = EntitySnapshot{entities, &keyframe};
+      CHECK(unchanged.base() == &keyframe);
+      CHECK(unchanged.memoryUsage() < keyframe.memoryUsage());
+
+      *first.component<WorldPosition>() = {3, 4};
+      const auto modified = EntitySnapshot{entities, &keyframe};
+      CHECK(modified.memoryUsage() > unchanged.memoryUsage());
+    }
+
+    SECTION("Behavior controllers with unchanged state are not stored again")
+    {
+      const auto unchanged = EntitySnapshot{entities, &keyframe};
+
+      second.component<BehaviorController>()->get<CountingBehavior>().mCount =
+        4;
+      const auto modified = EntitySnapshot{entities, &keyframe};
+
+      CHECK(modified.memoryUsage() > unchanged.memoryUsage());
+    }
+
+    SECTION("Restores modified, added and removed entities and components")
+    {
+      *first.component<WorldPosition>() = {3, 4};
+      first.remove<BoundingBox>();
+      second.component<BehaviorController>()->get<CountingBehavior>().mCount =
+        4;
+      third.destroy();
+      auto fourth = entities.create();
+      fourth.assign<WorldPosition>(9, 9);
+
+      const auto delta = EntitySnapshot{entities, &keyframe};
+
+      entityx::EntityManager target{events};
+      auto restored = delta.restore(target);
+
+      REQUIRE(restored.size() == 3);
+      CHECK(target.size() == 3);
+      CHECK(*restored[0].component<WorldPosition>() == WorldPosition(3, 4));
+      CHECK(!restored[0].has_component<BoundingBox>());
+      CHECK(*restored[1].component<WorldPosition>() == WorldPosition(5, 6));
+      CHECK(countOf(restored[1]) == 4);
+      CHECK(*restored[2].component<WorldPosition>() == WorldPosition(9, 9));
+      CHECK(delta.indexOf(fourth) == 2u);
+    }
+  }
+}
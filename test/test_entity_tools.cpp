@@ -0,0 +1,100 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+#include <engine/entity_tools.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdint>
+#include <vector>
+
+
+using namespace rigel;
+
+
+namespace
+{
+
+std::vector<std::uint32_t> createAndCollectIndices(
+  entityx::EntityManager& entities,
+  const int count)
+{
+  std::vector<std::uint32_t> indices;
+  for (auto i = 0; i < count; ++i)
+  {
+    indices.push_back(entities.create().id().index());
+  }
+
+  return indices;
+}
+
+} // namespace
+
+
+TEST_CASE("Reserving entities")
+{
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+  entityx::EntityManager referenceEntities{events};
+
+  auto setUp = [](entityx::EntityManager& es) {
+    auto createdEntities = std::vector<entityx::Entity>{};
+    for (auto i = 0; i < 6; ++i)
+    {
+      createdEntities.push_back(es.create());
+    }
+
+    createdEntities[1].destroy();
+    createdEntities[4].destroy();
+    return createdEntities[0];
+  };
+
+  auto firstEntity = setUp(entities);
+  auto firstReferenceEntity = setUp(referenceEntities);
+
+  engine::reserveEntities(entities, 16);
+
+  SECTION("Reserved entities don't stay alive")
+  {
+    CHECK(entities.size() == referenceEntities.size());
+  }
+
+  SECTION("Entities are created with the same indices as without reserving")
+  {
+    const auto indices = createAndCollectIndices(entities, 20);
+    const auto expectedIndices = createAndCollectIndices(referenceEntities, 20);
+
+    CHECK((indices == expectedIndices));
+  }
+
+  SECTION("Recycled indices are also used in the same order")
+  {
+    createAndCollectIndices(entities, 3);
+    createAndCollectIndices(referenceEntities, 3);
+
+    firstEntity.destroy();
+    firstReferenceEntity.destroy();
+
+    const auto indices = createAndCollectIndices(entities, 4);
+    const auto expectedIndices = createAndCollectIndices(referenceEntities, 4);
+
+    CHECK((indices == expectedIndices));
+  }
+}
@@ -0,0 +1,116 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+#include <engine/event_queue.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+using namespace rigel;
+
+
+namespace
+{
+
+struct TestEvent
+{
+  int mValue;
+};
+
+
+struct TestReceiver : entityx::Receiver<TestReceiver>
+{
+  void receive(const TestEvent& event)
+  {
+    mValues.push_back(event.mValue);
+
+    if (mpQueueToPushTo && event.mValue < 3)
+    {
+      mpQueueToPushTo->push(event.mValue + 10);
+    }
+  }
+
+  std::vector<int> mValues;
+  engine::EventQueue<TestEvent>* mpQueueToPushTo = nullptr;
+};
+
+} // namespace
+
+
+TEST_CASE("Event queue")
+{
+  entityx::EventManager events;
+  TestReceiver receiver;
+  events.subscribe<TestEvent>(receiver);
+
+  engine::EventQueue<TestEvent> queue;
+
+  SECTION("Events are only delivered when flushing")
+  {
+    queue.push(1);
+    queue.push(2);
+    CHECK(queue.size() == 2);
+    CHECK(receiver.mValues.empty());
+
+    queue.flush(events);
+    CHECK((receiver.mValues == std::vector<int>{1, 2}));
+    CHECK(queue.empty());
+
+    queue.flush(events);
+    CHECK(receiver.mValues.size() == 2);
+  }
+
+  SECTION("Events pushed while flushing are part of the same flush")
+  {
+    receiver.mpQueueToPushTo = &queue;
+
+    queue.push(1);
+    queue.push(2);
+    queue.push(3);
+    queue.flush(events);
+
+    CHECK((receiver.mValues == std::vector<int>{1, 2, 3, 11, 12}));
+    CHECK(queue.empty());
+  }
+
+  SECTION("Events can be filtered when flushing")
+  {
+    queue.push(1);
+    queue.push(2);
+    queue.push(3);
+    queue.flush(events, [](const TestEvent& event) {
+      return event.mValue != 2;
+    });
+
+    CHECK((receiver.mValues == std::vector<int>{1, 3}));
+    CHECK(queue.empty());
+  }
+
+  SECTION("Clearing discards queued events")
+  {
+    queue.push(1);
+    queue.clear();
+    queue.flush(events);
+
+    CHECK(receiver.mValues.empty());
+  }
+}
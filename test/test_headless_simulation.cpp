@@ -0,0 +1,117 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <assets/resource_loader.hpp>
+#include <base/spatial_types_printing.hpp>
+#include <base/warnings.hpp>
+#include <game_logic/game_world.hpp>
+#include <game_logic/headless_simulation.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+
+using namespace rigel;
+using namespace game_logic;
+
+
+namespace
+{
+
+/** Path to a Duke Nukem II installation, or empty if not configured
+ *
+ * Running a level requires the game's data files, which aren't part of the
+ * repository. Tests depending on them only run if the RIGEL_TEST_GAME_PATH
+ * environment variable points to a copy of the game (the shareware version
+ * is sufficient).
+ */
+std::string gamePathForTests()
+{
+  const auto pPath = std::getenv("RIGEL_TEST_GAME_PATH");
+  return pPath ? std::string{pPath} : std::string{};
+}
+
+
+std::vector<PlayerInput> makeScriptedInput(const int numFrames)
+{
+  std::vector<PlayerInput> inputs;
+  for (auto i = 0; i < numFrames; ++i)
+  {
+    PlayerInput input;
+    input.mRight = (i / 60) % 2 == 0;
+    input.mLeft = !input.mRight;
+    input.mJump.mIsPressed = i % 20 < 4;
+    input.mJump.mWasTriggered = i % 20 == 0;
+    input.mFire.mIsPressed = i % 8 < 2;
+    input.mFire.mWasTriggered = i % 8 == 0;
+    inputs.push_back(input);
+  }
+
+  return inputs;
+}
+
+} // namespace
+
+
+TEST_CASE("Headless simulation")
+{
+  const auto gamePath = gamePathForTests();
+  if (gamePath.empty())
+  {
+    WARN("RIGEL_TEST_GAME_PATH not set, skipping headless simulation test");
+    return;
+  }
+
+  const auto resources = assets::ResourceLoader{gamePath, false, {}};
+  const auto sessionId = data::GameSessionId{0, 0, data::Difficulty::Medium};
+  const auto inputs = makeScriptedInput(600);
+
+  HeadlessSimulation simulation{&resources, sessionId};
+  REQUIRE(simulation.world().isHeadless());
+
+  const auto initialResult = simulation.result();
+  const auto result = simulation.run(inputs);
+
+  SECTION("All frames are simulated")
+  {
+    CHECK(result.mFramesSimulated == inputs.size());
+    CHECK(!result.mLevelFinished);
+  }
+
+  SECTION("The world is updated")
+  {
+    CHECK(result.mPlayerPosition != initialResult.mPlayerPosition);
+  }
+
+  SECTION("Simulating the same input again gives the same result")
+  {
+    HeadlessSimulation secondSimulation{&resources, sessionId};
+    const auto secondResult = secondSimulation.run(inputs);
+
+    CHECK(secondResult.mFramesSimulated == result.mFramesSimulated);
+    CHECK(secondResult.mPlayerPosition == result.mPlayerPosition);
+    CHECK(secondResult.mCameraPosition == result.mCameraPosition);
+    CHECK(secondResult.mNumEntities == result.mNumEntities);
+    CHECK(secondResult.mPlayerModel.score() == result.mPlayerModel.score());
+    CHECK(secondResult.mPlayerModel.health() == result.mPlayerModel.health());
+  }
+}
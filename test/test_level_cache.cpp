@@ -0,0 +1,146 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assets/level_cache.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <filesystem>
+#include <fstream>
+
+
+using namespace rigel;
+using namespace data;
+using namespace data::map;
+
+namespace fs = std::filesystem;
+
+
+namespace
+{
+
+Image makeImage(const std::size_t width, const std::size_t height)
+{
+  PixelBuffer pixels;
+  for (auto y = 0u; y < height; ++y)
+  {
+    for (auto x = 0u; x < width; ++x)
+    {
+      pixels.emplace_back(std::uint8_t(x), std::uint8_t(y), 7, 255);
+    }
+  }
+
+  return Image{std::move(pixels), width, height};
+}
+
+
+LevelData makeLevel()
+{
+  Map map(32, 16, TileAttributeDict{TileAttributeDict::AttributeArray(8, 0)});
+  map.setTileAt(0, 3, 4, 5);
+  map.setTileAt(1, 31, 15, 7);
+
+  return LevelData{
+    makeImage(16, 8),
+    makeImage(4, 4),
+    std::nullopt,
+    std::move(map),
+    {LevelData::Actor{{1, 2}, ActorID::Blue_guard_LEFT, std::nullopt},
+     LevelData::Actor{
+       {3, 4},
+       ActorID::Dynamic_geometry_1,
+       base::Rect<int>{{5, 6}, {7, 8}}}},
+    {10, 20},
+    true,
+    BackdropScrollMode::ParallaxHorizontal,
+    BackdropSwitchCondition::OnTeleportation,
+    true,
+    "MUSIC.IMF"};
+}
+
+} // namespace
+
+
+TEST_CASE("Level cache")
+{
+  const auto cacheDir = fs::temp_directory_path() / "rigel_test_level_cache";
+  const auto path =
+    assets::levelCacheFile(cacheDir, "L1.MNI", Difficulty::Hard);
+  const auto key = std::uint64_t{0x1234};
+
+  const auto level = makeLevel();
+  assets::saveLevelToCache(path, key, level);
+
+  SECTION("Cached level matches original")
+  {
+    const auto oCached = assets::loadCachedLevel(path, key);
+    REQUIRE(oCached);
+
+    CHECK(oCached->mTileSetImage.width() == 16);
+    CHECK(
+      oCached->mTileSetImage.pixelData() == level.mTileSetImage.pixelData());
+    CHECK(
+      oCached->mBackdropImage.pixelData() == level.mBackdropImage.pixelData());
+    CHECK(!oCached->mSecondaryBackdropImage);
+
+    CHECK(oCached->mMap.width() == 32);
+    CHECK(oCached->mMap.height() == 16);
+    CHECK(oCached->mMap.tileAt(0, 3, 4) == 5);
+    CHECK(oCached->mMap.tileAt(1, 31, 15) == 7);
+    CHECK(oCached->mMap.tileAt(0, 0, 0) == 0);
+
+    REQUIRE(oCached->mActors.size() == 2);
+    CHECK(oCached->mActors[0].mID == ActorID::Blue_guard_LEFT);
+    CHECK(!oCached->mActors[0].mAssignedArea);
+    CHECK(oCached->mActors[1].mPosition == (base::Vec2{3, 4}));
+    CHECK(
+      oCached->mActors[1].mAssignedArea ==
+      (base::Rect<int>{{5, 6}, {7, 8}}));
+
+    CHECK(oCached->mPlayerSpawnPosition == (base::Vec2{10, 20}));
+    CHECK(oCached->mPlayerFacingLeft);
+    CHECK(
+      oCached->mBackdropScrollMode == BackdropScrollMode::ParallaxHorizontal);
+    CHECK(
+      oCached->mBackdropSwitchCondition ==
+      BackdropSwitchCondition::OnTeleportation);
+    CHECK(oCached->mEarthquake);
+    CHECK(oCached->mMusicFile == "MUSIC.IMF");
+  }
+
+  SECTION("Different key invalidates cache")
+  {
+    CHECK(!assets::loadCachedLevel(path, key + 1));
+  }
+
+  SECTION("Truncated file is rejected")
+  {
+    fs::resize_file(path, fs::file_size(path) - 4);
+    CHECK(!assets::loadCachedLevel(path, key));
+  }
+
+  SECTION("Missing file is handled")
+  {
+    fs::remove(path);
+    CHECK(!assets::loadCachedLevel(path, key));
+  }
+
+  std::error_code ec;
+  fs::remove_all(cacheDir, ec);
+}
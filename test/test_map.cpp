@@ -0,0 +1,185 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <data/map.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <array>
+#include <random>
+
+
+using namespace rigel;
+using namespace data::map;
+
+
+namespace
+{
+
+bool horizontalSpanReference(
+  const Map& map,
+  const int startX,
+  const int endX,
+  const int y,
+  const SolidEdge edge)
+{
+  for (auto x = startX; x <= endX; ++x)
+  {
+    if (map.collisionData(x, y).isSolidOn(edge))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+bool verticalSpanReference(
+  const Map& map,
+  const int startY,
+  const int endY,
+  const int x,
+  const SolidEdge edge)
+{
+  for (auto y = startY; y <= endY; ++y)
+  {
+    if (map.collisionData(x, y).isSolidOn(edge))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+} // namespace
+
+
+TEST_CASE("Map span solidity tests")
+{
+  // Tile 1 is solid on top, 2 on the bottom, 3 on the left and right side,
+  // 4 on all sides
+  Map map{130, 70, TileAttributeDict{{0x0, 0x1, 0x2, 0xC, 0xF}}};
+
+  SECTION("Empty map")
+  {
+    CHECK(!map.isSolidOnHorizontalSpan(0, 129, 10, SolidEdge::any()));
+    CHECK(!map.isSolidOnVerticalSpan(0, 69, 10, SolidEdge::any()));
+  }
+
+  SECTION("Map boundaries")
+  {
+    CHECK(map.isSolidOnHorizontalSpan(-1, 3, 10, SolidEdge::top()));
+    CHECK(map.isSolidOnHorizontalSpan(127, 130, 10, SolidEdge::top()));
+    CHECK(map.isSolidOnHorizontalSpan(127, 130, -1, SolidEdge::top()));
+    CHECK(!map.isSolidOnHorizontalSpan(0, 10, -1, SolidEdge::top()));
+    CHECK(!map.isSolidOnHorizontalSpan(0, 10, 70, SolidEdge::top()));
+
+    CHECK(map.isSolidOnVerticalSpan(0, 3, -1, SolidEdge::left()));
+    CHECK(map.isSolidOnVerticalSpan(0, 3, 130, SolidEdge::left()));
+    CHECK(!map.isSolidOnVerticalSpan(-5, 75, 3, SolidEdge::left()));
+  }
+
+  SECTION("Empty spans are never solid")
+  {
+    map.setTileAt(0, 5, 5, 4);
+
+    CHECK(!map.isSolidOnHorizontalSpan(6, 4, 5, SolidEdge::any()));
+    CHECK(!map.isSolidOnVerticalSpan(6, 4, 5, SolidEdge::any()));
+  }
+
+  SECTION("Spans crossing word boundaries")
+  {
+    map.setTileAt(0, 64, 20, 1);
+
+    CHECK(map.isSolidOnHorizontalSpan(60, 70, 20, SolidEdge::top()));
+    CHECK(map.isSolidOnHorizontalSpan(64, 64, 20, SolidEdge::top()));
+    CHECK(!map.isSolidOnHorizontalSpan(60, 63, 20, SolidEdge::top()));
+    CHECK(!map.isSolidOnHorizontalSpan(65, 129, 20, SolidEdge::top()));
+    CHECK(!map.isSolidOnHorizontalSpan(60, 70, 20, SolidEdge::bottom()));
+    CHECK(map.isSolidOnVerticalSpan(0, 69, 64, SolidEdge::top()));
+  }
+
+  SECTION("Changing tiles updates solidity")
+  {
+    map.setTileAt(1, 10, 10, 3);
+    CHECK(map.isSolidOnVerticalSpan(5, 15, 10, SolidEdge::left()));
+
+    // Composite tiles are never solid
+    map.setTileAt(0, 10, 10, 4);
+    CHECK(!map.isSolidOnVerticalSpan(5, 15, 10, SolidEdge::any()));
+
+    map.setTileAt(1, 10, 10, 0);
+    CHECK(map.isSolidOnVerticalSpan(5, 15, 10, SolidEdge::bottom()));
+
+    map.clearSection(8, 8, 4, 4);
+    CHECK(!map.isSolidOnVerticalSpan(5, 15, 10, SolidEdge::any()));
+  }
+
+  SECTION("Results match testing tile by tile")
+  {
+    std::mt19937 randomGenerator{1234};
+    std::uniform_int_distribution<int> tileDistribution{0, 4};
+    std::uniform_int_distribution<int> tileXDistribution{0, 129};
+    std::uniform_int_distribution<int> tileYDistribution{0, 69};
+    std::uniform_int_distribution<int> xDistribution{-3, 132};
+    std::uniform_int_distribution<int> yDistribution{-3, 72};
+    std::uniform_int_distribution<int> lengthDistribution{0, 80};
+
+    for (auto i = 0; i < 2000; ++i)
+    {
+      const auto x = tileXDistribution(randomGenerator);
+      const auto y = tileYDistribution(randomGenerator);
+      map.setTileAt(i % 2, x, y, tileDistribution(randomGenerator));
+    }
+
+    const auto edges = std::array<SolidEdge, 5>{
+      SolidEdge::top(),
+      SolidEdge::bottom(),
+      SolidEdge::left(),
+      SolidEdge::right(),
+      SolidEdge::any()};
+
+    auto numMismatches = 0;
+    for (auto i = 0; i < 5000; ++i)
+    {
+      const auto x = xDistribution(randomGenerator);
+      const auto y = yDistribution(randomGenerator);
+      const auto length = lengthDistribution(randomGenerator);
+      const auto edge = edges[i % edges.size()];
+
+      if (
+        map.isSolidOnHorizontalSpan(x, x + length, y, edge) !=
+        horizontalSpanReference(map, x, x + length, y, edge))
+      {
+        ++numMismatches;
+      }
+
+      if (
+        map.isSolidOnVerticalSpan(y, y + length, x, edge) !=
+        verticalSpanReference(map, y, y + length, x, edge))
+      {
+        ++numMismatches;
+      }
+    }
+
+    CHECK(numMismatches == 0);
+  }
+}
@@ -37,6 +37,22 @@ using namespace engine::components::parameter_aliases;
 namespace ex = entityx;
 
 
+namespace
+{
+
+struct CollisionEventRecorder : ex::Receiver<CollisionEventRecorder>
+{
+  void receive(const events::CollidedWithWorld& event)
+  {
+    mEntities.push_back(event.mEntity);
+  }
+
+  std::vector<ex::Entity> mEntities;
+};
+
+} // namespace
+
+
 TEST_CASE("Physics system works as expected")
 {
   ex::EntityX entityx;
@@ -426,4 +442,62 @@ TEST_CASE("Physics system works as expected")
       CHECK(collectedPositions == expectedPositions);
     }
   }
+
+
+  SECTION("Collision events")
+  {
+    using CollisionEventMode = PhysicsSystem::CollisionEventMode;
+
+    CollisionEventRecorder recorder;
+    entityx.events.subscribe<events::CollidedWithWorld>(recorder);
+
+    auto solidBody = entities.create();
+    solidBody.assign<BoundingBox>(BoundingBox{{0, 0}, {4, 3}});
+    solidBody.assign<WorldPosition>(0, 8);
+    solidBody.assign<SolidBody>();
+
+    body.mVelocity.y = 2.0f;
+
+    SECTION("Events are delivered immediately by default")
+    {
+      runOneFrame();
+      REQUIRE(recorder.mEntities.size() == 1);
+      CHECK((recorder.mEntities[0] == physicalObject));
+    }
+
+    SECTION("Deferred events are delivered when flushing")
+    {
+      physicsSystem.setCollisionEventMode(CollisionEventMode::Deferred);
+
+      runOneFrame();
+      CHECK(recorder.mEntities.empty());
+      CHECK(physicalObject.has_component<CollidedWithWorld>());
+
+      physicsSystem.flushCollisionEvents();
+      REQUIRE(recorder.mEntities.size() == 1);
+      CHECK((recorder.mEntities[0] == physicalObject));
+
+      physicsSystem.flushCollisionEvents();
+      CHECK(recorder.mEntities.size() == 1);
+    }
+
+    SECTION("Deferred events for destroyed entities are dropped")
+    {
+      physicsSystem.setCollisionEventMode(CollisionEventMode::Deferred);
+
+      runOneFrame();
+      physicalObject.destroy();
+      physicsSystem.flushCollisionEvents();
+      CHECK(recorder.mEntities.empty());
+    }
+
+    SECTION("Switching to immediate mode delivers pending events")
+    {
+      physicsSystem.setCollisionEventMode(CollisionEventMode::Deferred);
+
+      runOneFrame();
+      physicsSystem.setCollisionEventMode(CollisionEventMode::Immediate);
+      CHECK(recorder.mEntities.size() == 1);
+    }
+  }
 }
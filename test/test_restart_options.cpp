@@ -0,0 +1,66 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+#include <frontend/game.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+
+
+TEST_CASE("Command line options for restarting the game")
+{
+  auto options = CommandLineOptions{};
+  options.mGamePath = "/path/from/command/line";
+  options.mLevelToJumpTo = data::GameSessionId{0, 1, data::Difficulty::Hard};
+  options.mDebugModeEnabled = true;
+  options.mDisableAudio = true;
+
+  auto profile = UserProfile{};
+  profile.mGamePath = std::filesystem::u8path("/path/from/profile");
+
+  REQUIRE(
+    effectiveGamePath(options, profile) ==
+    std::filesystem::u8path("/path/from/command/line"));
+
+  const auto restartOptions = optionsForRestart(options);
+
+  SECTION("Game path chosen in the UI takes effect after restart")
+  {
+    profile.mGamePath = std::filesystem::u8path("/path/chosen/in/ui");
+
+    CHECK(
+      effectiveGamePath(restartOptions, profile) ==
+      std::filesystem::u8path("/path/chosen/in/ui"));
+  }
+
+  SECTION("Restart starts from the main menu")
+  {
+    CHECK(restartOptions.mSkipIntro);
+    CHECK(!restartOptions.mLevelToJumpTo);
+  }
+
+  SECTION("Debug and audio settings are kept")
+  {
+    CHECK(restartOptions.mDebugModeEnabled);
+    CHECK(restartOptions.mDisableAudio);
+  }
+}
@@ -0,0 +1,122 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <engine/spatial_grid.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <vector>
+
+
+using namespace rigel;
+
+namespace
+{
+
+std::vector<int> candidatesFor(
+  const engine::SpatialGrid<int>& grid,
+  const base::Rect<int>& area)
+{
+  std::vector<int> result;
+  grid.forEachCandidate(area, [&](const int item) { result.push_back(item); });
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+} // namespace
+
+
+TEST_CASE("Spatial grid")
+{
+  engine::SpatialGrid<int> grid{4};
+
+  const auto box1 = base::Rect<int>{{1, 1}, {2, 2}};
+  const auto box2 = base::Rect<int>{{10, 1}, {2, 2}};
+  const auto box3 = base::Rect<int>{{3, 3}, {3, 3}};
+
+  grid.insert(1, box1);
+  grid.insert(2, box2);
+  grid.insert(3, box3);
+
+  CHECK(grid.size() == 3);
+
+  SECTION("Query returns items in overlapped cells")
+  {
+    const auto expectedTopLeft = std::vector<int>{1, 3};
+    const auto expectedAll = std::vector<int>{1, 2, 3};
+
+    CHECK(candidatesFor(grid, {{0, 0}, {1, 1}}) == expectedTopLeft);
+    CHECK(candidatesFor(grid, {{9, 0}, {2, 2}}) == std::vector<int>{2});
+    CHECK(candidatesFor(grid, {{5, 5}, {1, 1}}) == std::vector<int>{3});
+    CHECK(candidatesFor(grid, {{0, 0}, {16, 16}}) == expectedAll);
+  }
+
+  SECTION("Query far away from all items returns nothing")
+  {
+    CHECK(candidatesFor(grid, {{100, 100}, {4, 4}}).empty());
+  }
+
+  SECTION("Negative coordinates are supported")
+  {
+    grid.insert(4, {{-3, -3}, {2, 2}});
+
+    const auto expectedTopLeft = std::vector<int>{1, 3};
+
+    CHECK(candidatesFor(grid, {{-1, -1}, {1, 1}}) == std::vector<int>{4});
+    CHECK(candidatesFor(grid, {{0, 0}, {1, 1}}) == expectedTopLeft);
+  }
+
+  SECTION("Removed items are not returned anymore")
+  {
+    grid.remove(3, box3);
+
+    CHECK(grid.size() == 2);
+    CHECK(candidatesFor(grid, {{0, 0}, {8, 8}}) == std::vector<int>{1});
+  }
+
+  SECTION("Moved items are found at their new location")
+  {
+    grid.move(1, box1, {{20, 20}, {2, 2}});
+
+    CHECK(grid.size() == 3);
+    CHECK(candidatesFor(grid, {{0, 0}, {1, 1}}) == std::vector<int>{3});
+    CHECK(candidatesFor(grid, {{20, 20}, {1, 1}}) == std::vector<int>{1});
+  }
+
+  SECTION("Moving within the same cells keeps the item")
+  {
+    grid.move(1, box1, {{0, 0}, {2, 2}});
+
+    const auto expectedTopLeft = std::vector<int>{1, 3};
+
+    CHECK(grid.size() == 3);
+    CHECK(candidatesFor(grid, {{0, 0}, {1, 1}}) == expectedTopLeft);
+  }
+
+  SECTION("Clearing removes all items")
+  {
+    grid.clear();
+
+    CHECK(grid.size() == 0);
+    CHECK(candidatesFor(grid, {{0, 0}, {16, 16}}).empty());
+  }
+}
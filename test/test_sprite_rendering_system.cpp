@@ -0,0 +1,145 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <engine/sprite_rendering_system.hpp>
+#include <engine/visual_components.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+
+TEST_CASE("Sprite rendering system spatial index")
+{
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+
+  SpriteDrawData drawData;
+  drawData.mFrames.emplace_back(0, base::Vec2{}, base::Size{2, 2});
+  drawData.mDrawOrder = 0;
+
+  auto spawnSprite = [&](const WorldPosition& position) {
+    auto entity = entities.create();
+    entity.assign<Sprite>(&drawData, std::vector<int>{0});
+    entity.assign<WorldPosition>(position);
+    return entity;
+  };
+
+  auto visibleEntity = spawnSprite({2, 2});
+  auto farAwayEntity = spawnSprite({100, 100});
+
+  // No renderer needed, since we don't draw anything
+  SpriteRenderingSystem spriteRenderingSystem{
+    nullptr, nullptr, entities, events};
+
+  const auto viewportSize = base::Size{10, 10};
+  auto update = [&]() {
+    spriteRenderingSystem.update(viewportSize, {}, 1.0f);
+  };
+
+  // Entities existing before construction are indexed as well
+  update();
+  REQUIRE(spriteRenderingSystem.numVisitedEntities() == 1);
+  REQUIRE(spriteRenderingSystem.numVisibleSprites() == 1);
+
+  SECTION("Newly created sprites are indexed without invalidation")
+  {
+    spawnSprite({5, 5});
+    update();
+
+    CHECK(spriteRenderingSystem.numVisitedEntities() == 2);
+    CHECK(spriteRenderingSystem.numVisibleSprites() == 2);
+  }
+
+  SECTION("Moved sprites are re-indexed after invalidation")
+  {
+    *farAwayEntity.component<WorldPosition>() = {5, 5};
+    update();
+    CHECK(spriteRenderingSystem.numVisitedEntities() == 1);
+
+    spriteRenderingSystem.invalidateSpatialIndex();
+    update();
+    CHECK(spriteRenderingSystem.numVisitedEntities() == 2);
+
+    *visibleEntity.component<WorldPosition>() = {100, 100};
+    spriteRenderingSystem.invalidateSpatialIndex();
+    update();
+    CHECK(spriteRenderingSystem.numVisitedEntities() == 1);
+    CHECK(spriteRenderingSystem.numVisibleSprites() == 1);
+  }
+
+  SECTION("Sprites losing a required component are dropped from the index")
+  {
+    SECTION("Sprite")
+    {
+      visibleEntity.remove<Sprite>();
+    }
+
+    SECTION("Position")
+    {
+      visibleEntity.remove<WorldPosition>();
+    }
+
+    SECTION("Whole entity")
+    {
+      visibleEntity.destroy();
+    }
+
+    update();
+    CHECK(spriteRenderingSystem.numVisitedEntities() == 0);
+    CHECK(spriteRenderingSystem.numVisibleSprites() == 0);
+  }
+
+  SECTION("Entity slots reused before the next update are handled")
+  {
+    visibleEntity.destroy();
+    farAwayEntity.destroy();
+    spawnSprite({3, 3});
+    update();
+
+    CHECK(spriteRenderingSystem.numVisitedEntities() == 1);
+    CHECK(spriteRenderingSystem.numVisibleSprites() == 1);
+  }
+
+  SECTION("Sprites with additional parts are always visited")
+  {
+    farAwayEntity.assign<SpriteStrip>(base::Vec2{100, 100}, 0);
+    update();
+    CHECK(spriteRenderingSystem.numVisitedEntities() == 2);
+    CHECK(spriteRenderingSystem.numVisibleSprites() == 1);
+
+    farAwayEntity.remove<SpriteStrip>();
+    update();
+    CHECK(spriteRenderingSystem.numVisitedEntities() == 1);
+  }
+
+  SECTION("Resetting the entity manager clears the index")
+  {
+    entities.reset();
+    update();
+    CHECK(spriteRenderingSystem.numVisitedEntities() == 0);
+
+    spawnSprite({3, 3});
+    update();
+    CHECK(spriteRenderingSystem.numVisitedEntities() == 1);
+  }
+}
@@ -0,0 +1,132 @@
+/* Copyright (C) 2022, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/spsc_queue.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <array>
+#include <thread>
+#include <vector>
+
+
+using namespace rigel;
+
+
+TEST_CASE("SPSC queue")
+{
+  base::SpscQueue<int> queue{4};
+
+  REQUIRE(queue.capacity() == 4);
+  REQUIRE(queue.size() == 0);
+  REQUIRE(queue.freeSpace() == 4);
+
+  SECTION("Popping from an empty queue fails")
+  {
+    auto item = 0;
+    CHECK(!queue.tryPop(item));
+  }
+
+  SECTION("Items are popped in order")
+  {
+    CHECK(queue.tryPush(1));
+    CHECK(queue.tryPush(2));
+    CHECK(queue.tryPush(3));
+    CHECK(queue.size() == 3);
+    CHECK(queue.freeSpace() == 1);
+
+    auto item = 0;
+    CHECK(queue.tryPop(item));
+    CHECK(item == 1);
+    CHECK(queue.tryPop(item));
+    CHECK(item == 2);
+    CHECK(queue.tryPop(item));
+    CHECK(item == 3);
+    CHECK(!queue.tryPop(item));
+  }
+
+  SECTION("Pushing to a full queue fails")
+  {
+    for (auto i = 0; i < 4; ++i)
+    {
+      CHECK(queue.tryPush(i));
+    }
+
+    CHECK(!queue.tryPush(4));
+    CHECK(queue.freeSpace() == 0);
+  }
+
+  SECTION("Failed push leaves item intact")
+  {
+    base::SpscQueue<std::vector<int>> vectorQueue{1};
+    CHECK(vectorQueue.tryPush(std::vector<int>{1}));
+
+    std::vector<int> item{1, 2, 3};
+    CHECK(!vectorQueue.tryPush(std::move(item)));
+    CHECK(item.size() == 3);
+  }
+
+  SECTION("Bulk push and pop wrap around the end of the storage")
+  {
+    const auto input = std::array<int, 3>{1, 2, 3};
+    auto output = std::array<int, 4>{};
+
+    CHECK(queue.push(input.data(), input.size()) == 3);
+    CHECK(queue.pop(output.data(), 2) == 2);
+
+    // Only 3 free slots left, the last item doesn't fit
+    const auto moreInput = std::array<int, 4>{4, 5, 6, 7};
+    CHECK(queue.push(moreInput.data(), moreInput.size()) == 3);
+    CHECK(queue.size() == 4);
+
+    CHECK(queue.pop(output.data(), output.size()) == 4);
+    const auto expected = std::array<int, 4>{3, 4, 5, 6};
+    CHECK(output == expected);
+    CHECK(queue.pop(output.data(), output.size()) == 0);
+  }
+
+  SECTION("Items arrive intact when pushing from another thread")
+  {
+    constexpr auto NUM_ITEMS = 10000;
+
+    std::thread producer{[&queue]() {
+      for (auto i = 0; i < NUM_ITEMS; ++i)
+      {
+        while (!queue.tryPush(i))
+        {
+          std::this_thread::yield();
+        }
+      }
+    }};
+
+    auto allInOrder = true;
+    for (auto expected = 0; expected < NUM_ITEMS;)
+    {
+      auto item = 0;
+      if (queue.tryPop(item))
+      {
+        allInOrder = allInOrder && item == expected;
+        ++expected;
+      }
+    }
+
+    producer.join();
+    CHECK(allInOrder);
+  }
+}